@@ -1 +1 @@
-arduino-cli compile -b Seeeduino:samd:seeed_wio_terminal ./wfh_monitor.ino --output-dir ./ --verbose --log-level trace
\ No newline at end of file
+arduino-cli compile -b Seeeduino:samd:seeed_wio_terminal ./wfh_monitor.ino --build-property "compiler.c.extra_flags=-DconfigSUPPORT_STATIC_ALLOCATION=1" --build-property "compiler.cpp.extra_flags=-DconfigSUPPORT_STATIC_ALLOCATION=1" --output-dir ./ --verbose --log-level trace
\ No newline at end of file
@@ -1,3 +1,3 @@
 #!/bin/sh
-arduino-cli compile -b Seeeduino:samd:seeed_wio_terminal ./wfh_monitor.ino --output-dir ./ --verbose --log-level trace
+arduino-cli compile -b Seeeduino:samd:seeed_wio_terminal ./wfh_monitor.ino --build-property "compiler.c.extra_flags=-DconfigSUPPORT_STATIC_ALLOCATION=1" --build-property "compiler.cpp.extra_flags=-DconfigSUPPORT_STATIC_ALLOCATION=1" --output-dir ./ --verbose --log-level trace
 python ./utils/uf2/utils/uf2conv.py -c -b 0x4000 -o ./wfh_monitor.ino.uf2 ./wfh_monitor.ino.bin
@@ -0,0 +1,678 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+/**
+ * @brief 仮想時間実行時のTaskの状態です
+ */
+enum class HostTaskState : uint32_t {
+    Ready,   /**< 実行可能 */
+    Running, /**< 実行中, 同時に1Taskのみ */
+    Blocked, /**< 待機中 */
+    Dead,    /**< 終了済 */
+};
+
+/**
+ * @brief Taskの管理領域です
+ */
+struct HostTask {
+    std::string name;                   /**< Task名 */
+    uint32_t stackDepth;                /**< 作成時に指定されたStackSize[word], 記録のみ */
+    UBaseType_t priority;               /**< 作成時に指定されたTask優先度, 実時間実行では記録のみ */
+    TaskFunction_t function;            /**< Task本体 */
+    void* parameter;                    /**< Task本体の引数 */
+    std::condition_variable cv;         /**< Delay/Notificationの待機、仮想時間実行では実行権の待機に使う */
+    std::condition_variable* waitingCv; /**< 待機中のcondition_variable, 起床対象の特定に使う */
+    uint32_t notifyValue;               /**< Task Notificationの値 */
+    bool isNotifyPending;               /**< 未受信のTask Notificationがあればtrue */
+    bool isDeleteRequested;             /**< 他TaskからvTaskDelete()された */
+    uint32_t criticalNesting;           /**< Critical Sectionのネスト数, 0以外ならPreemptionしない */
+    bool isPreemptPending;              /**< Critical Section中にPreemptionを保留した */
+    HostTaskState state;                /**< 仮想時間実行時の状態 */
+    uint64_t readySeq;                  /**< Readyになった順番, 同じ優先度ではFIFOで実行する */
+    uint32_t timerGeneration;           /**< 登録中のTimerの世代, 一致しないTimerは無視する */
+};
+
+/**
+ * @brief Queue/Semaphoreの管理領域です
+ * @note FreeRTOS同様SemaphoreはitemSize=0のQueueとして扱います
+ */
+struct HostQueue {
+    uint8_t* buffer;                 /**< 要素の格納先 */
+    bool isOwnedBuffer;              /**< bufferを自前で確保した場合はtrue */
+    size_t itemSize;                 /**< 要素のbyte数 */
+    size_t depth;                    /**< 要素数 */
+    size_t head;                     /**< 次に読み出す要素のindex */
+    size_t count;                    /**< 格納されている要素数 */
+    std::condition_variable notEmpty; /**< 受信待ち */
+    std::condition_variable notFull;  /**< 送信待ち */
+};
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Tickの基準時刻
+     */
+    const Clock::time_point bootTime = Clock::now();
+
+    /**
+     * @brief Task/Queueの状態を保護します。待機はすべてこのmutexで行います
+     */
+    std::mutex kernelMutex;
+
+    /**
+     * @brief Critical Section/Scheduler停止を実装します
+     */
+    std::recursive_mutex criticalMutex;
+
+    /**
+     * @brief 実行中のTask, Task以外のThread(main)では初回参照時に作成します
+     */
+    thread_local HostTask* currentTask = nullptr;
+
+    /**
+     * @brief Taskが削除された場合にThreadの先頭まで巻き戻すための例外です
+     */
+    struct TaskDeletedException {};
+
+    /****************************** Simulation ******************************/
+    /**
+     * @brief 仮想時間で実行中ならtrue
+     */
+    bool isSimulation = false;
+
+    /**
+     * @brief 仮想時間の現在時刻[us]
+     */
+    std::atomic<uint64_t> simNowUs(0);
+
+    /**
+     * @brief 実行権を持っているTask
+     */
+    HostTask* simRunning = nullptr;
+
+    /**
+     * @brief 作成されたすべてのTask, 作成順
+     */
+    std::vector<HostTask*> simTasks;
+
+    /**
+     * @brief 次にReadyになったTaskに割り当てる番号
+     */
+    uint64_t simReadySeq = 0;
+
+    /**
+     * @brief 待機中のTaskを起こす時刻です
+     */
+    struct SimTimer {
+        uint64_t wakeUs;     /**< 起床時刻[us] */
+        uint64_t seq;        /**< 登録順, 同時刻のTimerは登録順に処理する */
+        HostTask* task;      /**< 起床させるTask */
+        uint32_t generation; /**< 登録時のHostTask::timerGeneration */
+
+        bool operator>(const SimTimer& rhs) const {
+            return (this->wakeUs != rhs.wakeUs) ? (this->wakeUs > rhs.wakeUs) : (this->seq > rhs.seq);
+        }
+    };
+
+    /**
+     * @brief 仮想時間のEvent Queue, 起床時刻の早い順
+     */
+    std::priority_queue<SimTimer, std::vector<SimTimer>, std::greater<SimTimer>> simTimers;
+
+    /**
+     * @brief 次に登録するTimerの番号
+     */
+    uint64_t simTimerSeq = 0;
+
+    HostTask* newTask(const char* name, uint32_t stackDepth, UBaseType_t priority, TaskFunction_t function, void* parameter) {
+        HostTask* task = new HostTask();
+        task->name = (name != nullptr) ? name : "";
+        task->stackDepth = stackDepth;
+        task->priority = priority;
+        task->function = function;
+        task->parameter = parameter;
+        task->waitingCv = nullptr;
+        task->notifyValue = 0;
+        task->isNotifyPending = false;
+        task->isDeleteRequested = false;
+        task->criticalNesting = 0;
+        task->isPreemptPending = false;
+        task->state = HostTaskState::Ready;
+        task->readySeq = 0;
+        task->timerGeneration = 0;
+        return task;
+    }
+
+    HostTask* getCurrentTask(void) {
+        if (currentTask == nullptr) {
+            currentTask = newTask("main", 0, tskIDLE_PRIORITY, nullptr, nullptr);
+        }
+        return currentTask;
+    }
+
+    /**
+     * @brief TaskをReadyにします。登録済のTimerは無効になります
+     */
+    void simMakeReady(HostTask* task) {
+        task->state = HostTaskState::Ready;
+        task->readySeq = simReadySeq++;
+        task->timerGeneration++;
+    }
+
+    /**
+     * @brief 次に実行するTaskを選びます。実行可能なTaskがなければ仮想時間を次のTimerまで進めます
+     *
+     * @return HostTask* 次に実行するTask, すべてのTaskが無期限に待機している場合はnullptr
+     */
+    HostTask* simPickNext(void) {
+        while (true) {
+            // 優先度が最も高く、先にReadyになったTask
+            HostTask* next = nullptr;
+            for (HostTask* task : simTasks) {
+                if (task->state != HostTaskState::Ready) continue;
+                if ((next == nullptr) || (task->priority > next->priority) || ((task->priority == next->priority) && (task->readySeq < next->readySeq))) {
+                    next = task;
+                }
+            }
+            if (next != nullptr) return next;
+
+            // 実行可能なTaskがないので、次のEventまで時間を進める
+            bool isAdvanced = false;
+            while (!simTimers.empty()) {
+                const SimTimer timer = simTimers.top();
+                simTimers.pop();
+                if ((timer.task->state != HostTaskState::Blocked) || (timer.task->timerGeneration != timer.generation)) continue;
+                if (timer.wakeUs > simNowUs.load()) {
+                    simNowUs.store(timer.wakeUs);
+                }
+                simMakeReady(timer.task);
+                isAdvanced = true;
+                break;
+            }
+            if (!isAdvanced) return nullptr;
+        }
+    }
+
+    /**
+     * @brief 実行権を他のTaskに渡し、再び実行権を得るまで待機します
+     * @note 呼び出し前に自身のstateをRunning以外に変更してください
+     */
+    void simSwitch(std::unique_lock<std::mutex>& lock, HostTask* self) {
+        HostTask* next = simPickNext();
+        if (next == nullptr) {
+            fprintf(stderr, "[HOST] simulation stalled at %llu[us]: all tasks are blocked without timeout\n", static_cast<unsigned long long>(simNowUs.load()));
+            fflush(stdout);
+            std::_Exit(EXIT_FAILURE);
+        }
+        next->state = HostTaskState::Running;
+        simRunning = next;
+        if (next == self) return;
+        next->cv.notify_all();
+        if (self->state == HostTaskState::Dead) return;
+        self->cv.wait(lock, [&]() { return simRunning == self; });
+    }
+
+    /**
+     * @brief 自身より優先度の高いTaskがReadyなら実行権を渡します。Critical Section中は抜けるまで保留します
+     */
+    void simPreempt(std::unique_lock<std::mutex>& lock, HostTask* self) {
+        if (self->criticalNesting > 0) {
+            self->isPreemptPending = true;
+            return;
+        }
+        self->isPreemptPending = false;
+        bool isPreempted = false;
+        for (HostTask* task : simTasks) {
+            if ((task->state == HostTaskState::Ready) && (task->priority > self->priority)) {
+                isPreempted = true;
+                break;
+            }
+        }
+        if (!isPreempted) return;
+        simMakeReady(self);
+        simSwitch(lock, self);
+        if (self->isDeleteRequested) {
+            throw TaskDeletedException();
+        }
+    }
+
+    /**
+     * @brief cvで待機しているTaskを起こします
+     */
+    void wakeAll(std::unique_lock<std::mutex>& lock, std::condition_variable& cv) {
+        if (!isSimulation) {
+            cv.notify_all();
+            return;
+        }
+        for (HostTask* task : simTasks) {
+            if ((task->state == HostTaskState::Blocked) && (task->waitingCv == &cv)) {
+                simMakeReady(task);
+            }
+        }
+        simPreempt(lock, getCurrentTask());
+    }
+
+    /**
+     * @brief kernelMutexを保持した状態で条件が満たされるまで待機します
+     * @note 待機中に自身がvTaskDelete()された場合はTaskDeletedExceptionを投げます
+     *
+     * @tparam P bool(void) の型に一致する関数
+     * @param lock kernelMutexのlock
+     * @param cv 待機するcondition_variable
+     * @param waitTick 最大待機時間, portMAX_DELAYなら無期限
+     * @param predicate 待機終了条件
+     * @return true 条件が満たされた
+     * @return false timeout
+     */
+    template<class P>
+    bool waitFor(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, TickType_t waitTick, P predicate) {
+        HostTask* self = getCurrentTask();
+        const bool isTimed = (waitTick != portMAX_DELAY);
+        const uint64_t waitUs = static_cast<uint64_t>(waitTick) * portTICK_PERIOD_MS * 1000;
+        const auto deadline = Clock::now() + std::chrono::microseconds(waitUs);
+        const uint64_t simDeadlineUs = simNowUs.load() + waitUs;
+        bool result = true;
+        while (!predicate()) {
+            if (self->isDeleteRequested) break;
+            if (waitTick == 0) {
+                result = false;
+                break;
+            }
+            self->waitingCv = &cv;
+            if (isSimulation) {
+                if (isTimed && (simNowUs.load() >= simDeadlineUs)) {
+                    result = false;
+                    break;
+                }
+                // 起こされるか時刻が来るまで実行権を手放す
+                self->state = HostTaskState::Blocked;
+                if (isTimed) {
+                    simTimers.push({ simDeadlineUs, simTimerSeq++, self, self->timerGeneration });
+                }
+                simSwitch(lock, self);
+            } else if (!isTimed) {
+                cv.wait(lock);
+            } else if (cv.wait_until(lock, deadline) == std::cv_status::timeout) {
+                result = predicate();
+                break;
+            }
+        }
+        self->waitingCv = nullptr;
+        if (self->isDeleteRequested) {
+            throw TaskDeletedException();
+        }
+        return result;
+    }
+
+    void taskEntry(HostTask* task) {
+        currentTask = task;
+        if (isSimulation) {
+            std::unique_lock<std::mutex> lock(kernelMutex);
+            task->cv.wait(lock, [&]() { return simRunning == task; });
+        }
+        try {
+            task->function(task->parameter);
+        } catch (const TaskDeletedException&) {
+            // vTaskDelete()された
+        }
+        // Task本体から戻る/削除されたThreadは終了する。管理領域はHandleが参照され続ける可能性があるので解放しない
+        if (isSimulation) {
+            std::unique_lock<std::mutex> lock(kernelMutex);
+            task->state = HostTaskState::Dead;
+            simSwitch(lock, task);
+        }
+    }
+
+    HostTask* createTask(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameter, UBaseType_t priority) {
+        HostTask* task = newTask(name, stackDepth, priority, function, parameter);
+        std::unique_lock<std::mutex> lock(kernelMutex);
+        if (isSimulation) {
+            simTasks.push_back(task);
+            simMakeReady(task);
+        }
+        std::thread(taskEntry, task).detach();
+        if (isSimulation) {
+            simPreempt(lock, getCurrentTask());
+        }
+        return task;
+    }
+
+    HostQueue* createQueue(UBaseType_t depth, UBaseType_t itemSize, uint8_t* buffer, UBaseType_t initialCount) {
+        HostQueue* queue = new HostQueue();
+        queue->itemSize = itemSize;
+        queue->depth = depth;
+        queue->head = 0;
+        queue->count = initialCount;
+        queue->isOwnedBuffer = (buffer == nullptr) && (itemSize > 0);
+        queue->buffer = queue->isOwnedBuffer ? new uint8_t[depth * itemSize] : buffer;
+        return queue;
+    }
+}
+
+/****************************** Host Extension ******************************/
+void vHostSimulationStart(void) {
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    if (isSimulation) return;
+    HostTask* self = getCurrentTask();
+    isSimulation = true;
+    simTasks.push_back(self);
+    self->state = HostTaskState::Running;
+    simRunning = self;
+}
+
+BaseType_t xHostIsSimulation(void) {
+    return isSimulation ? pdTRUE : pdFALSE;
+}
+
+uint64_t ullHostGetTimeUs(void) {
+    if (isSimulation) {
+        return simNowUs.load();
+    }
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime).count());
+}
+
+/****************************** Critical Section ******************************/
+void vHostEnterCritical(void) {
+    criticalMutex.lock();
+    getCurrentTask()->criticalNesting++;
+}
+
+void vHostExitCritical(void) {
+    HostTask* self = getCurrentTask();
+    self->criticalNesting--;
+    criticalMutex.unlock();
+    // Critical Section中に保留したPreemptionを行う
+    if (isSimulation && (self->criticalNesting == 0) && self->isPreemptPending) {
+        std::unique_lock<std::mutex> lock(kernelMutex);
+        simPreempt(lock, self);
+    }
+}
+
+void vTaskSuspendAll(void) {
+    vHostEnterCritical();
+}
+
+BaseType_t xTaskResumeAll(void) {
+    vHostExitCritical();
+    return pdFALSE;
+}
+
+/****************************** Task ******************************/
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth, void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask) {
+    HostTask* task = createTask(pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority);
+    if (pxCreatedTask != nullptr) {
+        *pxCreatedTask = task;
+    }
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char* pcName, uint32_t ulStackDepth, void* pvParameters, UBaseType_t uxPriority, StackType_t* puxStackBuffer, StaticTask_t* pxTaskBuffer) {
+    // ThreadのStackはOSが確保する
+    (void)puxStackBuffer;
+    (void)pxTaskBuffer;
+    return createTask(pxTaskCode, pcName, ulStackDepth, pvParameters, uxPriority);
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete) {
+    HostTask* self = getCurrentTask();
+    if ((xTaskToDelete == nullptr) || (xTaskToDelete == self)) {
+        throw TaskDeletedException();
+    }
+    // 他のThreadは強制終了できないので、次にKernelで待機した時点で終了させる
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    xTaskToDelete->isDeleteRequested = true;
+    if (isSimulation) {
+        if (xTaskToDelete->state == HostTaskState::Blocked) {
+            simMakeReady(xTaskToDelete);
+        }
+        simPreempt(lock, self);
+    } else if (xTaskToDelete->waitingCv != nullptr) {
+        xTaskToDelete->waitingCv->notify_all();
+    }
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+    HostTask* self = getCurrentTask();
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    waitFor(lock, self->cv, xTicksToDelay, []() { return false; });
+}
+
+void vTaskDelayUntil(TickType_t* pxPreviousWakeTime, TickType_t xTimeIncrement) {
+    const TickType_t wakeTick = *pxPreviousWakeTime + xTimeIncrement;
+    const int32_t remainTick = static_cast<int32_t>(wakeTick - xTaskGetTickCount());
+    *pxPreviousWakeTime = wakeTick;
+    if (remainTick > 0) {
+        vTaskDelay(static_cast<TickType_t>(remainTick));
+    }
+}
+
+void taskYIELD(void) {
+    if (!isSimulation) {
+        std::this_thread::yield();
+        return;
+    }
+    // 同じ優先度のTaskに実行権を渡す
+    HostTask* self = getCurrentTask();
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    simMakeReady(self);
+    simSwitch(lock, self);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return static_cast<TickType_t>(ullHostGetTimeUs() / (portTICK_PERIOD_MS * 1000));
+}
+
+void vTaskSetTimeOutState(TimeOut_t* const pxTimeOut) {
+    const uint64_t tick = ullHostGetTimeUs() / (portTICK_PERIOD_MS * 1000);
+    pxTimeOut->xOverflowCount = static_cast<BaseType_t>(tick >> 32);
+    pxTimeOut->xTimeOnEntering = static_cast<TickType_t>(tick);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return getCurrentTask();
+}
+
+char* pcTaskGetName(TaskHandle_t xTaskToQuery) {
+    HostTask* task = (xTaskToQuery != nullptr) ? xTaskToQuery : getCurrentTask();
+    return &task->name[0];
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask) {
+    // Stack使用量は計測できないので、指定されたStackSizeをそのまま返す
+    HostTask* task = (xTask != nullptr) ? xTask : getCurrentTask();
+    return task->stackDepth;
+}
+
+/****************************** Task Notification ******************************/
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction) {
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    BaseType_t result = pdPASS;
+    switch (eAction) {
+        case eSetBits:
+            xTaskToNotify->notifyValue |= ulValue;
+            break;
+        case eIncrement:
+            xTaskToNotify->notifyValue++;
+            break;
+        case eSetValueWithOverwrite:
+            xTaskToNotify->notifyValue = ulValue;
+            break;
+        case eSetValueWithoutOverwrite:
+            if (xTaskToNotify->isNotifyPending) {
+                result = pdFAIL;
+            } else {
+                xTaskToNotify->notifyValue = ulValue;
+            }
+            break;
+        case eNoAction:
+        default:
+            break;
+    }
+    xTaskToNotify->isNotifyPending = true;
+    wakeAll(lock, xTaskToNotify->cv);
+    return result;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+    return xTaskNotify(xTaskToNotify, 0, eIncrement);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t* pulNotificationValue, TickType_t xTicksToWait) {
+    HostTask* self = getCurrentTask();
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    if (!self->isNotifyPending) {
+        self->notifyValue &= ~ulBitsToClearOnEntry;
+    }
+    const bool isReceived = waitFor(lock, self->cv, xTicksToWait, [&]() { return self->isNotifyPending; });
+    if (pulNotificationValue != nullptr) {
+        *pulNotificationValue = self->notifyValue;
+    }
+    if (isReceived) {
+        self->notifyValue &= ~ulBitsToClearOnExit;
+    }
+    self->isNotifyPending = false;
+    return isReceived ? pdTRUE : pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    HostTask* self = getCurrentTask();
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    waitFor(lock, self->cv, xTicksToWait, [&]() { return self->notifyValue != 0; });
+    const uint32_t value = self->notifyValue;
+    if (value != 0) {
+        self->notifyValue = (xClearCountOnExit != pdFALSE) ? 0 : (value - 1);
+    }
+    self->isNotifyPending = false;
+    return value;
+}
+
+/****************************** Queue ******************************/
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+    return createQueue(uxQueueLength, uxItemSize, nullptr, 0);
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t uxQueueLength, UBaseType_t uxItemSize, uint8_t* pucQueueStorage, StaticQueue_t* pxStaticQueue) {
+    (void)pxStaticQueue;
+    return createQueue(uxQueueLength, uxItemSize, pucQueueStorage, 0);
+}
+
+void vQueueDelete(QueueHandle_t xQueue) {
+    if (xQueue == nullptr) return;
+    if (xQueue->isOwnedBuffer) {
+        delete[] xQueue->buffer;
+    }
+    delete xQueue;
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue) {
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    xQueue->head = 0;
+    xQueue->count = 0;
+    wakeAll(lock, xQueue->notFull);
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    if (!waitFor(lock, xQueue->notFull, xTicksToWait, [&]() { return xQueue->count < xQueue->depth; })) {
+        return pdFAIL;
+    }
+    if (xQueue->itemSize > 0) {
+        const size_t tail = (xQueue->head + xQueue->count) % xQueue->depth;
+        memcpy(&xQueue->buffer[tail * xQueue->itemSize], pvItemToQueue, xQueue->itemSize);
+    }
+    xQueue->count++;
+    // Peek待ちと受信待ちが混在しうるので全員起こす
+    wakeAll(lock, xQueue->notEmpty);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    if (!waitFor(lock, xQueue->notEmpty, xTicksToWait, [&]() { return xQueue->count > 0; })) {
+        return pdFAIL;
+    }
+    if (xQueue->itemSize > 0) {
+        memcpy(pvBuffer, &xQueue->buffer[xQueue->head * xQueue->itemSize], xQueue->itemSize);
+    }
+    xQueue->head = (xQueue->head + 1) % xQueue->depth;
+    xQueue->count--;
+    wakeAll(lock, xQueue->notFull);
+    return pdPASS;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    if (!waitFor(lock, xQueue->notEmpty, xTicksToWait, [&]() { return xQueue->count > 0; })) {
+        return pdFAIL;
+    }
+    if (xQueue->itemSize > 0) {
+        memcpy(pvBuffer, &xQueue->buffer[xQueue->head * xQueue->itemSize], xQueue->itemSize);
+    }
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue) {
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue) {
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    return xQueue->depth - xQueue->count;
+}
+
+/****************************** Semaphore ******************************/
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return createQueue(1, 0, nullptr, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* pxMutexBuffer) {
+    (void)pxMutexBuffer;
+    return createQueue(1, 0, nullptr, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return createQueue(1, 0, nullptr, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* pxSemaphoreBuffer) {
+    (void)pxSemaphoreBuffer;
+    return createQueue(1, 0, nullptr, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+    return createQueue(uxMaxCount, 0, nullptr, uxInitialCount);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount, StaticSemaphore_t* pxSemaphoreBuffer) {
+    (void)pxSemaphoreBuffer;
+    return createQueue(uxMaxCount, 0, nullptr, uxInitialCount);
+}
+
+/****************************** Memory ******************************/
+void* pvPortMalloc(size_t xWantedSize) {
+    return malloc(xWantedSize);
+}
+
+void vPortFree(void* pv) {
+    free(pv);
+}
+
+/****************************** Seeed Extension ******************************/
+void vSetErrorLed(uint8_t pin, uint8_t activeState) {
+    (void)pin;
+    (void)activeState;
+}
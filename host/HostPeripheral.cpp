@@ -0,0 +1,193 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+#include <Seeed_FS.h>
+#include "SD/Seeed_SD.h"
+#include <AtWiFi.h>
+#include <Digital_Light_TSL2561.h>
+#include <seeed_bme680.h>
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "HostScenario.h"
+
+namespace {
+    /**
+     * @brief GPIOの値, INPUT_PULLUPで初期化したピンはHIGH(ボタン未押下)になります
+     */
+    uint8_t pinValues[HostPinNum] = {};
+
+    /**
+     * @brief 起動からの経過時間[sec]を取得します。擬似的なセンサ値の生成に使います
+     */
+    float getElapsedSec(void) {
+        return static_cast<float>(ullHostGetTimeUs()) / 1e6f;
+    }
+
+    /**
+     * @brief Scenarioで値が指定されていればそれを、なければ擬似的な値を返します
+     */
+    float getSensorValue(const char* key, float defaultValue) {
+        float value = defaultValue;
+        hostScenario.getValue(key, value);
+        return value;
+    }
+
+    /**
+     * @brief Scenarioでボタン入力を指定する際のピン名, WioPinの順
+     */
+    const char* const pinKeys[HostPinNum] = {
+        "pin.A", "pin.B", "pin.C", "pin.UP", "pin.DOWN", "pin.LEFT", "pin.RIGHT", "pin.PRESS",
+    };
+}
+
+/****************************** Global Instance ******************************/
+Serial_ Serial;
+SPIClass SPI;
+TwoWire Wire;
+SDFS SD;
+WiFiClass WiFi;
+TSL2561_CalculateLux TSL2561;
+
+/****************************** Time ******************************/
+uint32_t millis(void) {
+    return static_cast<uint32_t>(ullHostGetTimeUs() / 1000);
+}
+
+uint32_t micros(void) {
+    return static_cast<uint32_t>(ullHostGetTimeUs());
+}
+
+void delay(uint32_t ms) {
+    // 仮想時間実行中はSchedulerに時刻を進めさせる
+    if (xHostIsSimulation() == pdTRUE) {
+        vTaskDelay(ms / portTICK_PERIOD_MS);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    // 仮想時間実行中の処理時間は0として扱う
+    if (xHostIsSimulation() == pdTRUE) return;
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+/****************************** GPIO ******************************/
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= HostPinNum) return;
+    if (mode == INPUT_PULLUP) {
+        pinValues[pin] = HIGH;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin >= HostPinNum) return;
+    pinValues[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= HostPinNum) return LOW;
+    float value = 0.0f;
+    if (hostScenario.getValue(pinKeys[pin], value)) {
+        return (value != 0.0f) ? HIGH : LOW;
+    }
+    return pinValues[pin];
+}
+
+/****************************** Serial ******************************/
+size_t Serial_::write(uint8_t c) {
+    return this->write(&c, 1);
+}
+
+size_t Serial_::write(const uint8_t* buffer, size_t size) {
+    const size_t n = fwrite(buffer, 1, size, stdout);
+    fflush(stdout);
+    return n;
+}
+
+int Serial_::available(void) {
+    if (hostScenario.isSerialAvailable()) return 1;
+    // 仮想時間実行中は再現性のため標準入力を使わない
+    if (xHostIsSimulation() == pdTRUE) return 0;
+    struct pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+    return ((poll(&fd, 1, 0) > 0) && ((fd.revents & POLLIN) != 0)) ? 1 : 0;
+}
+
+int Serial_::read(void) {
+    if (hostScenario.isSerialAvailable()) return hostScenario.readSerial();
+    if (this->available() == 0) return -1;
+    uint8_t c = 0;
+    return (::read(STDIN_FILENO, &c, 1) == 1) ? c : -1;
+}
+
+/****************************** Sensor ******************************/
+float TSL2561_CalculateLux::readVisibleLux(void) {
+    // 実機のLibrary同様、積分時間(13.7ms)が終わるまで待ってから読み出す
+    delay(14);
+    // 1分周期でゆっくり明るさが変わる
+    return getSensorValue("lux", 300.0f + 200.0f * std::sin(getElapsedSec() * 2.0f * static_cast<float>(M_PI) / 60.0f));
+}
+
+int8_t bme680_set_sensor_settings(uint16_t desired_settings, struct bme680_dev* dev) {
+    // 設定はdevに保持しているものをそのまま使う
+    (void)desired_settings;
+    (void)dev;
+    return BME680_OK;
+}
+
+int8_t bme680_set_sensor_mode(struct bme680_dev* dev) {
+    dev->triggerUs = ullHostGetTimeUs();
+    return BME680_OK;
+}
+
+void bme680_get_profile_dur(uint16_t* duration, const struct bme680_dev* dev) {
+    // 温湿度/気圧の変換(Oversampling x2相当)、ガスを測定する場合はヒーター加熱時間を加える
+    *duration = 40 + ((dev->gas_sett.run_gas == BME680_ENABLE_GAS_MEAS) ? dev->gas_sett.heatr_dur : 0);
+}
+
+int8_t bme680_get_sensor_data(struct bme680_field_data* data, struct bme680_dev* dev) {
+    uint16_t durationMs = 0;
+    bme680_get_profile_dur(&durationMs, dev);
+    // 変換が終わっていなければ新しいデータはない
+    if ((dev->power_mode != BME680_FORCED_MODE) || ((ullHostGetTimeUs() - dev->triggerUs) < static_cast<uint64_t>(durationMs) * 1000)) {
+        data->status = 0;
+        return BME680_OK;
+    }
+    dev->power_mode = BME680_SLEEP_MODE;
+
+    const float t = getElapsedSec();
+    data->status         = BME680_NEW_DATA_MSK | ((dev->gas_sett.run_gas == BME680_ENABLE_GAS_MEAS) ? BME680_HEAT_STAB_MSK : 0);
+    data->temperature    = static_cast<int16_t>(getSensorValue("temperature", 25.0f + 2.0f * std::sin(t / 30.0f)) * 100.0f);
+    data->pressure       = static_cast<uint32_t>(getSensorValue("pressure", 101325.0f + 100.0f * std::sin(t / 120.0f)));
+    data->humidity       = static_cast<uint32_t>(getSensorValue("humidity", 50.0f + 10.0f * std::sin(t / 45.0f)) * 1000.0f);
+    data->gas_resistance = static_cast<uint32_t>(getSensorValue("gas", 100000.0f + 5000.0f * std::sin(t / 90.0f)));
+    return BME680_OK;
+}
+
+int8_t Seeed_BME680::read_sensor_data(void) {
+    // 実機のLibrary同様、変換が終わるまで待ってから読み出す
+    this->sensor_param.power_mode = BME680_FORCED_MODE;
+    bme680_set_sensor_mode(&this->sensor_param);
+    uint16_t durationMs = 0;
+    bme680_get_profile_dur(&durationMs, &this->sensor_param);
+    delay(durationMs);
+
+    struct bme680_field_data data;
+    bme680_get_sensor_data(&data, &this->sensor_param);
+    if ((data.status & BME680_NEW_DATA_MSK) == 0) return -1;
+    this->sensor_result_value.temperature = data.temperature / 100.0f;
+    this->sensor_result_value.pressure    = static_cast<float>(data.pressure);
+    this->sensor_result_value.humidity    = data.humidity / 1000.0f;
+    if ((data.status & BME680_HEAT_STAB_MSK) != 0) {
+        this->sensor_result_value.gas = static_cast<float>(data.gas_resistance);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "HostScenario.h"
+
+namespace {
+    /**
+     * @brief 現在時刻[ms]を取得します。仮想時間実行中は仮想時刻になります
+     */
+    uint64_t getNowMs(void) {
+        return ullHostGetTimeUs() / 1000;
+    }
+}
+
+HostScenario hostScenario;
+
+bool HostScenario::load(const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "[HOST] scenario %s could not be opened\n", path);
+        return false;
+    }
+    bool isSuccess = true;
+    std::string line;
+    uint32_t lineNum = 0;
+    while (std::getline(file, line)) {
+        lineNum++;
+        const size_t commentPos = line.find('#');
+        if (commentPos != std::string::npos) {
+            line.erase(commentPos);
+        }
+        std::istringstream iss(line);
+        uint64_t timeMs = 0;
+        std::string key;
+        if (!(iss >> timeMs)) continue; // 空行
+        if (!(iss >> key)) {
+            fprintf(stderr, "[HOST] scenario %s:%u key is missing\n", path, lineNum);
+            isSuccess = false;
+            continue;
+        }
+        if (key == "serial") {
+            // 残りを1行の入力として扱う
+            std::string text;
+            std::getline(iss >> std::ws, text);
+            text.push_back('\n');
+            for (const char c : text) {
+                this->serialInputs.emplace_back(timeMs, c);
+            }
+            continue;
+        }
+        float value = 0.0f;
+        if (!(iss >> value)) {
+            fprintf(stderr, "[HOST] scenario %s:%u value is missing\n", path, lineNum);
+            isSuccess = false;
+            continue;
+        }
+        this->timelines[key].emplace_back(timeMs, value);
+    }
+    // 同時刻のEventは記述順を保つ
+    for (auto& timeline : this->timelines) {
+        std::stable_sort(timeline.second.begin(), timeline.second.end(), [](const std::pair<uint64_t, float>& lhs, const std::pair<uint64_t, float>& rhs) { return lhs.first < rhs.first; });
+    }
+    std::stable_sort(this->serialInputs.begin(), this->serialInputs.end(), [](const std::pair<uint64_t, char>& lhs, const std::pair<uint64_t, char>& rhs) { return lhs.first < rhs.first; });
+    return isSuccess;
+}
+
+bool HostScenario::getValue(const char* key, float& dst) const {
+    const auto it = this->timelines.find(key);
+    if (it == this->timelines.end()) return false;
+    const Timeline& timeline = it->second;
+    // 現在時刻より後の最初のEventの1つ前が現在の値
+    const uint64_t nowMs = getNowMs();
+    const auto next = std::upper_bound(timeline.begin(), timeline.end(), nowMs, [](uint64_t t, const std::pair<uint64_t, float>& e) { return t < e.first; });
+    if (next == timeline.begin()) return false;
+    dst = (next - 1)->second;
+    return true;
+}
+
+bool HostScenario::isSerialAvailable(void) const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return (this->serialIndex < this->serialInputs.size()) && (this->serialInputs[this->serialIndex].first <= getNowMs());
+}
+
+int HostScenario::readSerial(void) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if ((this->serialIndex >= this->serialInputs.size()) || (this->serialInputs[this->serialIndex].first > getNowMs())) {
+        return -1;
+    }
+    return static_cast<uint8_t>(this->serialInputs[this->serialIndex++].second);
+}
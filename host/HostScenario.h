@@ -0,0 +1,67 @@
+#ifndef HOSTSCENARIO_H
+#define HOSTSCENARIO_H
+
+/**
+ * @file HostScenario.h
+ * @brief Host(Linux)実行時のセンサ値/ボタン/Serial入力を時刻指定で与えます
+ * @note 1行1Eventで `timeMs key value` の形式で記述します。`#`以降はコメントです
+ *       key: lux, temperature, pressure, humidity, gas, pin.A/B/C/UP/DOWN/LEFT/RIGHT/PRESS, serial
+ *       センサ値/ピンは次のEventまで値を保持し、serialは指定時刻以降に1行(改行付き)をSerial入力として受信します
+ *       指定のないセンサは擬似的な値を返します
+ */
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class HostScenario {
+    public:
+        /**
+         * @brief Scenario Fileを読み込みます
+         *
+         * @param path Scenario Fileのパス
+         * @return true 読み込み成功
+         * @return false Fileが開けない、もしくは解釈できない行があった
+         */
+        bool load(const char* path);
+
+        /**
+         * @brief 現在時刻における値を取得します
+         *
+         * @param key センサ名/ピン名
+         * @param dst 値の書き込み先
+         * @return true 値が指定されている
+         * @return false 現在時刻以前のEventがない
+         */
+        bool getValue(const char* key, float& dst) const;
+
+        /**
+         * @brief 受信可能なSerial入力があればtrueを返します
+         */
+        bool isSerialAvailable(void) const;
+
+        /**
+         * @brief Serial入力を1byte読み出します
+         *
+         * @return int 受信した文字, 受信可能な文字がなければ-1
+         */
+        int readSerial(void);
+
+    private:
+        /**
+         * @brief 時刻[ms]と値の組, 時刻順に並んでいます
+         */
+        typedef std::vector<std::pair<uint64_t, float>> Timeline;
+
+        std::map<std::string, Timeline> timelines;              /**< key毎の値の変化 */
+        std::vector<std::pair<uint64_t, char>> serialInputs;    /**< Serial入力, 時刻順 */
+        size_t serialIndex = 0;                                 /**< 次に読み出すserialInputsのindex */
+        mutable std::mutex mutex;                               /**< serialIndexを保護します */
+};
+
+extern HostScenario hostScenario;
+
+#endif /* HOSTSCENARIO_H */
@@ -0,0 +1,74 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+/**
+ * @file BenchUtil.h
+ * @brief host/bench以下のBenchmarkで共通の計測/集計処理です
+ * @note 数値はHost(Linux)上のものなので、Target上の絶対値ではなく実装間の相対比較に使います
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace BenchUtil {
+    /**
+     * @brief 計測用の時刻[ns]を取得します
+     */
+    static uint64_t nowNs(void) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * @brief 引数で指定された回数を取得します
+     *
+     * @param argc main()の引数
+     * @param argv main()の引数
+     * @param defaultValue 省略時の回数
+     * @return uint32_t 回数
+     */
+    static uint32_t getIterationNum(int argc, char** argv, uint32_t defaultValue) {
+        if (argc < 2) return defaultValue;
+        const uint32_t value = static_cast<uint32_t>(strtoul(argv[1], nullptr, 10));
+        return (value > 0) ? value : defaultValue;
+    }
+
+    /**
+     * @brief 処理回数と経過時間から1秒あたりの処理回数を出力します
+     *
+     * @param name 計測対象の名前
+     * @param opNum 処理回数
+     * @param elapsedNs 経過時間[ns]
+     */
+    static void printThroughput(const char* name, uint64_t opNum, uint64_t elapsedNs) {
+        const double opsPerSec = (elapsedNs > 0) ? (static_cast<double>(opNum) * 1e9 / static_cast<double>(elapsedNs)) : 0.0;
+        printf("[bench] %s ops=%llu elapsed=%llu[us] throughput=%.0f[ops/s]\n",
+            name, static_cast<unsigned long long>(opNum), static_cast<unsigned long long>(elapsedNs / 1000), opsPerSec);
+    }
+
+    /**
+     * @brief Latencyの分布を出力します
+     * @note samplesNsは並び替えられます
+     *
+     * @param name 計測対象の名前
+     * @param samplesNs Latency[ns]
+     */
+    static void printLatency(const char* name, std::vector<uint64_t>& samplesNs) {
+        if (samplesNs.empty()) {
+            printf("[bench] %s latency no sample\n", name);
+            return;
+        }
+        std::sort(samplesNs.begin(), samplesNs.end());
+        const auto percentile = [&](double p) {
+            const size_t index = static_cast<size_t>(p * static_cast<double>(samplesNs.size() - 1));
+            return static_cast<unsigned long long>(samplesNs[index]);
+        };
+        printf("[bench] %s latency p50/p99/p99.9/max=%llu/%llu/%llu/%llu[ns]\n",
+            name, percentile(0.5), percentile(0.99), percentile(0.999), static_cast<unsigned long long>(samplesNs.back()));
+    }
+}
+
+#endif /* BENCHUTIL_H */
@@ -0,0 +1,301 @@
+/**
+ * @file CoopExecutorBench.cpp
+ * @brief 処理ごとにRTOS Taskを作成した場合と、CoopExecutorで1つのRTOS Taskに相乗りさせた場合のRAMと切り替えコストを比較します
+ * @note usage: coop_executor_bench [iterationNum]
+ *       RAM: ButtonTask/LoggerTaskを個別のTaskにした場合と、CoopExecutorに相乗りさせた場合のStackとTCBの合計を出力します
+ *       切り替え: 2つの処理の間でiteration回ずつ交互に実行権を渡し、1回あたりの時間を出力します
+ *       CoopExecutorの動作(再開順序, Sleep, Event待ちのTimeout)も確認し、期待と異なればEXIT_FAILUREを返します
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "../../src/FixedConfig.h"
+#include "../../src/TaskBase.h"
+#include "../../src/coop/CoopExecutor.h"
+#include "BenchUtil.h"
+
+namespace {
+    /**
+     * @brief CoopExecutorに移行する前のButtonTask/LoggerTaskのStackSizeです
+     */
+    constexpr size_t ButtonTaskStackSize = 256;
+    constexpr size_t LoggerTaskStackSize = 1024;
+
+    /**
+     * @brief 確認に失敗した数
+     */
+    uint32_t failedNum = 0;
+
+    /**
+     * @brief 確認結果を出力します
+     *
+     * @param name 確認内容
+     * @param isPassed 期待通りならtrue
+     */
+    void check(const char* name, bool isPassed) {
+        printf("[check] %s %s\n", name, isPassed ? "ok" : "FAILED");
+        if (!isPassed) failedNum++;
+    }
+
+    /**
+     * @brief RtosTaskSpecと同じくStack+TCBのサイズでRAM使用量を比較します
+     */
+    void runRam(void) {
+        const size_t taskPerLoopSize = sizeof(TaskBase::StaticStorage<ButtonTaskStackSize>) + sizeof(TaskBase::StaticStorage<LoggerTaskStackSize>);
+        const size_t coopSize = sizeof(TaskBase::StaticStorage<FixedConfig::CoopExecutorStackSize>);
+        printf("[bench] ram task-per-loop ButtonTask=%u LoggerTask=%u[word] stack+tcb=%u[byte]\n",
+            static_cast<uint32_t>(ButtonTaskStackSize), static_cast<uint32_t>(LoggerTaskStackSize), static_cast<uint32_t>(taskPerLoopSize));
+        printf("[bench] ram coop-executor CoopExecutor=%u[word] stack+tcb=%u[byte] saved=%d[byte]\n",
+            static_cast<uint32_t>(FixedConfig::CoopExecutorStackSize), static_cast<uint32_t>(coopSize),
+            static_cast<int32_t>(taskPerLoopSize) - static_cast<int32_t>(coopSize));
+    }
+
+    /****************************** RTOS Task ******************************/
+    /**
+     * @brief Task Notificationで交互に実行権を渡すRTOS Taskです
+     */
+    struct NotifyPingPong {
+        uint32_t iterationNum; /**< 往復回数 */
+        TaskHandle_t pingTask; /**< 先に実行する側 */
+        TaskHandle_t pongTask; /**< 通知を受けて返す側 */
+        TaskHandle_t doneTask; /**< 完了の通知先 */
+    };
+
+    void pingMain(void* pvParameter) {
+        NotifyPingPong* p = static_cast<NotifyPingPong*>(pvParameter);
+        // xTaskCreate()の戻りより先にpongから通知されるので、自身で登録してから始める
+        p->pingTask = xTaskGetCurrentTaskHandle();
+        for (uint32_t i = 0; i < p->iterationNum; i++) {
+            xTaskNotifyGive(p->pongTask);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        xTaskNotifyGive(p->doneTask);
+        vTaskDelete(NULL);
+    }
+
+    void pongMain(void* pvParameter) {
+        NotifyPingPong* p = static_cast<NotifyPingPong*>(pvParameter);
+        for (uint32_t i = 0; i < p->iterationNum; i++) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            xTaskNotifyGive(p->pingTask);
+        }
+        vTaskDelete(NULL);
+    }
+
+    /**
+     * @brief 2つのRTOS Taskの間でTask Notificationにより切り替えます
+     */
+    void runRtosNotify(uint32_t iterationNum) {
+        // pong側は最後の通知後もpを参照するのでstaticにする
+        static NotifyPingPong p = { iterationNum, nullptr, nullptr, xTaskGetCurrentTaskHandle() };
+        const uint64_t startNs = BenchUtil::nowNs();
+        xTaskCreate(pongMain, "pong", ButtonTaskStackSize, &p, 1, &p.pongTask);
+        xTaskCreate(pingMain, "ping", ButtonTaskStackSize, &p, 1, nullptr);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        const uint64_t elapsedNs = BenchUtil::nowNs() - startNs;
+
+        const uint64_t switchNum = static_cast<uint64_t>(iterationNum) * 2;
+        BenchUtil::printThroughput("rtos-notify switch", switchNum, elapsedNs);
+        printf("[bench] rtos-notify switch cost=%llu[ns]\n", static_cast<unsigned long long>(elapsedNs / switchNum));
+    }
+
+    /****************************** CoopTask ******************************/
+    /**
+     * @brief CoopTask間の切り替えを記録します
+     */
+    struct CoopTrace {
+        uint32_t lastId; /**< 最後に再開したCoopTask */
+        uint32_t resumeNum; /**< 再開回数 */
+        uint32_t sameIdNum; /**< 同じCoopTaskが連続して再開した回数 */
+        uint32_t runningNum; /**< 終了していないCoopTask数 */
+        TaskHandle_t doneTask; /**< 全CoopTask終了時の通知先 */
+
+        void resume(uint32_t id) {
+            if ((this->resumeNum > 0) && (this->lastId == id)) this->sameIdNum++;
+            this->lastId = id;
+            this->resumeNum++;
+        }
+
+        void finish(void) {
+            this->runningNum--;
+            if (this->runningNum == 0) {
+                xTaskNotifyGive(this->doneTask);
+            }
+        }
+    };
+
+    /**
+     * @brief COOP_YIELD()で交互に実行権を渡します
+     */
+    class YieldTask : public CoopTask {
+        public:
+            YieldTask(uint32_t id, uint32_t iterationNum, CoopTrace& trace): id(id), iterationNum(iterationNum), count(0), trace(trace) {}
+            const char* getName(void) override { return "YieldTask"; }
+
+            CoopAwait step(void) override {
+                COOP_BEGIN();
+                for (this->count = 0; this->count < this->iterationNum; this->count++) {
+                    this->trace.resume(this->id);
+                    COOP_YIELD();
+                }
+                this->trace.finish();
+                COOP_END();
+            }
+
+        protected:
+            uint32_t id;
+            uint32_t iterationNum;
+            uint32_t count;
+            CoopTrace& trace;
+    };
+
+    /**
+     * @brief IpcWaitSetのbitを通知し合って交互に実行権を渡します
+     * @note IpcQueueにattachした場合と同じく、Task Notificationを経由して再開します
+     */
+    class EventTask : public CoopTask {
+        public:
+            EventTask(uint32_t id, uint32_t iterationNum, CoopTrace& trace, IpcWaitSet& waitSet, uint32_t selfBit, uint32_t peerBit, bool isFirst):
+                id(id), iterationNum(iterationNum), count(0), trace(trace), waitSet(waitSet), selfBit(selfBit), peerBit(peerBit), isFirst(isFirst) {}
+            const char* getName(void) override { return "EventTask"; }
+
+            CoopAwait step(void) override {
+                COOP_BEGIN();
+                for (this->count = 0; this->count < this->iterationNum; this->count++) {
+                    if (!this->isFirst) {
+                        COOP_WAIT_EVENT(this->selfBit, portMAX_DELAY);
+                    }
+                    this->trace.resume(this->id);
+                    this->waitSet.signal(this->peerBit);
+                    if (this->isFirst) {
+                        COOP_WAIT_EVENT(this->selfBit, portMAX_DELAY);
+                    }
+                }
+                this->trace.finish();
+                COOP_END();
+            }
+
+        protected:
+            uint32_t id;
+            uint32_t iterationNum;
+            uint32_t count;
+            CoopTrace& trace;
+            IpcWaitSet& waitSet;
+            uint32_t selfBit;
+            uint32_t peerBit;
+            bool isFirst;
+    };
+
+    /**
+     * @brief 2つのCoopTaskの間でCOOP_YIELD()により切り替えます
+     */
+    void runCoopYield(uint32_t iterationNum) {
+        // 最後のCoopTaskの終了通知後もExecutorのTaskから参照されるのでstaticにする
+        static CoopTrace trace = { 0, 0, 0, 2, xTaskGetCurrentTaskHandle() };
+        static YieldTask a(0, iterationNum, trace);
+        static YieldTask b(1, iterationNum, trace);
+        static CoopExecutor<2> executor("coop-yield");
+        executor.add(a);
+        executor.add(b);
+
+        const uint64_t startNs = BenchUtil::nowNs();
+        executor.createTask(FixedConfig::CoopExecutorStackSize, 1);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        const uint64_t elapsedNs = BenchUtil::nowNs() - startNs;
+
+        BenchUtil::printThroughput("coop-yield switch", trace.resumeNum, elapsedNs);
+        printf("[bench] coop-yield switch cost=%llu[ns]\n", static_cast<unsigned long long>(elapsedNs / trace.resumeNum));
+        check("coop-yield resumes every task in turn", (trace.resumeNum == (iterationNum * 2)) && (trace.sameIdNum == 0));
+    }
+
+    /**
+     * @brief 2つのCoopTaskの間でCOOP_WAIT_EVENT()により切り替えます
+     */
+    void runCoopEvent(uint32_t iterationNum) {
+        static CoopTrace trace = { 0, 0, 0, 2, xTaskGetCurrentTaskHandle() };
+        static CoopExecutor<2> executor("coop-event");
+        const uint32_t bitA = executor.getWaitSet().allocateBit();
+        const uint32_t bitB = executor.getWaitSet().allocateBit();
+        static EventTask a(0, iterationNum, trace, executor.getWaitSet(), bitA, bitB, true);
+        static EventTask b(1, iterationNum, trace, executor.getWaitSet(), bitB, bitA, false);
+        executor.add(a);
+        executor.add(b);
+
+        const uint64_t startNs = BenchUtil::nowNs();
+        executor.createTask(FixedConfig::CoopExecutorStackSize, 1);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        const uint64_t elapsedNs = BenchUtil::nowNs() - startNs;
+
+        BenchUtil::printThroughput("coop-event switch", trace.resumeNum, elapsedNs);
+        printf("[bench] coop-event switch cost=%llu[ns]\n", static_cast<unsigned long long>(elapsedNs / trace.resumeNum));
+        check("coop-event wakes the waiting task", (trace.resumeNum == (iterationNum * 2)) && (trace.sameIdNum == 0));
+    }
+
+    /****************************** Timeout ******************************/
+    /**
+     * @brief COOP_SLEEP_FOR()とCOOP_WAIT_EVENT()のTimeoutで再開するまでの時間を記録します
+     */
+    class TimeoutTask : public CoopTask {
+        public:
+            static constexpr uint32_t SleepTick = 5;
+            static constexpr uint32_t TimeoutTick = 3;
+
+            TimeoutTask(uint32_t unusedBit, CoopTrace& trace): unusedBit(unusedBit), trace(trace), startTick(0), sleptTick(0), waitedTick(0), waitedBits(UINT32_MAX) {}
+            const char* getName(void) override { return "TimeoutTask"; }
+
+            CoopAwait step(void) override {
+                COOP_BEGIN();
+                this->startTick = SysTimer::getTickCount();
+                COOP_SLEEP_FOR(SleepTick);
+                this->sleptTick = SysTimer::getTickCount() - this->startTick;
+
+                this->startTick = SysTimer::getTickCount();
+                COOP_WAIT_EVENT(this->unusedBit, TimeoutTick);
+                this->waitedTick = SysTimer::getTickCount() - this->startTick;
+                this->waitedBits = this->getReceivedBits();
+
+                this->trace.finish();
+                COOP_END();
+            }
+
+            uint32_t unusedBit;
+            CoopTrace& trace;
+            uint32_t startTick;
+            uint32_t sleptTick; /**< COOP_SLEEP_FOR()で待機したtick数 */
+            uint32_t waitedTick; /**< COOP_WAIT_EVENT()で待機したtick数 */
+            uint32_t waitedBits; /**< COOP_WAIT_EVENT()から再開した時のbit */
+    };
+
+    /**
+     * @brief 期限での再開を確認します
+     */
+    void runCoopTimeout(void) {
+        static CoopTrace trace = { 0, 0, 0, 1, xTaskGetCurrentTaskHandle() };
+        static CoopExecutor<1> executor("coop-timeout");
+        static TimeoutTask task(executor.getWaitSet().allocateBit(), trace);
+        executor.add(task);
+
+        executor.createTask(FixedConfig::CoopExecutorStackSize, 1);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        check("coop-sleep resumes after the deadline", task.sleptTick >= TimeoutTask::SleepTick);
+        check("coop-event times out without bits", (task.waitedTick >= TimeoutTask::TimeoutTick) && (task.waitedBits == 0));
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint32_t iterationNum = BenchUtil::getIterationNum(argc, argv, 100000);
+
+    runRam();
+    runRtosNotify(iterationNum);
+    runCoopYield(iterationNum);
+    runCoopEvent(iterationNum);
+    runCoopTimeout();
+
+    // 終了したTaskのThreadも削除処理中の可能性があるので、静的変数のDestructorを走らせずに終了する
+    fflush(stdout);
+    std::_Exit((failedNum == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,84 @@
+/**
+ * @file IpcQueueBench.cpp
+ * @brief IpcQueueのBackendごとにstd::threadのProducer/Consumer間の送受信性能を計測します
+ * @note usage: ipc_queue_bench [iterationNum]
+ *       送信時刻を載せたデータを送り、受信までのLatencyの分布と1秒あたりの送受信数を出力します
+ */
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "../../src/def/MeasureData.h"
+#include "../../src/FixedConfig.h"
+#include "../../src/IpcQueueBackend.h"
+#include "../../src/IpcQueue.h"
+#include "BenchUtil.h"
+
+namespace {
+    /**
+     * @brief 送受信するデータです。実際のTask間通信と同程度のサイズにするためMeasureDataを含めます
+     */
+    struct BenchData {
+        uint64_t sendNs;  /**< 送信時刻[ns] */
+        MeasureData data; /**< 送信内容 */
+    };
+
+    /**
+     * @brief ProducerとConsumerのThreadで送受信し、結果を出力します
+     *
+     * @tparam Backend IpcQueueのBackend
+     * @param name 出力時の名前
+     * @param iterationNum 送受信する回数
+     */
+    template<typename Backend>
+    void run(const char* name, uint32_t iterationNum) {
+        IpcQueue<BenchData, Backend> queue;
+        if (!queue.createQueue(FixedConfig::DefaultQueueSize)) {
+            printf("[bench] %s createQueue failed\n", name);
+            return;
+        }
+
+        std::vector<uint64_t> latencyNs;
+        latencyNs.reserve(iterationNum);
+        uint32_t retryNum = 0;
+
+        const uint64_t startNs = BenchUtil::nowNs();
+        std::thread consumer([&]() {
+            BenchData received;
+            for (uint32_t i = 0; i < iterationNum; i++) {
+                if (!queue.receive(&received, true)) break;
+                latencyNs.push_back(BenchUtil::nowNs() - received.sendNs);
+            }
+        });
+        std::thread producer([&]() {
+            BenchData sending = {};
+            for (uint32_t i = 0; i < iterationNum; i++) {
+                sending.data.timestamp = i;
+                sending.sendNs = BenchUtil::nowNs();
+                // Queue Fullの間はConsumerに譲る
+                while (!queue.send(&sending)) {
+                    retryNum++;
+                    std::this_thread::yield();
+                    sending.sendNs = BenchUtil::nowNs();
+                }
+            }
+        });
+        producer.join();
+        consumer.join();
+        const uint64_t elapsedNs = BenchUtil::nowNs() - startNs;
+
+        BenchUtil::printThroughput(name, latencyNs.size(), elapsedNs);
+        BenchUtil::printLatency(name, latencyNs);
+        printf("[bench] %s depth=%u sendRetry=%u\n", name, static_cast<uint32_t>(queue.getDepth()), retryNum);
+        queue.deleteQueue();
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint32_t iterationNum = BenchUtil::getIterationNum(argc, argv, 200000);
+    run<RtosQueueBackend<BenchData>>("RtosQueueBackend", iterationNum);
+    run<SpscRingBackend<BenchData>>("SpscRingBackend", iterationNum);
+    return 0;
+}
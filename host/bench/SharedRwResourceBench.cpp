@@ -0,0 +1,134 @@
+/**
+ * @file SharedRwResourceBench.cpp
+ * @brief 複数Taskから読み出しが競合した場合の、SharedResourceとSharedRwResourceの性能を計測します
+ * @note usage: shared_rw_resource_bench [iterationNum]
+ *       Reader Thread数を変えながら、各Readerがiteration回読み出した際の合計読み出し数[ops/s]とLock獲得までの待ち時間の分布を出力します
+ *       Writerは1ms周期で書き込みます
+ */
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "../../src/SharedResource.h"
+#include "../../src/SharedRwResource.h"
+#include "BenchUtil.h"
+
+namespace {
+    /**
+     * @brief 共有するデータです。GlobalConfigの読み出し程度の処理量になるよう、全要素を読み出します
+     */
+    struct BenchData {
+        uint32_t values[64]; /**< 読み出し対象 */
+    };
+
+    /**
+     * @brief 読み出し処理です
+     */
+    uint32_t sum(const BenchData& data) {
+        uint32_t result = 0;
+        for (const uint32_t v : data.values) {
+            result += v;
+        }
+        return result;
+    }
+
+    /**
+     * @brief SharedResourceで読み出します
+     */
+    struct ExclusiveReader {
+        SharedResource<BenchData>& resource;
+        template<class F>
+        void read(F functor) { this->resource.operate([&](BenchData& data) { functor(static_cast<const BenchData&>(data)); }); }
+        template<class F>
+        void write(F functor) { this->resource.operate(functor); }
+    };
+
+    /**
+     * @brief SharedRwResourceで読み出します
+     */
+    struct SharedReader {
+        SharedRwResource<BenchData>& resource;
+        template<class F>
+        void read(F functor) { this->resource.read(functor); }
+        template<class F>
+        void write(F functor) { this->resource.write(functor); }
+    };
+
+    /**
+     * @brief ReaderとWriterのThreadで読み書きし、結果を出力します
+     *
+     * @tparam R ExclusiveReader/SharedReader
+     * @param name 出力時の名前
+     * @param accessor 読み書きの実装
+     * @param readerNum Reader Thread数
+     * @param iterationNum Readerごとの読み出し回数
+     */
+    template<typename R>
+    void run(const char* name, R accessor, uint32_t readerNum, uint32_t iterationNum) {
+        std::vector<std::vector<uint64_t>> waitNs(readerNum);
+        std::atomic<bool> isReading(true);
+        std::atomic<uint32_t> checksum(0);
+
+        const uint64_t startNs = BenchUtil::nowNs();
+        std::thread writer([&]() {
+            uint32_t count = 0;
+            while (isReading.load()) {
+                accessor.write([&](BenchData& data) {
+                    for (uint32_t& v : data.values) {
+                        v = count;
+                    }
+                });
+                count++;
+                vTaskDelay(1);
+            }
+        });
+        std::vector<std::thread> readers;
+        for (uint32_t r = 0; r < readerNum; r++) {
+            readers.emplace_back([&, r]() {
+                waitNs[r].reserve(iterationNum);
+                uint32_t localSum = 0;
+                for (uint32_t i = 0; i < iterationNum; i++) {
+                    const uint64_t beforeNs = BenchUtil::nowNs();
+                    accessor.read([&](const BenchData& data) {
+                        waitNs[r].push_back(BenchUtil::nowNs() - beforeNs);
+                        localSum += sum(data);
+                    });
+                }
+                checksum += localSum;
+            });
+        }
+        for (std::thread& t : readers) {
+            t.join();
+        }
+        const uint64_t elapsedNs = BenchUtil::nowNs() - startNs;
+        isReading.store(false);
+        writer.join();
+
+        std::vector<uint64_t> allWaitNs;
+        for (const std::vector<uint64_t>& w : waitNs) {
+            allWaitNs.insert(allWaitNs.end(), w.begin(), w.end());
+        }
+        char label[64];
+        snprintf(label, sizeof(label), "%s readers=%u", name, readerNum);
+        BenchUtil::printThroughput(label, allWaitNs.size(), elapsedNs);
+        BenchUtil::printLatency(label, allWaitNs);
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint32_t iterationNum = BenchUtil::getIterationNum(argc, argv, 100000);
+    static BenchData exclusiveData = {};
+    static BenchData sharedData = {};
+    static SharedResource<BenchData> exclusive(exclusiveData, "exclusive");
+    static SharedRwResource<BenchData> shared(sharedData, "shared");
+
+    const uint32_t readerNums[] = { 1, 2, 4 };
+    for (const uint32_t readerNum : readerNums) {
+        run("SharedResource", ExclusiveReader{ exclusive }, readerNum, iterationNum);
+        run("SharedRwResource", SharedReader{ shared }, readerNum, iterationNum);
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file ZeroCopyQueueBench.cpp
+ * @brief WifiTaskの要求/応答について、IpcQueueのsend/receiveとZeroCopyQueueのloan/commit, peek/releaseの送受信性能を比較します
+ * @note usage: zero_copy_queue_bench [iterationNum]
+ *       std::threadのProducer/Consumer間でiteration回送受信し、1秒あたりの送受信数と1メッセージあたりのコピー量を出力します
+ *       コピー量はsend/receiveがQueueとの間でそれぞれsizeof(T)をコピーするのに対し、loan/peekはQueueの領域を直接読み書きするので0です
+ */
+#include <cstdint>
+#include <thread>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "../../src/def/WifiTaskData.h"
+#include "../../src/FixedConfig.h"
+#include "../../src/IpcQueueBackend.h"
+#include "../../src/IpcQueue.h"
+#include "../../src/IpcQueueDefs.h"
+#include "BenchUtil.h"
+
+namespace {
+    /**
+     * @brief 結果を出力します
+     *
+     * @param name 出力時の名前
+     * @param dataSize 1メッセージのサイズ
+     * @param copyBytes 1メッセージあたりのQueueとの間のコピー量
+     * @param receivedNum 受信できた数
+     * @param orderErrorNum 送信順に受信できなかった数
+     * @param elapsedNs 経過時間[ns]
+     */
+    void print(const char* name, size_t dataSize, size_t copyBytes, uint32_t receivedNum, uint32_t orderErrorNum, uint64_t elapsedNs) {
+        BenchUtil::printThroughput(name, receivedNum, elapsedNs);
+        printf("[bench] %s size=%u copy=%u[byte/msg] orderError=%u\n",
+            name, static_cast<uint32_t>(dataSize), static_cast<uint32_t>(copyBytes), orderErrorNum);
+    }
+
+    /**
+     * @brief send/receiveで送受信します
+     *
+     * @tparam T 送受信するデータ型, idに送信順を書き込みます
+     * @tparam Backend IpcQueueのBackend
+     * @param name 出力時の名前
+     * @param iterationNum 送受信する回数
+     */
+    template<typename T, typename Backend>
+    void runCopy(const char* name, uint32_t iterationNum) {
+        IpcQueue<T, Backend> queue;
+        if (!queue.createQueue(FixedConfig::DefaultQueueSize)) {
+            printf("[bench] %s createQueue failed\n", name);
+            return;
+        }
+
+        uint32_t receivedNum = 0;
+        uint32_t orderErrorNum = 0;
+        const uint64_t startNs = BenchUtil::nowNs();
+        std::thread consumer([&]() {
+            T received;
+            for (uint32_t i = 0; i < iterationNum; i++) {
+                if (!queue.receive(&received, true)) break;
+                if (static_cast<uint32_t>(received.id) != i) orderErrorNum++;
+                receivedNum++;
+            }
+        });
+        std::thread producer([&]() {
+            T sending = {};
+            for (uint32_t i = 0; i < iterationNum; i++) {
+                sending.id = static_cast<WifiTaskRequestId>(i);
+                // Queue Fullの間はConsumerに譲る
+                while (!queue.send(&sending)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        producer.join();
+        consumer.join();
+        const uint64_t elapsedNs = BenchUtil::nowNs() - startNs;
+
+        // send時にQueueへ、receive時にQueueからそれぞれ1回コピーする
+        print(name, sizeof(T), sizeof(T) * 2, receivedNum, orderErrorNum, elapsedNs);
+        queue.deleteQueue();
+    }
+
+    /**
+     * @brief loan/commit, peek/releaseで送受信します
+     *
+     * @tparam T 送受信するデータ型, idに送信順を書き込みます
+     * @param name 出力時の名前
+     * @param iterationNum 送受信する回数
+     */
+    template<typename T>
+    void runZeroCopy(const char* name, uint32_t iterationNum) {
+        ZeroCopyQueue<T> queue;
+        if (!queue.createQueue(FixedConfig::DefaultQueueSize)) {
+            printf("[bench] %s createQueue failed\n", name);
+            return;
+        }
+
+        uint32_t receivedNum = 0;
+        uint32_t orderErrorNum = 0;
+        const uint64_t startNs = BenchUtil::nowNs();
+        std::thread consumer([&]() {
+            for (uint32_t i = 0; i < iterationNum; i++) {
+                const T* received = queue.peek(true);
+                if (received == nullptr) break;
+                if (static_cast<uint32_t>(received->id) != i) orderErrorNum++;
+                receivedNum++;
+                queue.release();
+            }
+        });
+        std::thread producer([&]() {
+            for (uint32_t i = 0; i < iterationNum; i++) {
+                // Queue Fullの間はConsumerに譲る
+                T* sending = queue.loan();
+                while (sending == nullptr) {
+                    std::this_thread::yield();
+                    sending = queue.loan();
+                }
+                sending->id = static_cast<WifiTaskRequestId>(i);
+                queue.commit();
+            }
+        });
+        producer.join();
+        consumer.join();
+        const uint64_t elapsedNs = BenchUtil::nowNs() - startNs;
+
+        // Queueの領域に直接書き込み、直接読み出す
+        print(name, sizeof(T), 0, receivedNum, orderErrorNum, elapsedNs);
+        queue.deleteQueue();
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint32_t iterationNum = BenchUtil::getIterationNum(argc, argv, 200000);
+
+    runCopy<WifiTaskRequest, RtosQueueBackend<WifiTaskRequest>>("request send/receive RtosQueueBackend", iterationNum);
+    runCopy<WifiTaskRequest, SpscRingBackend<WifiTaskRequest>>("request send/receive SpscRingBackend", iterationNum);
+    runZeroCopy<WifiTaskRequest>("request loan/peek ZeroCopyQueue", iterationNum);
+
+    runCopy<WifiTaskResponse, RtosQueueBackend<WifiTaskResponse>>("response send/receive RtosQueueBackend", iterationNum);
+    runCopy<WifiTaskResponse, SpscRingBackend<WifiTaskResponse>>("response send/receive SpscRingBackend", iterationNum);
+    runZeroCopy<WifiTaskResponse>("response loan/peek ZeroCopyQueue", iterationNum);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef AMBIENT_H
+#define AMBIENT_H
+
+/**
+ * @file Ambient.h
+ * @brief Host(Linux)向けのAmbient Clientです。送信は常に失敗します
+ */
+
+#include <cstdint>
+
+#include <AtWiFi.h>
+
+class Ambient {
+    public:
+        bool begin(uint32_t channelId, const char* writeKey, WiFiClient* client) {
+            (void)channelId;
+            (void)writeKey;
+            (void)client;
+            return true;
+        }
+        bool set(int field, const char* data) {
+            (void)field;
+            (void)data;
+            return true;
+        }
+        bool send(void) { return false; }
+};
+
+#endif /* AMBIENT_H */
@@ -0,0 +1,150 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/**
+ * @file Arduino.h
+ * @brief Host(Linux)向けにArduino APIのうちProjectで使用する範囲を実装します
+ * @note 時刻はsteady_clock、SerialはstdoutとstdinにMappingされます。GPIOは値を保持するだけです
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdarg>
+#include <string>
+
+/****************************** Time ******************************/
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+/****************************** GPIO ******************************/
+#define LOW          0
+#define HIGH         1
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+
+/**
+ * @brief Wio Terminalのピン番号です。Host上では値を保持する配列のindexとして使います
+ */
+enum : uint8_t {
+    WIO_KEY_A = 0,
+    WIO_KEY_B,
+    WIO_KEY_C,
+    WIO_5S_UP,
+    WIO_5S_DOWN,
+    WIO_5S_LEFT,
+    WIO_5S_RIGHT,
+    WIO_5S_PRESS,
+    LED_BUILTIN,
+    SDCARD_SS_PIN,
+    HostPinNum,
+};
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+/****************************** Print ******************************/
+class Print;
+
+/**
+ * @brief Printで出力できるclassの基底です
+ */
+class Printable {
+    public:
+        virtual ~Printable(void) {}
+        virtual size_t printTo(Print& p) const = 0;
+};
+
+/**
+ * @brief Arduino Printの互換実装です
+ */
+class Print {
+    public:
+        virtual ~Print(void) {}
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t* buffer, size_t size) {
+            size_t n = 0;
+            while ((n < size) && (this->write(buffer[n]) == 1)) {
+                n++;
+            }
+            return n;
+        }
+        size_t write(const char* str) { return this->write(reinterpret_cast<const uint8_t*>(str), strlen(str)); }
+
+        size_t print(const char* str) { return this->write(str); }
+        size_t print(const std::string& str) { return this->write(str.c_str()); }
+        size_t print(char c) { return this->write(static_cast<uint8_t>(c)); }
+        size_t print(int v) { return this->printf("%d", v); }
+        size_t print(unsigned int v) { return this->printf("%u", v); }
+        size_t print(long v) { return this->printf("%ld", v); }
+        size_t print(unsigned long v) { return this->printf("%lu", v); }
+        size_t print(double v, int digits = 2) { return this->printf("%.*f", digits, v); }
+        size_t print(bool v) { return this->print(static_cast<int>(v)); }
+        size_t print(const Printable& v) { return v.printTo(*this); }
+
+        template<typename T>
+        size_t println(const T& v) { return this->print(v) + this->println(); }
+        size_t println(void) { return this->write("\r\n"); }
+
+        size_t printf(const char* format, ...) {
+            char buffer[256];
+            va_list args;
+            va_start(args, format);
+            const int len = vsnprintf(buffer, sizeof(buffer), format, args);
+            va_end(args);
+            if (len <= 0) return 0;
+            const size_t size = (static_cast<size_t>(len) < sizeof(buffer)) ? static_cast<size_t>(len) : (sizeof(buffer) - 1);
+            return this->write(reinterpret_cast<const uint8_t*>(buffer), size);
+        }
+
+    private:
+        static size_t strlen(const char* str) {
+            size_t n = 0;
+            while (str[n] != '\0') n++;
+            return n;
+        }
+};
+
+/**
+ * @brief Arduino Stringの互換実装です。数値の文字列化のみ対応します
+ */
+class String {
+    public:
+        String(const char* str = ""): value(str) {}
+        explicit String(int v): value(std::to_string(v)) {}
+        explicit String(unsigned int v): value(std::to_string(v)) {}
+        explicit String(long v): value(std::to_string(v)) {}
+        explicit String(unsigned long v): value(std::to_string(v)) {}
+        explicit String(double v, unsigned int digits = 2) {
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%.*f", digits, v);
+            this->value = buffer;
+        }
+        const char* c_str(void) const { return this->value.c_str(); }
+        size_t length(void) const { return this->value.length(); }
+    private:
+        std::string value;
+};
+
+/****************************** Serial ******************************/
+/**
+ * @brief USB CDCの互換実装です。出力はstdout、入力はstdinです
+ */
+class Serial_ : public Print {
+    public:
+        void begin(uint32_t baudrate) { (void)baudrate; }
+        explicit operator bool(void) const { return true; }
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+        int available(void);
+        int read(void);
+};
+
+extern Serial_ Serial;
+
+#endif /* ARDUINO_H */
@@ -0,0 +1,79 @@
+#ifndef ATWIFI_H
+#define ATWIFI_H
+
+/**
+ * @file AtWiFi.h
+ * @brief Host(Linux)向けのWiFiです。APには接続できず、常に未接続として振る舞います
+ */
+
+#include <cstdint>
+
+#include <Arduino.h>
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL,
+    WL_SCAN_COMPLETED,
+    WL_CONNECTED,
+    WL_CONNECT_FAILED,
+    WL_CONNECTION_LOST,
+    WL_DISCONNECTED,
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA,
+    WIFI_AP,
+    WIFI_AP_STA,
+} wifi_mode_t;
+
+/**
+ * @brief IPv4 Addressです
+ */
+class IPAddress : public Printable {
+    public:
+        IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0): octets{a, b, c, d} {}
+        uint8_t operator[](int index) const { return this->octets[index]; }
+        size_t printTo(Print& p) const override {
+            return p.printf("%d.%d.%d.%d", this->octets[0], this->octets[1], this->octets[2], this->octets[3]);
+        }
+    private:
+        uint8_t octets[4];
+};
+
+/**
+ * @brief TCP Clientです。接続は常に失敗します
+ */
+class WiFiClient {
+    public:
+        int connect(const char* host, uint16_t port) {
+            (void)host;
+            (void)port;
+            return 0;
+        }
+        void stop(void) {}
+};
+
+/**
+ * @brief WiFi Moduleです
+ */
+class WiFiClass {
+    public:
+        bool mode(wifi_mode_t m) {
+            (void)m;
+            return true;
+        }
+        wl_status_t begin(const char* ssid, const char* passphrase) {
+            (void)ssid;
+            (void)passphrase;
+            return WL_DISCONNECTED;
+        }
+        bool disconnect(void) { return true; }
+        wl_status_t status(void) { return WL_DISCONNECTED; }
+        IPAddress localIP(void) { return IPAddress(); }
+};
+
+extern WiFiClass WiFi;
+
+#endif /* ATWIFI_H */
@@ -0,0 +1,19 @@
+#ifndef DIGITAL_LIGHT_TSL2561_H
+#define DIGITAL_LIGHT_TSL2561_H
+
+/**
+ * @file Digital_Light_TSL2561.h
+ * @brief Host(Linux)向けの照度センサです。時刻に応じた擬似的な値を返します
+ */
+
+#include <cstdint>
+
+class TSL2561_CalculateLux {
+    public:
+        void init(void) {}
+        float readVisibleLux(void);
+};
+
+extern TSL2561_CalculateLux TSL2561;
+
+#endif /* DIGITAL_LIGHT_TSL2561_H */
@@ -0,0 +1,6 @@
+#ifndef LOVYANGFX_H
+#define LOVYANGFX_H
+
+#include "LovyanGFX.hpp"
+
+#endif /* LOVYANGFX_H */
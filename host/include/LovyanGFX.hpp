@@ -0,0 +1,83 @@
+#ifndef LOVYANGFX_HPP
+#define LOVYANGFX_HPP
+
+/**
+ * @file LovyanGFX.hpp
+ * @brief Host(Linux)向けのLCDです。描画は行わず、描画命令の回数のみ数えます
+ */
+
+#include <cstdint>
+
+#include <Arduino.h>
+
+/**
+ * @brief Fontの指定に使います。Host上では区別しません
+ */
+struct HostFont {};
+static const HostFont Font0 = {};
+static const HostFont Font2 = {};
+static const HostFont Font4 = {};
+
+/**
+ * @brief LovyanGFXの描画APIです
+ */
+class LovyanGFX : public Print {
+    public:
+        LovyanGFX(void): drawNum(0), textNum(0), brightness(0), brightnessTrace(nullptr) {}
+
+        void setRotation(uint8_t r) { (void)r; }
+        void setTextSize(float size) { (void)size; }
+        void setFont(const HostFont* font) { (void)font; }
+        void setCursor(int32_t x, int32_t y) { (void)x; (void)y; }
+        void setTextColor(uint32_t fg) { (void)fg; }
+        void setTextColor(uint32_t fg, uint32_t bg) { (void)fg; (void)bg; }
+        void setBrightness(uint8_t b) {
+            if ((this->brightnessTrace != nullptr) && (this->brightness != b)) {
+                this->brightnessTrace->printf("[LCD] ms=%u brightness=%u\n", millis(), b);
+            }
+            this->brightness = b;
+        }
+        uint8_t getBrightness(void) const { return this->brightness; }
+        static constexpr uint32_t color888(uint8_t r, uint8_t g, uint8_t b) { return (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b; }
+
+        void clear(void) { this->drawNum++; }
+        void fillScreen(uint32_t color) { (void)color; this->drawNum++; }
+        void drawPixel(int32_t x, int32_t y, uint32_t color) { (void)x; (void)y; (void)color; this->drawNum++; }
+        void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) { (void)x0; (void)y0; (void)x1; (void)y1; (void)color; this->drawNum++; }
+        void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) { (void)x; (void)y; (void)w; (void)h; (void)color; this->drawNum++; }
+
+        size_t write(uint8_t c) override { (void)c; this->textNum++; return 1; }
+        using Print::write;
+
+        /**
+         * @brief これまでの描画命令の回数を取得します。Host向けの拡張です
+         */
+        uint32_t getDrawNum(void) const { return this->drawNum; }
+
+        /**
+         * @brief これまでに出力した文字数を取得します。Host向けの拡張です
+         */
+        uint32_t getTextNum(void) const { return this->textNum; }
+
+        /**
+         * @brief Backlightの明るさが変化する度に時刻と値を出力します。Host向けの拡張です
+         *
+         * @param dst 出力先, nullptrなら出力しない
+         */
+        void setBrightnessTrace(Print* dst) { this->brightnessTrace = dst; }
+    protected:
+        uint32_t drawNum;   /**< 描画命令の回数 */
+        uint32_t textNum;   /**< 出力した文字数 */
+        uint8_t brightness; /**< Backlightの明るさ */
+        Print* brightnessTrace; /**< 明るさの変化の出力先 */
+};
+
+/**
+ * @brief Wio Terminalの内蔵LCDです
+ */
+class LGFX : public LovyanGFX {
+    public:
+        bool begin(void) { return true; }
+};
+
+#endif /* LOVYANGFX_HPP */
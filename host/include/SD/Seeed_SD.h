@@ -0,0 +1,14 @@
+#ifndef SEEED_SD_H
+#define SEEED_SD_H
+
+/**
+ * @file Seeed_SD.h
+ * @brief Host(Linux)向けのSD Cardです
+ */
+
+#include <SPI.h>
+#include <Seeed_FS.h>
+
+extern SDFS SD;
+
+#endif /* SEEED_SD_H */
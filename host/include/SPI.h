@@ -0,0 +1,20 @@
+#ifndef SPI_H
+#define SPI_H
+
+/**
+ * @file SPI.h
+ * @brief Host(Linux)向けのSPIです。SD Cardの指定にのみ使用します
+ */
+
+#include <cstdint>
+
+class SPIClass {
+    public:
+        void begin(void) {}
+};
+
+extern SPIClass SPI;
+
+#define SDCARD_SPI SPI
+
+#endif /* SPI_H */
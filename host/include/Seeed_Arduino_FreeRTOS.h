@@ -0,0 +1,149 @@
+#ifndef SEEED_ARDUINO_FREERTOS_H
+#define SEEED_ARDUINO_FREERTOS_H
+
+/**
+ * @file Seeed_Arduino_FreeRTOS.h
+ * @brief Host(Linux)向けにFreeRTOS APIのうちProjectで使用する範囲をstd::thread/std::mutex/std::condition_variableで実装します
+ * @note TaskはOSのThreadとして並列に動作します。Task優先度とStackSizeは記録のみで、Schedulingには反映されません
+ * @note Critical SectionとScheduler停止は1つのrecursive_mutexで実装します。Critical Section同士は排他されますが、それ以外のTaskは止まりません
+ * @note Tickはsteady_clockの起動からの経過時間[ms]です
+ */
+
+#include <cstdint>
+#include <cstddef>
+
+/****************************** Config ******************************/
+#define configTICK_RATE_HZ                 1000
+#define configMAX_PRIORITIES               10
+#define configSUPPORT_STATIC_ALLOCATION    1
+#define configSUPPORT_DYNAMIC_ALLOCATION   1
+#define configUSE_TRACE_FACILITY           0
+#define configGENERATE_RUN_TIME_STATS      0
+// Idle/Timer Service TaskはHost実装では作成しないが、vApplicationGet*TaskMemory()とRtosTopologyの集計をTargetと同じ構成でビルドする
+#define configMINIMAL_STACK_SIZE           256
+#define configUSE_TIMERS                   1
+#define configTIMER_TASK_PRIORITY          (configMAX_PRIORITIES - 1)
+#define configTIMER_TASK_STACK_DEPTH       512
+
+/****************************** Type ******************************/
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t StackType_t;
+typedef void (*TaskFunction_t)(void*);
+
+struct HostTask;
+struct HostQueue;
+typedef HostTask* TaskHandle_t;
+typedef HostQueue* QueueHandle_t;
+typedef HostQueue* SemaphoreHandle_t;
+
+/**
+ * @brief 静的確保用の領域です
+ * @note Host実装では管理領域は別に確保するため使用しませんが、RtosTopologyのRAM集計がTargetと近くなるよう同程度のサイズにしています
+ */
+typedef struct { uint8_t reserved[96]; } StaticTask_t;
+typedef struct { uint8_t reserved[80]; } StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+#define pdFALSE            ((BaseType_t)0)
+#define pdTRUE             ((BaseType_t)1)
+#define pdFAIL             pdFALSE
+#define pdPASS             pdTRUE
+#define portMAX_DELAY      ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portTICK_RATE_MS   portTICK_PERIOD_MS
+#define tskIDLE_PRIORITY   ((UBaseType_t)0)
+
+/****************************** Critical Section ******************************/
+void vHostEnterCritical(void);
+void vHostExitCritical(void);
+#define taskENTER_CRITICAL() vHostEnterCritical()
+#define taskEXIT_CRITICAL()  vHostExitCritical()
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+
+/****************************** Task ******************************/
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth, void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask);
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char* pcName, uint32_t ulStackDepth, void* pvParameters, UBaseType_t uxPriority, StackType_t* puxStackBuffer, StaticTask_t* pxTaskBuffer);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(TickType_t xTicksToDelay);
+void vTaskDelayUntil(TickType_t* pxPreviousWakeTime, TickType_t xTimeIncrement);
+void taskYIELD(void);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+char* pcTaskGetName(TaskHandle_t xTaskToQuery);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask);
+
+/**
+ * @brief Timeout計測の開始状態です。SysTimer::getTickCount64()がTickのOverflow回数の取得に使います
+ */
+typedef struct xTIME_OUT {
+    BaseType_t xOverflowCount;
+    TickType_t xTimeOnEntering;
+} TimeOut_t;
+void vTaskSetTimeOutState(TimeOut_t* const pxTimeOut);
+
+/****************************** Task Notification ******************************/
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t* pulNotificationValue, TickType_t xTicksToWait);
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+
+/****************************** Queue ******************************/
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+QueueHandle_t xQueueCreateStatic(UBaseType_t uxQueueLength, UBaseType_t uxItemSize, uint8_t* pucQueueStorage, StaticQueue_t* pxStaticQueue);
+void vQueueDelete(QueueHandle_t xQueue);
+BaseType_t xQueueReset(QueueHandle_t xQueue);
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait);
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait);
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue);
+#define xQueueSendToBack(xQueue, pvItemToQueue, xTicksToWait) xQueueSend((xQueue), (pvItemToQueue), (xTicksToWait))
+
+/****************************** Semaphore ******************************/
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* pxMutexBuffer);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* pxSemaphoreBuffer);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount, StaticSemaphore_t* pxSemaphoreBuffer);
+#define xSemaphoreTake(xSemaphore, xBlockTime) xQueueReceive((xSemaphore), nullptr, (xBlockTime))
+#define xSemaphoreGive(xSemaphore)             xQueueSend((xSemaphore), nullptr, 0)
+#define vSemaphoreDelete(xSemaphore)           vQueueDelete((xSemaphore))
+
+/****************************** Memory ******************************/
+void* pvPortMalloc(size_t xWantedSize);
+void vPortFree(void* pv);
+
+/****************************** Seeed Extension ******************************/
+void vSetErrorLed(uint8_t pin, uint8_t activeState);
+
+/****************************** Host Extension ******************************/
+/**
+ * @brief 以降を仮想時間で実行します。setup()でTaskを作成する前に呼び出してください
+ * @note 実行権を持つTaskは常に1つで、Tickは全Taskが待機した時点で次の起床時刻まで進みます
+ *       Task内の処理時間は0として扱うので、同じ入力なら実行結果は毎回一致します
+ */
+void vHostSimulationStart(void);
+
+/**
+ * @brief 仮想時間で実行中ならpdTRUEを返します
+ */
+BaseType_t xHostIsSimulation(void);
+
+/**
+ * @brief 起動からの経過時間[us]を取得します。仮想時間実行中は仮想時刻を返します
+ */
+uint64_t ullHostGetTimeUs(void);
+
+#endif /* SEEED_ARDUINO_FREERTOS_H */
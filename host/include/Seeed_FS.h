@@ -0,0 +1,109 @@
+#ifndef SEEED_FS_H
+#define SEEED_FS_H
+
+/**
+ * @file Seeed_FS.h
+ * @brief Host(Linux)向けのFile Systemです。SD Cardのroot以下をHostのDirectoryにMappingします
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <Arduino.h>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+/**
+ * @brief 開いたFileです。stdioのFILEをWrapします
+ */
+class File : public Print {
+    public:
+        File(FILE* fp = nullptr): fp(fp) {}
+        explicit operator bool(void) const { return this->fp != nullptr; }
+        size_t write(uint8_t c) override { return this->write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override {
+            if (this->fp == nullptr) return 0;
+            return fwrite(buffer, 1, size, this->fp);
+        }
+        using Print::write;
+        int read(void) {
+            if (this->fp == nullptr) return -1;
+            return fgetc(this->fp);
+        }
+        size_t read(void* buffer, size_t size) {
+            if (this->fp == nullptr) return 0;
+            return fread(buffer, 1, size, this->fp);
+        }
+        int available(void) {
+            if (this->fp == nullptr) return 0;
+            const long current = ftell(this->fp);
+            fseek(this->fp, 0, SEEK_END);
+            const long end = ftell(this->fp);
+            fseek(this->fp, current, SEEK_SET);
+            return static_cast<int>(end - current);
+        }
+        void flush(void) {
+            if (this->fp != nullptr) fflush(this->fp);
+        }
+        void close(void) {
+            if (this->fp == nullptr) return;
+            fclose(this->fp);
+            this->fp = nullptr;
+        }
+    private:
+        FILE* fp;
+};
+
+/**
+ * @brief SD CardのFile Systemです
+ */
+class SDFS {
+    public:
+        SDFS(void): rootPath(".") {}
+
+        /**
+         * @brief SD Cardのrootに対応するHostのDirectoryを設定します。Host向けの拡張です
+         *
+         * @param path Directoryのパス
+         */
+        void setRootPath(const char* path) { this->rootPath = path; }
+
+        template<typename P>
+        bool begin(uint8_t ssPin, P& spi) {
+            (void)ssPin;
+            (void)spi;
+            return true;
+        }
+
+        File open(const char* path, const char* mode = FILE_READ) {
+            // "r"以外はbinaryで開く, Targetと同じくFILE_WRITEは先頭から上書きする
+            const std::string fullPath = this->rootPath + "/" + path;
+            const std::string fopenMode = std::string(mode) + "b";
+            return File(fopen(fullPath.c_str(), fopenMode.c_str()));
+        }
+
+        bool exists(const char* path) {
+            File f = this->open(path, FILE_READ);
+            const bool result = static_cast<bool>(f);
+            f.close();
+            return result;
+        }
+
+        bool remove(const char* path) {
+            const std::string fullPath = this->rootPath + "/" + path;
+            return (::remove(fullPath.c_str()) == 0);
+        }
+
+        bool rename(const char* pathFrom, const char* pathTo) {
+            const std::string fullPathFrom = this->rootPath + "/" + pathFrom;
+            const std::string fullPathTo = this->rootPath + "/" + pathTo;
+            return (::rename(fullPathFrom.c_str(), fullPathTo.c_str()) == 0);
+        }
+    private:
+        std::string rootPath; /**< SD Cardのrootに対応するDirectory */
+};
+
+#endif /* SEEED_FS_H */
@@ -0,0 +1,18 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+/**
+ * @file Wire.h
+ * @brief Host(Linux)向けのI2Cです。センサはI2Cを使わずに値を生成するので、初期化のみ行えます
+ */
+
+#include <cstdint>
+
+class TwoWire {
+    public:
+        void begin(void) {}
+};
+
+extern TwoWire Wire;
+
+#endif /* WIRE_H */
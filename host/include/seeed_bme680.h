@@ -0,0 +1,80 @@
+#ifndef SEEED_BME680_H
+#define SEEED_BME680_H
+
+/**
+ * @file seeed_bme680.h
+ * @brief Host(Linux)向けの温湿度/気圧/ガスセンサです。時刻に応じた擬似的な値を返します
+ * @note Forced Modeの変換時間も模擬するので、Bosch APIで変換完了前に読み出すと新しいデータはありません
+ */
+
+#include <cstdint>
+
+#define BME680_OK            INT8_C(0)
+#define BME680_SLEEP_MODE    UINT8_C(0)
+#define BME680_FORCED_MODE   UINT8_C(1)
+#define BME680_NEW_DATA_MSK  UINT8_C(0x80)
+#define BME680_HEAT_STAB_MSK UINT8_C(0x10)
+#define BME680_DISABLE_GAS_MEAS UINT8_C(0x00)
+#define BME680_ENABLE_GAS_MEAS  UINT8_C(0x01)
+#define BME680_GAS_SENSOR_SEL   UINT16_C(0xC8)
+
+struct bme680_gas_sett {
+    uint16_t heatr_temp; /**< [degC] */
+    uint16_t heatr_dur;  /**< [ms] */
+    uint8_t run_gas;     /**< BME680_ENABLE_GAS_MEAS/BME680_DISABLE_GAS_MEAS */
+};
+
+/**
+ * @brief Bosch APIのDevice設定です。Hostで使うメンバのみ定義しています
+ */
+struct bme680_dev {
+    uint8_t power_mode;              /**< BME680_SLEEP_MODE/BME680_FORCED_MODE */
+    struct bme680_gas_sett gas_sett; /**< ヒーター設定 */
+    uint64_t triggerUs;              /**< Host向けの拡張, 変換を開始した時刻 */
+};
+
+/**
+ * @brief Bosch APIの測定結果です(整数補正版)
+ */
+struct bme680_field_data {
+    uint8_t status;          /**< BME680_NEW_DATA_MSKなど */
+    uint8_t gas_index;
+    uint8_t meas_index;
+    int16_t temperature;     /**< [degC x100] */
+    uint32_t pressure;       /**< [Pa] */
+    uint32_t humidity;       /**< [% x1000] */
+    uint32_t gas_resistance; /**< [ohm] */
+};
+
+int8_t bme680_set_sensor_settings(uint16_t desired_settings, struct bme680_dev* dev);
+int8_t bme680_set_sensor_mode(struct bme680_dev* dev);
+void bme680_get_profile_dur(uint16_t* duration, const struct bme680_dev* dev);
+int8_t bme680_get_sensor_data(struct bme680_field_data* data, struct bme680_dev* dev);
+
+struct sensor_result_value_t {
+    float temperature; /**< [degC] */
+    float pressure;    /**< [Pa] */
+    float humidity;    /**< [%] */
+    float gas;         /**< [ohm] */
+};
+
+class Seeed_BME680 {
+    public:
+        Seeed_BME680(uint8_t addr): addr(addr) {}
+        bool init(void) {
+            this->sensor_param.power_mode = BME680_SLEEP_MODE;
+            this->sensor_param.gas_sett.heatr_temp = 320;
+            this->sensor_param.gas_sett.heatr_dur = 150;
+            this->sensor_param.gas_sett.run_gas = BME680_ENABLE_GAS_MEAS;
+            this->sensor_param.triggerUs = 0;
+            return true;
+        }
+        int8_t read_sensor_data(void);
+
+        sensor_result_value_t sensor_result_value; /**< read_sensor_data()の結果 */
+        struct bme680_dev sensor_param; /**< Bosch APIのDevice設定 */
+    private:
+        uint8_t addr;
+};
+
+#endif /* SEEED_BME680_H */
@@ -0,0 +1,85 @@
+/**
+ * @file main.cpp
+ * @brief wfh_monitor.inoをHost(Linux)上のProcessとして実行します
+ * @note usage: wfh_monitor_host [--sim] [--scenario file] [--trace-lcd] [runSec] [sdRootPath]
+ *       runSec秒(0なら無期限)動作させた後、各Taskの実行統計とLock競合統計を出力して終了します
+ *       SD Cardのrootはデフォルトでカレントディレクトリです
+ *       --sim: 仮想時間で実行します。Taskが待機している間の時間は即座に進むので、長時間の動作を短時間で再現性のある形で確認できます
+ *       --scenario: センサ値/ボタン/Serial入力を時刻指定で与えます。書式はHostScenario.hを参照
+ *       --trace-lcd: Backlightの明るさが変化した時刻と値を出力します
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include "HostScenario.h"
+
+// Arduino Builder同様、.inoの前にArduino.hを読み込む
+#include <Arduino.h>
+#include "../wfh_monitor.ino"
+
+/**
+ * @brief 終了時に統計を出力します
+ */
+static void printSummary(void) {
+    Serial.print("\n[HOST] summary tick=");
+    SysTimer::print64(Serial, SysTimer::getTickCount64());
+    Serial.println();
+    TaskBase::forEach([&](TaskBase& task){
+        Serial.printf("[HOST] task=%s stall=%u\n", task.getName(), task.getStallNum());
+        TaskProfile profile;
+        if (task.getProfile(profile)) {
+            printTaskProfile(Serial, task.getName(), profile);
+        }
+    });
+    ScopedTimerStats::forEach([&](ScopedTimerStats& stats){
+        ScopedTimerProfile profile;
+        if (stats.get(profile)) {
+            printScopedTimerProfile(Serial, stats.getName(), profile);
+        }
+    });
+    sharedSerial.printStats(Serial);
+    sharedSd.printStats(Serial);
+    sharedConfig.printStats(Serial);
+    Serial.printf("[HOST] lcd draw=%u text=%u\n", lcd.getDrawNum(), lcd.getTextNum());
+}
+
+int main(int argc, char** argv) {
+    bool isSimulation = false;
+    uint32_t runSec = 0;
+    uint32_t positionalNum = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sim") == 0) {
+            isSimulation = true;
+        } else if ((strcmp(argv[i], "--scenario") == 0) && ((i + 1) < argc)) {
+            if (!hostScenario.load(argv[++i])) {
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--trace-lcd") == 0) {
+            lcd.setBrightnessTrace(&Serial);
+        } else if (positionalNum == 0) {
+            runSec = static_cast<uint32_t>(strtoul(argv[i], nullptr, 10));
+            positionalNum++;
+        } else {
+            SD.setRootPath(argv[i]);
+            positionalNum++;
+        }
+    }
+
+    // Taskを作成する前に切り替え、mainもTaskの1つとして扱う
+    if (isSimulation) {
+        vHostSimulationStart();
+    }
+
+    setup();
+    const uint32_t startMs = millis();
+    while ((runSec == 0) || ((millis() - startMs) < (runSec * 1000))) {
+        loop();
+        delay(FixedConfig::WaitForPorMs);
+    }
+
+    // Task ThreadはDetachされたまま動いているので、静的変数のDestructorを走らせずに終了する
+    printSummary();
+    fflush(stdout);
+    std::_Exit(EXIT_SUCCESS);
+}
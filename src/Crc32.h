@@ -0,0 +1,64 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief CRC-32(IEEE 802.3, 反転多項式0xEDB88320)を計算します
+ * @note Tableは4bit単位の16要素のみ持つので、Flash/RAMをほとんど消費しません
+ */
+class Crc32 {
+    public:
+        /**
+         * @brief Construct a new Crc32 object
+         */
+        Crc32(void): value(0xffffffff) {}
+
+        /**
+         * @brief データを追加します。分割して呼び出しても一括で計算した場合と同じ結果になります
+         *
+         * @param data 追加するデータ
+         * @param size データのbyte数
+         */
+        void update(const void* data, size_t size) {
+            static constexpr uint32_t table[16] = {
+                0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+                0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+                0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+                0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+            };
+            const uint8_t* src = static_cast<const uint8_t*>(data);
+            uint32_t crc = this->value;
+            for (size_t i = 0; i < size; i++) {
+                crc = table[(crc ^ src[i]) & 0xf] ^ (crc >> 4);
+                crc = table[(crc ^ (src[i] >> 4)) & 0xf] ^ (crc >> 4);
+            }
+            this->value = crc;
+        }
+
+        /**
+         * @brief ここまでに追加したデータのCRCを取得します
+         */
+        uint32_t get(void) const {
+            return ~this->value;
+        }
+
+        /**
+         * @brief 1回分のデータのCRCを計算します
+         *
+         * @param data 対象のデータ
+         * @param size データのbyte数
+         * @return uint32_t CRC
+         */
+        static uint32_t calc(const void* data, size_t size) {
+            Crc32 crc;
+            crc.update(data, size);
+            return crc.get();
+        }
+
+    protected:
+        uint32_t value; /**< 計算途中の値 */
+};
+
+#endif /* CRC32_H */
@@ -10,21 +10,45 @@ namespace FixedConfig {
     static constexpr uint32_t LcdWidth                 = 320;           /**< LCD横幅 */
     static constexpr uint32_t LcdHeight                = 240;           /**< LCD高さ */
     static constexpr uint8_t  Bme680SlaveAddr          = 0x76;          /**< BME680のSlave Addr */
+    static constexpr uint32_t GroveSampleGroupWindowMs = 20;            /**< GroveTaskで期限がこの時間以内に迫っているChannelは一緒に測定する */
     static constexpr uint32_t WaitForPorMs             = 1000;          /**< POR後の待機時間 */
     static constexpr uint32_t SerialBaudrate           = 115200;        /**< UART baudrate */
     static constexpr bool     WaitForInitSerial        = false;         /**< USB Serialが準備できるまでセットアップを継続しない */
     static constexpr char*    ConfigPath               = "wfhm.json";   /**< SD Cardのconfig保存先 */
+    static constexpr char*    ConfigTempPath           = "wfhm.tmp";    /**< config保存時の一時File, 書き込み完了後にConfigPathへrenameする */
+    static constexpr char*    ConfigSnapshotPath0      = "wfhm0.bin";   /**< SD Cardのconfigを解析したBinary Snapshotの保存先(1面目), 起動時はJsonが変わっていなければこちらを読む */
+    static constexpr char*    ConfigSnapshotPath1      = "wfhm1.bin";   /**< SD Cardのconfigを解析したBinary Snapshotの保存先(2面目), 世代番号の新しい方を使う */
     static constexpr size_t   ConfigAllocateSize       = 1024;          /**< config格納用に使用する領域サイズ(configの内容が大きい場合は要調整) */
     static constexpr uint32_t ErrorLedPinNum           = 13;            /**< RTOSでエラー発生時のLED Pin番号 */
     static constexpr uint32_t ErrorLedState            = 0;             /**< RTOSでエラー発生時のLEDの状態 */
-    static constexpr size_t   DefaultQueueSize         = 4;             /**< SensorData/ButtonStateのQueue Size */
+    static constexpr size_t   DefaultQueueSize         = 4;             /**< ButtonState/WifiTask要求応答のQueue Size */
+    static constexpr bool     UseLockFreeIpcQueue      = true;          /**< 1対1のTask間通信にFreeRTOS Queueではなく、Lock-freeなRing Bufferを使用する */
+    static constexpr size_t   MeasureDataTopicSubscriberMax = 4;        /**< 測定データを配信するTopicに登録できるSubscriber数 */
+    static constexpr size_t   MeasureDataTopicDepth    = 4;             /**< 測定データを配信するTopicでSubscriberごとに保持できる未受信データ数 */
     static constexpr size_t   GroveTaskStackSize       = 2048;          /**< GroveTaskのStackSize */
-    static constexpr size_t   ButtonTaskStackSize      = 256;           /**< ButtonTaskのStackSize */
     static constexpr size_t   UiTaskStackSize          = 2048;          /**< UiTaskのStackSize */
     static constexpr size_t   wifiTaskStackSize        = 2048;          /**< UiTaskのStackSize */
+    static constexpr size_t   CoopExecutorStackSize    = 1024;          /**< ButtonTask/LoggerTaskを相乗りさせるCoopExecutorのStackSize */
+    static constexpr size_t   CoopExecutorTaskMax      = 4;             /**< CoopExecutorに登録できるCoopTask数 */
+    static constexpr size_t   SdTaskStackSize          = 2048;          /**< SdTaskのStackSize */
+    static constexpr size_t   SdTaskQueueSize          = 4;             /**< SdTaskへの要求QueueのSize */
+    static constexpr size_t   SdTaskSectorSize         = 512;           /**< SdTaskでappend()を溜めるBufferのSize、SD Cardのsectorに合わせる */
+    static constexpr uint32_t SdTaskFlushIntervalMs    = 5000;          /**< SdTaskでappend()が溜まっていなくても書き出す周期 */
+    static constexpr uint32_t SdTaskConfigTimeoutMs    = 10000;         /**< 起動時にSdTaskへ要求したconfigの読み書きを待つ時間 */
+    static constexpr size_t   RtosStaticRamBudget      = 48 * 1024;     /**< 静的に確保するTask/Queueの領域の上限, RtosTopology.hで超過するとビルドエラーになる */
+    static constexpr size_t   WatchdogTaskStackSize    = 512;           /**< WatchdogTaskのStackSize */
+    static constexpr uint32_t WatchdogCheckIntervalMs  = 500;           /**< WatchdogTaskがHeartbeatを確認する周期, 停止の検出は最大で期限+この時間遅れる */
+    static constexpr uint32_t WatchdogDefaultTimeoutMs = 3000;          /**< loop()1回の処理に許容する時間の既定値 */
+    static constexpr uint32_t WifiTaskWatchdogTimeoutMs = 20000;        /**< WifiTaskのloop()1回の処理に許容する時間 */
+    static constexpr bool     UseHardwareWatchdog      = false;         /**< WatchdogTaskでHardware Watchdogを使用する */
+    static constexpr uint32_t HardwareWatchdogPeriodMs = 8000;          /**< Hardware Watchdogの期限, WatchdogCheckIntervalMsより十分長くする */
+    static constexpr size_t   TimerTaskStackSize       = 512;           /**< TimerTaskのStackSize */
+    static constexpr uint32_t TimerWheelResolutionMs   = 10;            /**< TimerWheelの1slotの幅, Timerの期限はこの単位に切り上げられる */
+    static constexpr uint32_t TaskProfileWindowMs      = 5000;          /**< TaskProfilerで統計を集計する期間 */
     static constexpr uint32_t WaitForDebugPrintMs      = 3000;          /**< Task開始直前の待機時間 */
-    static constexpr char*    GroveTaskPrintFilePath   = "sensor.csv";  /**< GroveTaskでファイル記録を有効化した場合の保存先 */
+    static constexpr char*    LoggerTaskPrintFilePath  = "sensor.csv";  /**< LoggerTaskでファイル記録を有効化した場合の保存先 */
     static constexpr size_t   ButtonTaskDebounceNum    = 2;             /**< ButtonTaskで保持する履歴数 */
+    static constexpr size_t   ButtonTaskPendingNum     = 8;             /**< ButtonTaskでQueue Full時に送信待ちとして保持できるサンプル数 */
     static constexpr size_t   UiTaskBrightnessKeyPoint = 4;             /**< 画面自動調光の設定KeyPoint数 */
 }
 
@@ -11,27 +11,101 @@ void FpsControlTask::setFps(uint32_t fps) {
     this->durationTick = SysTimer::msToTick(durationMs);
 }
 
+void FpsControlTask::waitForNextDeadline(uint32_t& deadlineTick) {
+    // fast
+    if (this->durationTick == 0) {
+        deadlineTick = SysTimer::getTickCount();
+        return;
+    }
+
+    const uint32_t nextDeadlineTick = deadlineTick + this->durationTick;
+    const uint32_t nowTick = SysTimer::getTickCount();
+    // 期限を過ぎていなければ、絶対時刻で待つ。vTaskDelayと違い現在時刻の取得から待機までにPreemptionされてもずれない
+    // 期限ちょうどに終わった場合はvTaskDelayUntilがすぐに戻るので、間に合ったものとして扱う
+    const int32_t lateTick = static_cast<int32_t>(nowTick - nextDeadlineTick);
+    if (lateTick <= 0) {
+        TickType_t previousWakeTick = deadlineTick;
+        vTaskDelayUntil(&previousWakeTick, this->durationTick);
+        deadlineTick = nextDeadlineTick;
+        this->burstNum = 0;
+        return;
+    }
+
+    // 間に合わなかった。現在時刻ちょうどの期限は間に合うので数えない
+    const uint32_t missedNum = static_cast<uint32_t>(lateTick - 1) / this->durationTick + 1;
+    FpsCatchUpPolicy policy = this->catchUpPolicy;
+    if ((policy == FpsCatchUpPolicy::Burst) && (this->burstNum >= BurstMaxNum)) {
+        policy = FpsCatchUpPolicy::Skip; // 取り戻せないほど遅れている
+    }
+    // Skipは飛ばした周期をすべて、それ以外は今回の1周期を記録する。getScheduleStats()と同じくCritical Section内で更新する
+    const uint32_t addedMissedNum = ((policy == FpsCatchUpPolicy::Burst) || (policy == FpsCatchUpPolicy::Stretch)) ? 1 : missedNum;
+    taskENTER_CRITICAL();
+    {
+        this->scheduleStats.missedNum += addedMissedNum;
+    }
+    taskEXIT_CRITICAL();
+    switch (policy) {
+        case FpsCatchUpPolicy::Burst:
+            // 期限はそのまま、待たずに次を呼ぶ
+            this->burstNum++;
+            deadlineTick = nextDeadlineTick;
+            break;
+        case FpsCatchUpPolicy::Stretch:
+            // 今を基準に周期をやり直す
+            this->burstNum = 0;
+            deadlineTick = nowTick;
+            break;
+        case FpsCatchUpPolicy::Skip:
+        default: {
+            // 過ぎた周期を飛ばして、次の期限まで待つ
+            this->burstNum = 0;
+            TickType_t previousWakeTick = nextDeadlineTick + (missedNum - 1) * this->durationTick;
+            deadlineTick = previousWakeTick + this->durationTick;
+            vTaskDelayUntil(&previousWakeTick, this->durationTick);
+            break;
+        }
+    }
+}
+
 void FpsControlTask::taskMain(void) {
     bool isAbort = false;
 
     setup();
+    uint32_t deadlineTick = SysTimer::getTickCount();
     do {
         // 時間計測付きでTaskを実行
         const uint32_t startTick = SysTimer::getTickCount();
+        this->profiler.beginLoop();
         isAbort = loop();
+        this->profiler.endLoop();
         const uint32_t endTick = SysTimer::getTickCount();
 
         // 差分を計算
         this->diffTick = SysTimer::diff(startTick, endTick);
-        // 時間に余りがあれば一定時間待つ
-        if (this->diffTick < this->durationTick) {
-            const uint32_t delayTick = this->durationTick - this->diffTick; // 事前に大小関係見てるのでUnderflowしない
-            vTaskDelay(delayTick);
+        // イベント駆動の場合は次の更新か期限まで待つ
+        if (this->waitSet != nullptr) {
+            const uint32_t idleTimeoutTick = this->getIdleTimeoutTick();
+            this->beat(idleTimeoutTick);
+            this->waitSet->wait(idleTimeoutTick);
+            deadlineTick = SysTimer::getTickCount(); // 固定FPSに戻った時のため
+            continue;
         }
-
+        // 次の期限まで待って、起床の遅れを記録
+        this->beat(this->durationTick);
+        this->waitForNextDeadline(deadlineTick);
+        const uint32_t jitterTick = SysTimer::diff(deadlineTick, SysTimer::getTickCount());
+        taskENTER_CRITICAL();
+        {
+            this->scheduleStats.loopNum++;
+            this->scheduleStats.sumJitterTick += jitterTick;
+            if (jitterTick > this->scheduleStats.maxJitterTick) {
+                this->scheduleStats.maxJitterTick = jitterTick;
+            }
+        }
+        taskEXIT_CRITICAL();
     } while(!isAbort);
 
     // delete itself
     vTaskDelete(NULL);
     this->isRunning = false;
-}
\ No newline at end of file
+}
@@ -3,9 +3,30 @@
 
 #include "SysTimer.h"
 #include "TaskBase.h"
+#include "IpcWaitSet.h"
+
+/**
+ * @brief loop()が周期に間に合わなかった場合の挙動です
+ */
+enum class FpsCatchUpPolicy : uint32_t {
+    Skip,    /**< 間に合わなかった周期は飛ばして、次の周期の期限まで待つ */
+    Burst,   /**< 遅れを取り戻すまで待たずに続けてloop()を呼び出す */
+    Stretch, /**< 遅れた時刻を新たな基準にして周期を引き伸ばす */
+};
+
+/**
+ * @brief FpsControlTaskの周期実行の統計です
+ */
+struct FpsControlStats {
+    uint32_t loopNum;        /**< loop()を呼び出した回数 */
+    uint32_t missedNum;      /**< 期限に間に合わなかった周期の数 */
+    uint32_t maxJitterTick;  /**< 期限から実際に起床するまでの最大遅れ */
+    uint32_t sumJitterTick;  /**< 期限から実際に起床するまでの遅れの合計, 平均はsumJitterTick / loopNum */
+};
 
 /**
  * @brief FPS設定可能なタスクの基底クラスです
+ * @note 固定FPSの場合は絶対時刻の期限で起床するので、loop()の処理時間やPreemptionで周期がずれることはありません
  */
 class FpsControlTask : public TaskBase {
     public:
@@ -13,7 +34,9 @@ class FpsControlTask : public TaskBase {
         /**
          * @brief Construct a new Fps Control Task object
          */
-        FpsControlTask(void): durationTick(SysTimer::secToTick(1)), diffTick(0) {}
+        FpsControlTask(void): durationTick(SysTimer::secToTick(1)), diffTick(0), waitSet(nullptr), catchUpPolicy(FpsCatchUpPolicy::Skip), burstNum(0) {
+            this->clearScheduleStats();
+        }
 
         /**
          * @brief Destroy the Fps Control Task object
@@ -32,11 +55,82 @@ class FpsControlTask : public TaskBase {
          */
         float getFpsWithoutDelay(void) { return 1.0f / SysTimer::tickToSec<float>(this->diffTick); }
 
+        /**
+         * @brief loop()が周期に間に合わなかった場合の挙動を設定します
+         * 
+         * @param policy 設定したい挙動
+         */
+        void setCatchUpPolicy(FpsCatchUpPolicy policy) { this->catchUpPolicy = policy; }
+
+        /**
+         * @brief 周期実行の統計を取得します
+         * 
+         * @param dst 統計の書き込み先
+         */
+        void getScheduleStats(FpsControlStats& dst) {
+            taskENTER_CRITICAL();
+            {
+                dst = this->scheduleStats;
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * @brief 周期実行の統計をクリアします
+         */
+        void clearScheduleStats(void) {
+            taskENTER_CRITICAL();
+            {
+                this->scheduleStats.loopNum = 0;
+                this->scheduleStats.missedNum = 0;
+                this->scheduleStats.maxJitterTick = 0;
+                this->scheduleStats.sumJitterTick = 0;
+            }
+            taskEXIT_CRITICAL();
+        }
+
     protected:
         uint32_t durationTick;
         uint32_t diffTick;
+        IpcWaitSet* waitSet; /**< イベント駆動時の待機先 */
+        FpsCatchUpPolicy catchUpPolicy; /**< 周期に間に合わなかった場合の挙動 */
+        FpsControlStats scheduleStats; /**< 周期実行の統計 */
+        uint32_t burstNum; /**< FpsCatchUpPolicy::Burstで連続して待たずに呼び出した回数 */
+
+        /**
+         * @brief FpsCatchUpPolicy::Burstで待たずに呼び出す最大回数、これ以上遅れた場合はSkipと同じ扱いにする
+         */
+        static constexpr uint32_t BurstMaxNum = 4;
+
+        /**
+         * @brief loop()をイベント駆動で呼び出すようにします。Task内(setup()など)から呼び出してください
+         * @note 以後は固定FPSで待機せず、setのメンバーが更新されるかgetIdleTimeoutTick()が経過するとloop()が呼び出されます
+         * 
+         * @param set 待機に使用するIpcWaitSet, nullptrを指定すると固定FPSに戻ります
+         */
+        void setWaitSet(IpcWaitSet* set) {
+            if (set != nullptr) {
+                set->bindCurrentTask();
+            }
+            this->waitSet = set;
+        }
+
+        /**
+         * @brief イベント駆動時、更新がなくてもloop()を呼び出すまでの最大時間を返します
+         * @note アニメーションなど時間経過で処理が必要な場合にoverrideします
+         * 
+         * @return uint32_t 最大待機tick, portMAX_DELAYならイベントがあるまで待機する
+         */
+        virtual uint32_t getIdleTimeoutTick(void) { return portMAX_DELAY; }
 
         void taskMain(void) override;
+
+        /**
+         * @brief 次の期限まで待機します
+         * 
+         * @param deadlineTick 直前のloop()の期限, 次の期限に更新されます
+         */
+        void waitForNextDeadline(uint32_t& deadlineTick);
 };
 
 #endif  /* FPSCONTROLTASK_H */
\ No newline at end of file
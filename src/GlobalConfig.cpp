@@ -1 +1,127 @@
 #include "GlobalConfig.h"
+
+const GlobalConfigFieldInfo GlobalConfigSchema::Fields[GlobalConfigSchema::FieldNum] = {
+#define WFH_GLOBAL_CONFIG_FIELD_INFO(id, key, type, defaultValue, minValue, maxValue) \
+    { key, GlobalConfigType::type, offsetof(GlobalConfigData, id), minValue, maxValue },
+    WFH_GLOBAL_CONFIG_SCHEMA(WFH_GLOBAL_CONFIG_FIELD_INFO)
+#undef WFH_GLOBAL_CONFIG_FIELD_INFO
+};
+
+const GlobalConfigData GlobalConfigSchema::DefaultData = {
+#define WFH_GLOBAL_CONFIG_DEFAULT(id, key, type, defaultValue, minValue, maxValue) defaultValue,
+    WFH_GLOBAL_CONFIG_SCHEMA(WFH_GLOBAL_CONFIG_DEFAULT)
+#undef WFH_GLOBAL_CONFIG_DEFAULT
+};
+
+bool GlobalConfigSchema::store(const GlobalConfigFieldInfo& field, GlobalConfigData& data, bool value) {
+    if (field.type != GlobalConfigType::Bool) return false;
+
+    *reinterpret_cast<bool*>(reinterpret_cast<uint8_t*>(&data) + field.offset) = value;
+    return true;
+}
+
+bool GlobalConfigSchema::store(const GlobalConfigFieldInfo& field, GlobalConfigData& data, uint32_t value) {
+    if (field.type != GlobalConfigType::U32) return false;
+    if ((value < field.minValue) || (field.maxValue < value)) return false;
+
+    *reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(&data) + field.offset) = value;
+    return true;
+}
+
+bool GlobalConfigSchema::store(const GlobalConfigFieldInfo& field, GlobalConfigData& data, const char* value) {
+    if (field.type != GlobalConfigType::String) return false;
+    if (value == nullptr) return false;
+    const size_t length = strlen(value);
+    if ((length < field.minValue) || (field.maxValue < length)) return false;
+
+    // 格納領域はmaxValue+1byte確保されているので終端まで収まる
+    memcpy(reinterpret_cast<uint8_t*>(&data) + field.offset, value, length + 1);
+    return true;
+}
+
+GlobalConfigChangeSet GlobalConfigSchema::diff(const GlobalConfigData& lhs, const GlobalConfigData& rhs) {
+    const uint8_t* lhsBase = reinterpret_cast<const uint8_t*>(&lhs);
+    const uint8_t* rhsBase = reinterpret_cast<const uint8_t*>(&rhs);
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FieldNum; i++) {
+        const GlobalConfigFieldInfo& field = Fields[i];
+        const uint8_t* l = lhsBase + field.offset;
+        const uint8_t* r = rhsBase + field.offset;
+        bool isChanged = false;
+        switch (field.type) {
+            case GlobalConfigType::Bool:
+                isChanged = (*reinterpret_cast<const bool*>(l) != *reinterpret_cast<const bool*>(r));
+                break;
+            case GlobalConfigType::U32:
+                isChanged = (*reinterpret_cast<const uint32_t*>(l) != *reinterpret_cast<const uint32_t*>(r));
+                break;
+            case GlobalConfigType::String:
+                // 終端以降は不定なので文字列として比較する
+                isChanged = (strcmp(reinterpret_cast<const char*>(l), reinterpret_cast<const char*>(r)) != 0);
+                break;
+            default:
+                break;
+        }
+        if (isChanged) {
+            mask |= GlobalConfigChangeSet::toBit(static_cast<GlobalConfigId>(i));
+        }
+    }
+    return GlobalConfigChangeSet(mask);
+}
+
+uint32_t GlobalConfigSchema::getLayoutHash(void) {
+    Crc32 crc;
+    const uint32_t header[] = { SnapshotVersion, static_cast<uint32_t>(sizeof(GlobalConfigData)), static_cast<uint32_t>(FieldNum) };
+    crc.update(header, sizeof(header));
+    for (size_t i = 0; i < FieldNum; i++) {
+        const GlobalConfigFieldInfo& field = Fields[i];
+        const uint32_t info[] = { static_cast<uint32_t>(field.type), static_cast<uint32_t>(field.offset), field.minValue, field.maxValue };
+        crc.update(field.key, strlen(field.key));
+        crc.update(info, sizeof(info));
+    }
+    return crc.get();
+}
+
+void GlobalConfigSchema::readFingerprint(File& f, uint32_t& size, uint32_t& crc) {
+    Crc32 fileCrc;
+    uint32_t fileSize = 0;
+    uint8_t buffer[64];
+    while (true) {
+        const size_t readSize = f.read(buffer, sizeof(buffer));
+        if (readSize == 0) break;
+        fileCrc.update(buffer, readSize);
+        fileSize += readSize;
+    }
+    size = fileSize;
+    crc = fileCrc.get();
+}
+
+bool GlobalConfigSchema::readSnapshot(File& f, GlobalConfigSnapshotHeader& header, GlobalConfigData& dst) {
+    if (f.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header)) return false;
+    if (header.magic != SnapshotMagic) return false;
+    if (header.layout != getLayoutHash()) return false;
+    if (f.read(reinterpret_cast<uint8_t*>(&dst), sizeof(dst)) != sizeof(dst)) return false;
+
+    Crc32 crc;
+    crc.update(&header, offsetof(GlobalConfigSnapshotHeader, crc));
+    crc.update(&dst, sizeof(dst));
+    return (crc.get() == header.crc);
+}
+
+bool GlobalConfigSchema::writeSnapshot(File& f, uint32_t generation, uint32_t jsonSize, uint32_t jsonCrc, const GlobalConfigData& src) {
+    GlobalConfigSnapshotHeader header;
+    header.magic = SnapshotMagic;
+    header.layout = getLayoutHash();
+    header.generation = generation;
+    header.jsonSize = jsonSize;
+    header.jsonCrc = jsonCrc;
+
+    Crc32 crc;
+    crc.update(&header, offsetof(GlobalConfigSnapshotHeader, crc));
+    crc.update(&src, sizeof(src));
+    header.crc = crc.get();
+
+    if (f.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) != sizeof(header)) return false;
+    if (f.write(reinterpret_cast<const uint8_t*>(&src), sizeof(src)) != sizeof(src)) return false;
+    return true;
+}
@@ -2,6 +2,7 @@
 #define GLOBAL_CONFIG_H
 
 #include <cstdint>
+#include <cstddef>
 #include <cstring>
 
 #include <ArduinoJson.h>
@@ -9,73 +10,478 @@
 #include "SD/Seeed_SD.h"
 
 #include "SharedResource.h"
+#include "SysTimer.h"
+#include "Crc32.h"
+#include "IpcWaitSet.h"
 
 /**
- * @brief GlobalConfigで使用するJson Key一覧です
+ * @brief GlobalConfigの項目定義です。Enum/格納用の構造体/Json Key/初期値/範囲はすべてここから生成されます
+ * @note 項目を追加する場合はこの表に1行追加してください。Json Keyの文字列比較はload/save時のみ行われます
+ * @note Stringの範囲は文字数で、格納領域は最大文字数+1byte確保されます
+ *
+ * X(Id, Json Key, Type, 初期値, 最小値, 最大値)
  */
-namespace GlobalConfigKeys {
-    static constexpr char* Identifier             = "identifier";
-    static constexpr char* Date                   = "date";
-    static constexpr char* Time                   = "time";
-    static constexpr char* UseWiFi                = "useWiFi";
-    static constexpr char* ApSsid                 = "apSsid";
-    static constexpr char* ApPassWord             = "apPassword";
-    static constexpr char* ApTimeoutMs            = "apTimeoutMs";
-    static constexpr char* UseAmbient             = "useAmbient";
-    static constexpr char* AmbientIntervalMs      = "AmbientIntervalMs";
-    static constexpr char* AmbientChannelId       = "ambientChanelId";
-    static constexpr char* AmbientWriteKey        = "ambientWriteKey";
-    static constexpr char* GroveTaskFps           = "groveTaskFps";
-    static constexpr char* ButtonTaskFps          = "buttonTaskFps";
-    static constexpr char* UiTaskFps              = "uiTaskFps";
-    static constexpr char* WifiTaskFps            = "wifiTaskFps";
-    static constexpr char* GroveTaskPrintSerial   = "groveTaskPrintSerial";
-    static constexpr char* GroveTaskPrintFile     = "groveTaskPrintFile";
-    static constexpr char* BrightnessHoldMs       = "brightnessHoldMs";
-    static constexpr char* BrightnessTransitionMs = "brightnessTransitionMs";
-}
+#define WFH_GLOBAL_CONFIG_SCHEMA(X) \
+    X(Identifier            , "identifier"            , String , "WFH Monitor"      , 0    , 31         ) \
+    X(Date                  , "date"                  , String , __DATE__           , 0    , 15         ) \
+    X(Time                  , "time"                  , String , __TIME__           , 0    , 15         ) \
+    X(UseWiFi               , "useWiFi"               , Bool   , false              , 0    , 1          ) \
+    X(ApSsid                , "apSsid"                , String , "your ap ssid"     , 0    , 32         ) \
+    X(ApPassWord            , "apPassword"            , String , "your ap password" , 0    , 63         ) \
+    X(ApTimeoutMs           , "apTimeoutMs"           , U32    , 30000              , 1000 , 600000     ) \
+    X(UseAmbient            , "useAmbient"            , Bool   , true               , 0    , 1          ) \
+    X(AmbientIntervalMs     , "AmbientIntervalMs"     , U32    , 60000              , 5000 , 86400000   ) \
+    X(AmbientChannelId      , "ambientChanelId"       , U32    , 0                  , 0    , UINT32_MAX ) \
+    X(AmbientWriteKey       , "ambientWriteKey"       , String , "your writekey"    , 0    , 31         ) \
+    X(GroveLuxPeriodMs      , "groveLuxPeriodMs"      , U32    , 100                , 10   , 3600000    ) \
+    X(GroveTphPeriodMs      , "groveTphPeriodMs"      , U32    , 1000               , 100  , 3600000    ) \
+    X(GroveGasPeriodMs      , "groveGasPeriodMs"      , U32    , 30000              , 1000 , 3600000    ) \
+    X(ButtonTaskFps         , "buttonTaskFps"         , U32    , 60                 , 1    , 1000       ) \
+    X(UiTaskFps             , "uiTaskFps"             , U32    , 30                 , 1    , 120        ) \
+    X(WifiTaskFps           , "wifiTaskFps"           , U32    , 1                  , 1    , 100        ) \
+    X(LoggerTaskFps         , "loggerTaskFps"         , U32    , 1                  , 1    , 100        ) \
+    X(GroveTaskPrintSerial  , "groveTaskPrintSerial"  , Bool   , false              , 0    , 1          ) \
+    X(GroveTaskPrintFile    , "groveTaskPrintFile"    , Bool   , false              , 0    , 1          ) \
+    X(BrightnessHoldMs      , "brightnessHoldMs"      , U32    , 4000               , 0    , 3600000    ) \
+    X(BrightnessTransitionMs, "brightnessTransitionMs", U32    , 2000               , 0    , 60000      )
 
 /**
- * @brief GlobalConfigで使用する初期値一覧です
+ * @brief GlobalConfigの項目を指定するEnumです
  */
-namespace GlobalConfigDefaultValues {
-    static constexpr char*    Identifier             = "WFH Monitor";
-    static constexpr char*    Date                   = __DATE__;
-    static constexpr char*    Time                   = __TIME__;
-    static constexpr bool     UseWiFi                = false;
-    static constexpr char*    ApSsid                 = "your ap ssid";
-    static constexpr char*    ApPassWord             = "your ap password";
-    static constexpr uint32_t ApTimeoutMs            = 30000;
-    static constexpr bool     UseAmbient             = true;
-    static constexpr uint32_t AmbientIntervalMs      = 60000;
-    static constexpr uint32_t AmbientChannelId       = 0;
-    static constexpr char*    AmbientWriteKey        = "your writekey";
-    static constexpr uint32_t GroveTaskFps           = 1;
-    static constexpr uint32_t ButtonTaskFps          = 60;
-    static constexpr uint32_t UiTaskFps              = 30;
-    static constexpr uint32_t WifiTaskFps            = 1;
-    static constexpr bool     GroveTaskPrintSerial   = false;
-    static constexpr bool     GroveTaskPrintFile     = false;
-    static constexpr uint32_t BrightnessHoldMs       = 4000;
-    static constexpr uint32_t BrightnessTransitionMs = 2000;
-}
+enum class GlobalConfigId : uint32_t {
+#define WFH_GLOBAL_CONFIG_ID(id, key, type, defaultValue, minValue, maxValue) id,
+    WFH_GLOBAL_CONFIG_SCHEMA(WFH_GLOBAL_CONFIG_ID)
+#undef WFH_GLOBAL_CONFIG_ID
+    Count, /**< 項目数 */
+};
+
+/**
+ * @brief GlobalConfigの項目の型です
+ */
+enum class GlobalConfigType : uint32_t {
+    Bool,   /**< bool */
+    U32,    /**< uint32_t, 範囲は値 */
+    String, /**< 終端付きのchar配列, 範囲は文字数 */
+};
+
+/**
+ * @brief GlobalConfigTypeから格納に使う型を求めます
+ *
+ * @tparam T 項目の型
+ * @tparam MaxValue 項目の最大値、Stringの場合は最大文字数
+ */
+template<GlobalConfigType T, uint32_t MaxValue> struct GlobalConfigStorage;
+template<uint32_t MaxValue> struct GlobalConfigStorage<GlobalConfigType::Bool, MaxValue> { typedef bool Type; };
+template<uint32_t MaxValue> struct GlobalConfigStorage<GlobalConfigType::U32, MaxValue> { typedef uint32_t Type; };
+template<uint32_t MaxValue> struct GlobalConfigStorage<GlobalConfigType::String, MaxValue> { typedef char Type[MaxValue + 1]; };
+
+/**
+ * @brief GlobalConfigの全項目を格納する構造体です。メンバ名はGlobalConfigIdと同じです
+ */
+struct GlobalConfigData {
+#define WFH_GLOBAL_CONFIG_MEMBER(id, key, type, defaultValue, minValue, maxValue) GlobalConfigStorage<GlobalConfigType::type, maxValue>::Type id;
+    WFH_GLOBAL_CONFIG_SCHEMA(WFH_GLOBAL_CONFIG_MEMBER)
+#undef WFH_GLOBAL_CONFIG_MEMBER
+};
+
+/**
+ * @brief load/save時にJsonとGlobalConfigDataを対応付けるための項目情報です
+ */
+struct GlobalConfigFieldInfo {
+    const char* key;       /**< Json Key */
+    GlobalConfigType type; /**< 型 */
+    size_t offset;         /**< GlobalConfigData上のoffset */
+    uint32_t minValue;     /**< 最小値、Stringの場合は最小文字数 */
+    uint32_t maxValue;     /**< 最大値、Stringの場合は最大文字数 */
+};
+
+/**
+ * @brief 再読み込みで値が変わった項目の集合です
+ */
+class GlobalConfigChangeSet {
+    public:
+        /**
+         * @brief 空の集合を作成します
+         */
+        GlobalConfigChangeSet(void): mask(0) {}
+
+        /**
+         * @brief GlobalConfigIdのbit集合から作成します
+         */
+        explicit GlobalConfigChangeSet(uint32_t mask): mask(mask) {}
+
+        /**
+         * @brief 全項目を含む集合を作成します。初回の設定反映に使います
+         */
+        static GlobalConfigChangeSet all(void) {
+            return GlobalConfigChangeSet(0xffffffffu >> (32 - static_cast<uint32_t>(GlobalConfigId::Count)));
+        }
+
+        /**
+         * @brief 変わった項目がなければtrue
+         */
+        bool isEmpty(void) const { return this->mask == 0; }
+
+        /**
+         * @brief 指定した項目が変わっていればtrue
+         */
+        bool contains(GlobalConfigId id) const { return (this->mask & toBit(id)) != 0; }
+
+        /**
+         * @brief GlobalConfigIdのbit集合を取得します
+         */
+        uint32_t getMask(void) const { return this->mask; }
+
+        /**
+         * @brief GlobalConfigIdに対応するbitを求めます
+         */
+        static uint32_t toBit(GlobalConfigId id) { return (0x1u << static_cast<uint32_t>(id)); }
+
+    protected:
+        uint32_t mask; /**< GlobalConfigIdのbit集合 */
+};
+static_assert(static_cast<uint32_t>(GlobalConfigId::Count) <= 32, "GlobalConfigChangeSet supports up to 32 items");
+
+/**
+ * @brief GlobalConfigの再読み込みで値が変わった項目を受け取るTask側の窓口です
+ * @note GlobalConfig::subscribe()で登録します。通知は次にtakeChanges()するまで蓄積されるので、複数回の再読み込みを取りこぼしません
+ */
+class GlobalConfigSubscriber {
+    public:
+        /**
+         * @brief Construct a new Global Config Subscriber object
+         */
+        GlobalConfigSubscriber(void): pendingMask(0), waitSet(nullptr), waitSetBit(0), isSubscribed(false), next(nullptr) {}
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        GlobalConfigSubscriber(const GlobalConfigSubscriber&) = delete;
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        GlobalConfigSubscriber& operator=(const GlobalConfigSubscriber&) = delete;
+
+        /**
+         * @brief 変更があった時に通知するIpcWaitSetを登録します。イベント駆動のTaskで使います
+         *
+         * @param set 通知先
+         * @return true 登録成功
+         * @return false すでに登録済、またはsetに空きがない
+         */
+        bool attachWaitSet(IpcWaitSet& set) {
+            if (this->waitSet != nullptr) return false;
+
+            const uint32_t bit = set.allocateBit();
+            if (bit == 0) return false;
+
+            this->waitSetBit = bit;
+            this->waitSet = &set;
+            return true;
+        }
+
+        /**
+         * @brief 前回呼び出してから値が変わった項目を取得します。登録したTaskからのみ呼び出せます
+         *
+         * @return GlobalConfigChangeSet 変わった項目, なければ空
+         */
+        GlobalConfigChangeSet takeChanges(void) {
+            // 大半は変更なしなのでCritical Sectionを取らずに確認する
+            if (this->pendingMask == 0) return GlobalConfigChangeSet();
+
+            uint32_t mask = 0;
+            taskENTER_CRITICAL();
+            {
+                mask = this->pendingMask;
+                this->pendingMask = 0;
+            }
+            taskEXIT_CRITICAL();
+            return GlobalConfigChangeSet(mask);
+        }
+
+    protected:
+        volatile uint32_t pendingMask; /**< 未取得の変更 */
+        IpcWaitSet* waitSet;           /**< 通知先 */
+        uint32_t waitSetBit;           /**< 通知に使うbit */
+        bool isSubscribed;             /**< GlobalConfigに登録済ならtrue */
+        GlobalConfigSubscriber* next;  /**< GlobalConfigの登録先listの次の要素 */
+
+        /**
+         * @brief 変更を蓄積して登録Taskに通知します。GlobalConfig::apply()から呼び出されます
+         */
+        void notify(const GlobalConfigChangeSet& changes) {
+            taskENTER_CRITICAL();
+            {
+                this->pendingMask |= changes.getMask();
+            }
+            taskEXIT_CRITICAL();
+            if (this->waitSet != nullptr) {
+                this->waitSet->signal(this->waitSetBit);
+            }
+        }
+
+        template<int N> friend class GlobalConfig;
+};
+
+/**
+ * @brief GlobalConfigをどこから読み出したかを示します
+ */
+enum class GlobalConfigSource : uint32_t {
+    Default,  /**< 読み出しておらず初期値 */
+    Snapshot, /**< Binary Snapshotから読み出した */
+    Json,     /**< Json Fileを解析した */
+};
+
+/**
+ * @brief Binary Snapshotの先頭に置くHeaderです。直後にGlobalConfigDataがそのまま続きます
+ */
+struct GlobalConfigSnapshotHeader {
+    uint32_t magic;      /**< GlobalConfigSchema::SnapshotMagic */
+    uint32_t layout;     /**< GlobalConfigSchema::getLayoutHash(), 項目定義が変わったSnapshotは使わない */
+    uint32_t generation; /**< 書き込むたびに増える世代番号, 2面のうち大きい方が新しい */
+    uint32_t jsonSize;   /**< 作成元のJson Fileのbyte数 */
+    uint32_t jsonCrc;    /**< 作成元のJson FileのCRC */
+    uint32_t crc;        /**< このメンバを除いたHeaderとGlobalConfigDataのCRC */
+};
+
+/**
+ * @brief GlobalConfigが使用するSD Card上のFileです
+ */
+struct GlobalConfigFiles {
+    const char* json;        /**< 設定File, 利用者が編集する */
+    const char* temp;        /**< 保存時にJsonを書き込む一時File, 書き込み完了後にjsonへrenameする */
+    const char* snapshot[2]; /**< Jsonを解析したBinary Snapshot, 世代番号を付けて2面に交互に書き込む */
+};
+
+/**
+ * @brief 書き込んだ内容のbyte数とCRCを数えながらFileに書き込みます。Jsonの保存時に使います
+ */
+class GlobalConfigFileWriter : public Print {
+    public:
+        GlobalConfigFileWriter(File& file): file(file), size(0) {}
+
+        size_t write(uint8_t c) override {
+            return this->write(&c, 1);
+        }
+
+        size_t write(const uint8_t* src, size_t n) override {
+            const size_t written = this->file.write(src, n);
+            this->crc.update(src, written);
+            this->size += written;
+            return written;
+        }
+
+        uint32_t getSize(void) const { return this->size; }
+        uint32_t getCrc(void) const { return this->crc.get(); }
+    protected:
+        File& file;    /**< 書き込み先 */
+        Crc32 crc;     /**< 書き込んだ内容のCRC */
+        uint32_t size; /**< 書き込んだbyte数 */
+};
+
+/**
+ * @brief GlobalConfigIdから項目の型と格納先を求めます。get/setはコンパイル時に項目が決まるのでメンバアクセスのみになります
+ *
+ * @tparam Id 項目
+ */
+template<GlobalConfigId Id> struct GlobalConfigField;
+#define WFH_GLOBAL_CONFIG_FIELD(id, key, type, defaultValue, minValue, maxValue) \
+    template<> struct GlobalConfigField<GlobalConfigId::id> { \
+        typedef GlobalConfigStorage<GlobalConfigType::type, maxValue>::Type ValueType; \
+        static const ValueType& get(const GlobalConfigData& data) { return data.id; } \
+        static ValueType& get(GlobalConfigData& data) { return data.id; } \
+    };
+WFH_GLOBAL_CONFIG_SCHEMA(WFH_GLOBAL_CONFIG_FIELD)
+#undef WFH_GLOBAL_CONFIG_FIELD
+
+/**
+ * @brief WFH_GLOBAL_CONFIG_SCHEMAから生成した初期値と項目情報、値の検証を提供します
+ */
+struct GlobalConfigSchema {
+    static constexpr size_t FieldNum = static_cast<size_t>(GlobalConfigId::Count); /**< 項目数 */
+    static const GlobalConfigFieldInfo Fields[FieldNum]; /**< GlobalConfigId順の項目情報 */
+    static const GlobalConfigData DefaultData; /**< 初期値 */
+    static constexpr uint32_t SnapshotMagic = 0x43484657; /**< Binary Snapshotの識別子, "WFHC" */
+    static constexpr uint32_t SnapshotVersion = 2; /**< Binary Snapshotの形式, 変更したら更新する */
+
+    /**
+     * @brief 項目情報を取得します
+     */
+    static const GlobalConfigFieldInfo& getField(GlobalConfigId id) {
+        return Fields[static_cast<size_t>(id)];
+    }
+
+    /**
+     * @brief 範囲を確認してbool値を書き込みます
+     *
+     * @param field 書き込み先の項目
+     * @param data 書き込み先
+     * @param value 書き込む値
+     * @return true 書き込み成功
+     * @return false 型が異なる
+     */
+    static bool store(const GlobalConfigFieldInfo& field, GlobalConfigData& data, bool value);
+
+    /**
+     * @brief 範囲を確認してuint32_t値を書き込みます
+     *
+     * @param field 書き込み先の項目
+     * @param data 書き込み先
+     * @param value 書き込む値
+     * @return true 書き込み成功
+     * @return false 型が異なる、もしくは範囲外
+     */
+    static bool store(const GlobalConfigFieldInfo& field, GlobalConfigData& data, uint32_t value);
+
+    /**
+     * @brief 文字数を確認して文字列を書き込みます
+     *
+     * @param field 書き込み先の項目
+     * @param data 書き込み先
+     * @param value 書き込む文字列
+     * @return true 書き込み成功
+     * @return false 型が異なる、nullptr、もしくは文字数が範囲外
+     */
+    static bool store(const GlobalConfigFieldInfo& field, GlobalConfigData& data, const char* value);
+
+    /**
+     * @brief 2つのGlobalConfigDataで値が異なる項目を求めます
+     *
+     * @return GlobalConfigChangeSet 値が異なる項目
+     */
+    static GlobalConfigChangeSet diff(const GlobalConfigData& lhs, const GlobalConfigData& rhs);
+
+    /**
+     * @brief 項目定義(Key/型/配置/範囲)とSnapshot形式から求めたHashを取得します
+     * @note 項目の追加/変更で値が変わるので、古いBinary Snapshotは自動的に使われなくなります
+     */
+    static uint32_t getLayoutHash(void);
+
+    /**
+     * @brief Fileの末尾までのbyte数とCRCを求めます。Json FileがSnapshot作成時から変わっていないかの確認に使います
+     *
+     * @param f 読み出し元、先頭から読み出します
+     * @param size byte数の書き込み先
+     * @param crc CRCの書き込み先
+     */
+    static void readFingerprint(File& f, uint32_t& size, uint32_t& crc);
+
+    /**
+     * @brief Binary Snapshotを読み出します
+     *
+     * @param f 読み出し元
+     * @param header Headerの書き込み先
+     * @param dst 書き込み先、失敗した場合は内容が不定になります
+     * @return true 読み出し成功
+     * @return false 書き込み途中で破損している、もしくは項目定義が異なる
+     */
+    static bool readSnapshot(File& f, GlobalConfigSnapshotHeader& header, GlobalConfigData& dst);
+
+    /**
+     * @brief Binary Snapshotを書き込みます
+     *
+     * @param f 書き込み先
+     * @param generation 世代番号
+     * @param jsonSize 作成元のJson Fileのbyte数
+     * @param jsonCrc 作成元のJson FileのCRC
+     * @param src 書き込む値
+     * @return true 書き込み成功
+     * @return false 書き込み失敗
+     */
+    static bool writeSnapshot(File& f, uint32_t generation, uint32_t jsonSize, uint32_t jsonCrc, const GlobalConfigData& src);
+
+    /**
+     * @brief Jsonから全項目を読み出します。存在しない項目/範囲外の項目は書き込みません
+     *
+     * @tparam D JsonDocument
+     * @param doc 読み出し元
+     * @param data 書き込み先、事前に初期値で埋めておいてください
+     * @return size_t 読み出せなかった項目数
+     */
+    template<typename D>
+    static size_t fromJson(const D& doc, GlobalConfigData& data) {
+        size_t skipCount = 0;
+        for (size_t i = 0; i < FieldNum; i++) {
+            const GlobalConfigFieldInfo& field = Fields[i];
+            if (!doc.containsKey(field.key)) {
+                skipCount++;
+                continue;
+            }
+            bool isStored = false;
+            switch (field.type) {
+                case GlobalConfigType::Bool: {
+                    const bool value = doc[field.key];
+                    isStored = store(field, data, value);
+                    break;
+                }
+                case GlobalConfigType::U32: {
+                    const uint32_t value = doc[field.key];
+                    isStored = store(field, data, value);
+                    break;
+                }
+                case GlobalConfigType::String: {
+                    const char* value = doc[field.key];
+                    isStored = store(field, data, value);
+                    break;
+                }
+                default:
+                    break;
+            }
+            if (!isStored) skipCount++;
+        }
+        return skipCount;
+    }
+
+    /**
+     * @brief 全項目をJsonに書き込みます
+     * @note Keyと文字列はコピーせずに参照するので、dataはserialize完了まで保持してください
+     *
+     * @tparam D JsonDocument
+     * @param data 読み出し元
+     * @param doc 書き込み先
+     */
+    template<typename D>
+    static void toJson(const GlobalConfigData& data, D& doc) {
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(&data);
+        for (size_t i = 0; i < FieldNum; i++) {
+            const GlobalConfigFieldInfo& field = Fields[i];
+            switch (field.type) {
+                case GlobalConfigType::Bool:
+                    doc[field.key] = *reinterpret_cast<const bool*>(base + field.offset);
+                    break;
+                case GlobalConfigType::U32:
+                    doc[field.key] = *reinterpret_cast<const uint32_t*>(base + field.offset);
+                    break;
+                case GlobalConfigType::String:
+                    doc[field.key] = reinterpret_cast<const char*>(base + field.offset);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+};
 
 /**
  * @brief WFH Terminalの設定データのInit/Read/Modify/Save/Loadを行うクラスです
- * @note TaskBaseを継承したクラスで操作する場合はSharedResouceクラスでラップして処理すること、また配置にはCPU DataCacheを考慮すること
- * 
- * @tparam N 管理ファイルに使用する領域、実際にはこの倍の領域が使用されます
+ * @note TaskBaseを継承したクラスで操作する場合はSharedRwResourceクラスでラップして処理すること、また配置にはCPU DataCacheを考慮すること
+ * @note 値はGlobalConfigDataに型付きで保持しているので、get()はメンバの読み出しのみです。Jsonはload/save中のみStackに確保します
+ * @note Binary Snapshotは世代番号付きで2面持ち、次回のloadではJson Fileが変わっていなければJsonを解析せずに新しい方のSnapshotから読み出します
+ * @note saveは一時Fileへの書き込み、古い面のSnapshot更新、Json Fileの置き換えの順に行うので、途中で電源が切れても次回のloadで直前か直後の内容に復旧できます
+ *
+ * @tparam N load/save時に使用するJsonDocumentの領域
  */
 template<int N>
 class GlobalConfig {
     public:
         /*
          * @brief Construct a new Global Config object
-         * 
+         *
          * @param sharedSd SDカードのペリフェラル
-         * @param configPath Globalな設定の保存先として使うFilePath
+         * @param files Globalな設定の保存先として使うFilePath
          */
-        GlobalConfig(SharedResource<SDFS>& sharedSd, const char* configPath): sharedSd(sharedSd), baseFilePath(configPath) {}
+        GlobalConfig(SharedResource<SDFS>& sharedSd, const GlobalConfigFiles& files): files(files), sharedSd(sharedSd), configVolatile(GlobalConfigSchema::DefaultData), configNonVolatile(GlobalConfigSchema::DefaultData), isStored(false), snapshotSlot(SnapshotSlotNum - 1), snapshotGeneration(0), loadSource(GlobalConfigSource::Default), loadUs(0), subscriberHead(nullptr) {}
 
         /**
          * @brief Destroy the Global Config object
@@ -83,91 +489,82 @@ class GlobalConfig {
         virtual ~GlobalConfig(void) {}
 
         /**
-         * @brief 指定された値をconfigVolatileに書き込みます
-         * 
-         * @tparam T 書き込むデータの型
-         * @param isOverwrite すでに値がセットされている場合でも上書きする場合はtrue
-         * @param key セット対象のKey
-         * @param value セットする値
+         * @brief 指定された項目の値を読み出します
+         *
+         * @tparam Id 読み出し対象の項目
+         * @return const GlobalConfigField<Id>::ValueType& 値、Stringの場合は終端付きのchar配列
          */
-        template<typename T>
-        void write(bool isOverwrite, const char* key, T& value) {
-            if (isOverwrite || !this->configVolatile.containsKey(key)) { 
-                this->configVolatile[key] = value;
-            }
+        template<GlobalConfigId Id>
+        const typename GlobalConfigField<Id>::ValueType& get(void) const {
+            return GlobalConfigField<Id>::get(this->configVolatile);
         }
 
         /**
-         * @brief 指定されたKeyの値を読み出します
-         * 
-         * @tparam T 読み出す型
-         * @param key 読み出し対象のKey
-         * @param value 読みだしたデータの書き込み先、Keyが存在しない場合は操作しません
-         * @return true 読み出し成功
-         * @return false 読み出し失敗
+         * @brief 指定された項目に値を書き込みます。範囲外の値は書き込みません
+         *
+         * @tparam Id 書き込み対象の項目
+         * @tparam T 書き込む値の型、bool/uint32_t/const char*
+         * @param value 書き込む値
+         * @return true 書き込み成功
+         * @return false 型が異なる、もしくは範囲外
          */
-        template<typename T>
-        bool read(const char* key, T& value) {
-            // Keyが存在しない
-            if (!this->configVolatile.containsKey(key)) {
-                return false;
-            }
-            // 値を読み出す
-            value = this->configVolatile[key];
-            return true;
+        template<GlobalConfigId Id, typename T>
+        bool set(T value) {
+            return GlobalConfigSchema::store(GlobalConfigSchema::getField(Id), this->configVolatile, value);
         }
 
         /**
-         * @brief 指定されたKeyのポインタを取得します。文字列を読み出す場合などに利用してください
-         * @note 読みだしたPointerのLifetimeは必要最低限にとどめてください。読みだした時点のスコープ以上に広げないことを推奨します
-         * 
-         * @tparam T 読み出す型
-         * @param key 読み出し対象のKey
-         * @return const T* 読み出し失敗
+         * @brief 全項目を参照します
          */
-        template<typename T>
-        const T* getReadPtr(const char* key) {
-            // Keyが存在しない
-            if (!this->configVolatile.containsKey(key)) {
-                return nullptr;
-            }
-            
-            return this->configVolatile[key];
+        const GlobalConfigData& getData(void) const {
+            return this->configVolatile;
+        }
+
+        /**
+         * @brief 直近のload()でどこから読み出したかを取得します
+         */
+        GlobalConfigSource getLoadSource(void) const {
+            return this->loadSource;
+        }
+
+        /**
+         * @brief 設定の保存先を取得します
+         * @note constructor以降は変更されません
+         */
+        const GlobalConfigFiles& getFiles(void) const {
+            return this->files;
+        }
+
+        /**
+         * @brief 直近のload()にかかった時間を取得します
+         *
+         * @return uint32_t 処理時間[us]
+         */
+        uint32_t getLoadUs(void) const {
+            return this->loadUs;
+        }
+
+        /**
+         * @brief SD Cardの内容と異なる値を保持しているかを取得します
+         * @note init()した場合と、Json Fileが壊れていてSnapshotから復旧した場合は、値が同じでもSD Cardへの書き込みが必要です
+         *
+         * @return true save(nullptr)で書き込みが必要
+         * @return false SD Cardと同じ内容
+         */
+        bool isDirty(void) const {
+            if (!this->isStored) return true;
+            return !GlobalConfigSchema::diff(this->configVolatile, this->configNonVolatile).isEmpty();
         }
 
         /**
          * @brief すべての値を初期値で上書きします
-         * @param isMigrate 存在しない値のみを上書きする場合はtrue
-         * 
-         * @note 完全新規のconfigを生成する場合はisMigrate=falseで実行する
-         */
-        void init(bool isMigrate) {
-            // 一通り必要な初期値をセット
-            // TODO: もう少しいい感じに書けるかも。Keys/DefaultValuesを内包する型パラメータの指定は考察が必要
-            this->write(!isMigrate, GlobalConfigKeys::Identifier              , GlobalConfigDefaultValues::Identifier);
-            this->write(!isMigrate, GlobalConfigKeys::Date                    , GlobalConfigDefaultValues::Date);
-            this->write(!isMigrate, GlobalConfigKeys::Time                    , GlobalConfigDefaultValues::Time);
-            this->write(!isMigrate, GlobalConfigKeys::UseWiFi                 , GlobalConfigDefaultValues::UseWiFi);
-            this->write(!isMigrate, GlobalConfigKeys::ApSsid                  , GlobalConfigDefaultValues::ApSsid);
-            this->write(!isMigrate, GlobalConfigKeys::ApPassWord              , GlobalConfigDefaultValues::ApPassWord);
-            this->write(!isMigrate, GlobalConfigKeys::ApTimeoutMs             , GlobalConfigDefaultValues::ApTimeoutMs);
-            this->write(!isMigrate, GlobalConfigKeys::UseAmbient              , GlobalConfigDefaultValues::UseAmbient);
-            this->write(!isMigrate, GlobalConfigKeys::AmbientIntervalMs       , GlobalConfigDefaultValues::AmbientIntervalMs);
-            this->write(!isMigrate, GlobalConfigKeys::AmbientChannelId        , GlobalConfigDefaultValues::AmbientChannelId);
-            this->write(!isMigrate, GlobalConfigKeys::AmbientWriteKey         , GlobalConfigDefaultValues::AmbientWriteKey);
-            this->write(!isMigrate, GlobalConfigKeys::GroveTaskFps            , GlobalConfigDefaultValues::GroveTaskFps);
-            this->write(!isMigrate, GlobalConfigKeys::ButtonTaskFps           , GlobalConfigDefaultValues::ButtonTaskFps);
-            this->write(!isMigrate, GlobalConfigKeys::UiTaskFps               , GlobalConfigDefaultValues::UiTaskFps);
-            this->write(!isMigrate, GlobalConfigKeys::WifiTaskFps             , GlobalConfigDefaultValues::WifiTaskFps);
-            this->write(!isMigrate, GlobalConfigKeys::GroveTaskPrintSerial    , GlobalConfigDefaultValues::GroveTaskPrintSerial);
-            this->write(!isMigrate, GlobalConfigKeys::GroveTaskPrintFile      , GlobalConfigDefaultValues::GroveTaskPrintFile);
-            this->write(!isMigrate, GlobalConfigKeys::BrightnessHoldMs        , GlobalConfigDefaultValues::BrightnessHoldMs);
-            this->write(!isMigrate, GlobalConfigKeys::BrightnessTransitionMs  , GlobalConfigDefaultValues::BrightnessTransitionMs);
-
-            // migrationでなければNonVolatile側にも反映(this->clear()対策)
-            if (!isMigrate) {
-                this->configNonVolatile = this->configVolatile;
-            }
+         */
+        void init(void) {
+            this->configVolatile = GlobalConfigSchema::DefaultData;
+            // NonVolatile側にも反映(this->clear()対策)
+            this->configNonVolatile = this->configVolatile;
+            // SD Cardの内容とは一致していない
+            this->isStored = false;
         }
 
         /**
@@ -179,77 +576,190 @@ class GlobalConfig {
 
         /**
          * @brief configの内容をSD Cardから読み出します
-         * 
-         * @param filePath 読み込み先、省略した場合はconstructorで指定したパスに書き込みます
+         * @note SD Cardを読み書きするので、SdTask以外からは直接呼び出さずSdTaskに要求してください
+         * @note 存在しない項目、範囲外の項目は初期値になります(versionが異なる場合のMigration)
+         * @note filePathを省略した場合、中断されたsaveの復旧、Snapshotの利用、Json Fileが壊れている場合のSnapshotからの復旧を行います
+         *
+         * @param filePath 読み込み先、省略した場合はconstructorで指定したパスから読み込みます
          * @return true 読み出し成功
          * @return false 読み出し失敗
          */
         bool load(const char* filePath, DeserializationError& deserializeError) {
-            const char* path = (filePath == nullptr) ? this->baseFilePath : filePath;
-            // baseFilePath == nullptrの対策
-            if (path == nullptr) {
-                deserializeError = DeserializationError::InvalidInput;
-                return false;
-            }
+            const uint64_t startUs = SysTimer::getMicroCount64();
 
-            // take mutex & crititcal sectionで読み込みは行う
+            // File操作中にCritical Sectionは取らない。mutexのみで他のSD Card操作と排他する
             bool result = false;
-            this->sharedSd.operateCritial([&](SDFS& sd) {
-                File f = sd.open(path, FILE_READ);
-                // Fileが開けなければ失敗
-                if (!f) {
-                    deserializeError = DeserializationError::InvalidInput;
+            this->sharedSd.operate([&](SDFS& sd) {
+                // 指定されたFileはJsonとして読むだけで、Snapshotは使わない
+                if (filePath != nullptr) {
+                    File f = sd.open(filePath, FILE_READ);
+                    result = this->loadJson(f, deserializeError);
+                    f.close();
+                    // constructorで指定したFileとは一致していない
+                    if (result) this->isStored = false;
                     return;
                 }
-                // configNonVolatileに読み出す
-                deserializeError = deserializeJson(this->configNonVolatile, f);
-                // file Handleはもう不要
-                f.close();
-                // DeserializeErrorが発生していれば終了
-                if (deserializeError != DeserializationError::Ok) return;
 
-                // 成功していればconfigVolatileの内容を上書き
-                this->configVolatile = this->configNonVolatile;
-                // versionが異なる場合のMigrationも実施しておく
-                this->init(true);
-                // 成功
-                result = true;
+                GlobalConfigSnapshotHeader header;
+                GlobalConfigData snapshot;
+                const bool hasSnapshot = this->readLatestSnapshot(sd, header, snapshot);
+                // 前回のsaveが中断されていれば、置き換えを完了するか書きかけの一時Fileを捨てる
+                this->recoverSave(sd, hasSnapshot ? &header : nullptr);
+
+                // Json Fileの内容がSnapshot作成時と同じなら解析せずにSnapshotを使う
+                uint32_t jsonSize = 0;
+                uint32_t jsonCrc = 0;
+                const bool hasJson = this->readFingerprint(sd, this->files.json, jsonSize, jsonCrc);
+                if (hasJson && hasSnapshot && (header.jsonSize == jsonSize) && (header.jsonCrc == jsonCrc)) {
+                    this->configNonVolatile = snapshot;
+                    this->configVolatile = this->configNonVolatile;
+                    this->loadSource = GlobalConfigSource::Snapshot;
+                    this->isStored = true;
+                    deserializeError = DeserializationError::Ok;
+                    result = true;
+                    return;
+                }
+
+                // Json Fileが編集されていればJsonを解析してSnapshotを作り直す
+                if (hasJson) {
+                    File f = sd.open(this->files.json, FILE_READ);
+                    result = this->loadJson(f, deserializeError);
+                    f.close();
+                    if (result) {
+                        this->isStored = this->writeNextSnapshot(sd, jsonSize, jsonCrc, this->configNonVolatile);
+                        return;
+                    }
+                } else {
+                    deserializeError = DeserializationError::InvalidInput;
+                }
+
+                // Json Fileが無い、もしくは壊れていれば直近のSnapshotから復旧する。Json Fileは次のsaveで書き直す
+                if (hasSnapshot) {
+                    this->configNonVolatile = snapshot;
+                    this->configVolatile = this->configNonVolatile;
+                    this->loadSource = GlobalConfigSource::Snapshot;
+                    this->isStored = false;
+                    result = true;
+                }
             });
+            this->loadUs = static_cast<uint32_t>(SysTimer::getMicroCount64() - startUs);
             return result;
         }
 
+        /**
+         * @brief 再読み込みで値が変わった時に通知を受けるSubscriberを登録します
+         *
+         * @param subscriber 登録するSubscriber, 破棄しないでください
+         * @return true 登録成功
+         * @return false 登録済
+         */
+        bool subscribe(GlobalConfigSubscriber& subscriber) {
+            if (subscriber.isSubscribed) return false;
+
+            subscriber.next = this->subscriberHead;
+            this->subscriberHead = &subscriber;
+            subscriber.isSubscribed = true;
+            return true;
+        }
+
+        /**
+         * @brief 動作中の再読み込み用にJson Fileを解析します。GlobalConfigの値は操作しません
+         * @note SD Cardを読み書きするので、SdTask以外からは直接呼び出さずSdTaskに要求してください
+         * @note SD CardのLockのみ取るので、configのLockを取らずに呼び出してください。結果はapply()で反映します
+         * @note load()と異なりSnapshotは使わないので、Json Fileが無い/壊れている場合は失敗します
+         *
+         * @param sharedSd SDカードのペリフェラル
+         * @param filePath 読み込み先, getFiles()で取得したJson File
+         * @param dst 解析した値の書き込み先、失敗した場合は内容が不定になります
+         * @param deserializeError 解析結果
+         * @return true 解析成功
+         * @return false Fileが無い、もしくはJsonとして解析できない
+         */
+        static bool parse(SharedResource<SDFS>& sharedSd, const char* filePath, GlobalConfigData& dst, DeserializationError& deserializeError) {
+            bool result = false;
+            sharedSd.operate([&](SDFS& sd) {
+                File f = sd.open(filePath, FILE_READ);
+                result = parseJson(f, dst, deserializeError);
+                f.close();
+            });
+            return result;
+        }
+
+        /**
+         * @brief parse()した値で置き換え、値が変わった項目を各Subscriberに通知します
+         * @note 動作中に変更したset()の値は上書きされます。Snapshotは次回のload()で作り直されます
+         *
+         * @param loaded parse()で解析した値
+         * @return GlobalConfigChangeSet 値が変わった項目
+         */
+        GlobalConfigChangeSet apply(const GlobalConfigData& loaded) {
+            const GlobalConfigChangeSet changes = GlobalConfigSchema::diff(this->configVolatile, loaded);
+            this->configNonVolatile = loaded;
+            this->configVolatile = this->configNonVolatile;
+            this->loadSource = GlobalConfigSource::Json;
+            // Json Fileとは一致しているが、Snapshotは古いまま
+            this->isStored = false;
+
+            if (!changes.isEmpty()) {
+                for (GlobalConfigSubscriber* s = this->subscriberHead; s != nullptr; s = s->next) {
+                    s->notify(changes);
+                }
+            }
+            return changes;
+        }
+
         /**
          * @brief 現在のconfigの内容をSD Cardに不揮発化します
-         * 
+         * @note SD Cardを読み書きするので、SdTask以外からは直接呼び出さずSdTaskに要求してください
+         * @note filePathを省略した場合、isDirty()でなければ何も書き込みません
+         *
          * @param filePath 書き込み先、省略した場合はconstructorで指定したパスに書き込みます
          * @return true 保存成功
          * @return false 保存失敗
          */
         bool save(const char* filePath) {
-            const char* path = (filePath == nullptr) ? this->baseFilePath : filePath;
-            // baseFilePath == nullptrの対策
-            if (path == nullptr) {
-                return false;
+            // 指定されたFileにはJsonを書き出すだけで、不揮発化した内容としては扱わない
+            if (filePath != nullptr) {
+                bool result = false;
+                this->sharedSd.operate([&](SDFS& sd) {
+                    File f = sd.open(filePath, FILE_WRITE);
+                    if (!f) return;
+                    GlobalConfigFileWriter writer(f);
+                    result = this->writeJson(writer);
+                    f.close();
+                });
+                return result;
             }
+            // SD Cardと同じ内容なら書き込まない
+            if (!this->isDirty()) return true;
 
-            // take mutex & crititcal sectionで書き込みは行う
+            // File操作中にCritical Sectionは取らない。mutexのみで他のSD Card操作と排他する
             bool result = false;
-            this->sharedSd.operateCritial([&](SDFS& sd) {
-                File f = sd.open(path, FILE_WRITE);
-                // Fileが開けなければ失敗
-                if (!f) return;
+            this->sharedSd.operate([&](SDFS& sd) {
                 // Date/Timeを最新ビルドのものに更新する
-                this->write(true, GlobalConfigKeys::Date , GlobalConfigDefaultValues::Date);
-                this->write(true, GlobalConfigKeys::Time , GlobalConfigDefaultValues::Time);
-                // configVolatileの内容を不揮発化する
-                const size_t byteWritten = serializeJson(this->configVolatile, f);
-                // File Handleはもう不要
+                this->set<GlobalConfigId::Date>(GlobalConfigSchema::DefaultData.Date);
+                this->set<GlobalConfigId::Time>(GlobalConfigSchema::DefaultData.Time);
+
+                // 1. 現在のJson Fileは残したまま一時Fileに書き込む。Snapshotとの対応付けのため書いた内容のCRCも求める
+                File f = sd.open(this->files.temp, FILE_WRITE);
+                if (!f) return;
+                GlobalConfigFileWriter writer(f);
+                const bool isWritten = this->writeJson(writer);
                 f.close();
-                // 1byteも書けていなければ失敗
-                if (byteWritten == 0) return;
+                if (!isWritten) return;
+
+                // 2. 古い方の面にSnapshotを書き込む。ここで中断しても新しい方の面とJson Fileは元のまま
+                if (!this->writeNextSnapshot(sd, writer.getSize(), writer.getCrc(), this->configVolatile)) return;
+
+                // 3. Json Fileを置き換える。ここで中断した場合は次回のloadでrenameを完了させる
+                if (sd.exists(this->files.json)) {
+                    sd.remove(this->files.json);
+                }
+                if (!sd.rename(this->files.temp, this->files.json)) return;
 
                 // 成功していればconfigNonVolatileの内容を上書き
                 this->configNonVolatile = this->configVolatile;
+                this->isStored = true;
                 // 成功
                 result = true;
             });
@@ -258,9 +768,171 @@ class GlobalConfig {
         }
 
     protected:
-        const char* baseFilePath;
+        static constexpr size_t SnapshotSlotNum = 2; /**< Binary Snapshotの面数 */
+
+        const GlobalConfigFiles files; /**< 設定の保存先 */
         SharedResource<SDFS>& sharedSd; /**< Semaphore, CriticalSectionの制定可能なSD Peripheral */
-        StaticJsonDocument<N> configVolatile; /**< 動作中に書き換わる領域 */
-        StaticJsonDocument<N> configNonVolatile; /**< Load時、またSave後に不揮発化されているオリジナルデータを格納する */
+        GlobalConfigData configVolatile; /**< 動作中に書き換わる領域 */
+        GlobalConfigData configNonVolatile; /**< Load時、またSave後に不揮発化されているオリジナルデータを格納する */
+        bool isStored; /**< configNonVolatileがSD Card上のJson File, Snapshotと一致しているか */
+        size_t snapshotSlot; /**< 最も新しいSnapshotの面, 次の書き込みはもう一方の面に行う */
+        uint32_t snapshotGeneration; /**< 最も新しいSnapshotの世代番号 */
+        GlobalConfigSource loadSource; /**< 直近のload()の読み出し元 */
+        uint32_t loadUs; /**< 直近のload()の処理時間 */
+        GlobalConfigSubscriber* subscriberHead; /**< apply()で通知するSubscriberの先頭 */
+
+        /**
+         * @brief Json Fileを解析します
+         * @note 存在しない項目、範囲外の項目は初期値になります
+         *
+         * @param f 読み出し元
+         * @param dst 解析した値の書き込み先
+         * @param deserializeError 解析結果
+         * @return true 読み出し成功
+         * @return false 読み出し失敗
+         */
+        static bool parseJson(File& f, GlobalConfigData& dst, DeserializationError& deserializeError) {
+            if (!f) {
+                deserializeError = DeserializationError::InvalidInput;
+                return false;
+            }
+            // Jsonは解析中のみ使う
+            StaticJsonDocument<N> doc;
+            deserializeError = deserializeJson(doc, f);
+            // DeserializeErrorが発生していれば終了
+            if (deserializeError != DeserializationError::Ok) return false;
+
+            // 初期値に読み出せた項目を上書きする
+            dst = GlobalConfigSchema::DefaultData;
+            GlobalConfigSchema::fromJson(doc, dst);
+            return true;
+        }
+
+        /**
+         * @brief Json Fileを解析してconfigNonVolatile/configVolatileに読み出します
+         * @note 存在しない項目、範囲外の項目は初期値になります
+         *
+         * @param f 読み出し元
+         * @param deserializeError 解析結果
+         * @return true 読み出し成功
+         * @return false 読み出し失敗
+         */
+        bool loadJson(File& f, DeserializationError& deserializeError) {
+            if (!parseJson(f, this->configNonVolatile, deserializeError)) return false;
+
+            this->configVolatile = this->configNonVolatile;
+            this->loadSource = GlobalConfigSource::Json;
+            return true;
+        }
+
+        /**
+         * @brief configVolatileの内容をJsonで書き出します
+         *
+         * @param writer 書き込み先
+         * @return true 書き込み成功
+         * @return false 1byteも書けなかった
+         */
+        bool writeJson(GlobalConfigFileWriter& writer) {
+            // Jsonはsave中のみ使う
+            StaticJsonDocument<N> doc;
+            GlobalConfigSchema::toJson(this->configVolatile, doc);
+            return (serializeJson(doc, writer) > 0);
+        }
+
+        /**
+         * @brief Fileのbyte数とCRCを求めます
+         *
+         * @param sd 対象のSD Card
+         * @param path 対象のFile
+         * @param size byte数の書き込み先
+         * @param crc CRCの書き込み先
+         * @return true 成功
+         * @return false Fileが存在しない
+         */
+        bool readFingerprint(SDFS& sd, const char* path, uint32_t& size, uint32_t& crc) {
+            File f = sd.open(path, FILE_READ);
+            if (!f) return false;
+            GlobalConfigSchema::readFingerprint(f, size, crc);
+            f.close();
+            return true;
+        }
+
+        /**
+         * @brief 2面のSnapshotのうち、壊れていない新しい方を読み出します
+         * @note 次に書き込む面を決めるため、snapshotSlot/snapshotGenerationも更新します
+         *
+         * @param sd 対象のSD Card
+         * @param header Headerの書き込み先
+         * @param dst 値の書き込み先
+         * @return true 読み出し成功
+         * @return false 有効なSnapshotが無い
+         */
+        bool readLatestSnapshot(SDFS& sd, GlobalConfigSnapshotHeader& header, GlobalConfigData& dst) {
+            bool hasSnapshot = false;
+            for (size_t i = 0; i < SnapshotSlotNum; i++) {
+                GlobalConfigSnapshotHeader candidateHeader;
+                GlobalConfigData candidate;
+                File f = sd.open(this->files.snapshot[i], FILE_READ);
+                const bool isValid = f && GlobalConfigSchema::readSnapshot(f, candidateHeader, candidate);
+                f.close();
+                if (!isValid) continue;
+                // 世代番号の一周を考慮して差分で比較する
+                if (hasSnapshot && (static_cast<int32_t>(candidateHeader.generation - header.generation) <= 0)) continue;
+
+                header = candidateHeader;
+                dst = candidate;
+                hasSnapshot = true;
+                this->snapshotSlot = i;
+                this->snapshotGeneration = candidateHeader.generation;
+            }
+            return hasSnapshot;
+        }
+
+        /**
+         * @brief 古い方の面にSnapshotを書き込みます
+         *
+         * @param sd 対象のSD Card
+         * @param jsonSize 作成元のJson Fileのbyte数
+         * @param jsonCrc 作成元のJson FileのCRC
+         * @param src 書き込む値
+         * @return true 書き込み成功
+         * @return false 書き込み失敗
+         */
+        bool writeNextSnapshot(SDFS& sd, uint32_t jsonSize, uint32_t jsonCrc, const GlobalConfigData& src) {
+            const size_t slot = (this->snapshotSlot + 1) % SnapshotSlotNum;
+            const uint32_t generation = this->snapshotGeneration + 1;
+            File f = sd.open(this->files.snapshot[slot], FILE_WRITE);
+            if (!f) return false;
+            const bool isWritten = GlobalConfigSchema::writeSnapshot(f, generation, jsonSize, jsonCrc, src);
+            f.close();
+            if (!isWritten) return false;
+
+            this->snapshotSlot = slot;
+            this->snapshotGeneration = generation;
+            return true;
+        }
+
+        /**
+         * @brief 中断されたsaveの一時Fileを処理します
+         * @note 一時Fileが最新のSnapshotと一致していればJson Fileの置き換えを完了し、一致しなければ書きかけとして削除します
+         *
+         * @param sd 対象のSD Card
+         * @param latest 最新のSnapshotのHeader, 無ければnullptr
+         */
+        void recoverSave(SDFS& sd, const GlobalConfigSnapshotHeader* latest) {
+            uint32_t tempSize = 0;
+            uint32_t tempCrc = 0;
+            if (!this->readFingerprint(sd, this->files.temp, tempSize, tempCrc)) return;
+
+            const bool isCompleted = (latest != nullptr) && (latest->jsonSize == tempSize) && (latest->jsonCrc == tempCrc);
+            if (!isCompleted) {
+                sd.remove(this->files.temp);
+                return;
+            }
+            if (sd.exists(this->files.json)) {
+                sd.remove(this->files.json);
+            }
+            sd.rename(this->files.temp, this->files.json);
+        }
 };
-#endif /* GLOBAL_CONFIG_H */
\ No newline at end of file
+#endif /* GLOBAL_CONFIG_H */
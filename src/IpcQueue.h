@@ -5,19 +5,30 @@
 
 #include <Seeed_Arduino_FreeRTOS.h>
 
+#include "IpcQueueBackend.h"
+#include "IpcQueueStats.h"
+#include "IpcWaitSet.h"
+#include "SysTimer.h"
+
 /**
  * @brief Task間通信を行うQueueを提供します
  * @note 一部関数はQueue class内部変数が変更されるため、割り込み/中断が発生しない状況で使用する必要があります
  * 
  * @tparam T 送受信するデータ型
+ * @tparam Backend Queueの実装。Producer/Consumerが1Taskずつの場合はSpscRingBackendを指定できます
  */
-template<typename T>
+template<typename T, typename Backend = RtosQueueBackend<T>>
 class IpcQueue {
     public:
+        /**
+         * @brief 送受信するデータ型です
+         */
+        typedef T ValueType;
+
         /**
          * @brief Construct a new Ipc Queue object
          */
-        IpcQueue(void): isInitialized(false), entrySize(sizeof(T)), depth(0) {}
+        IpcQueue(void): isInitialized(false), isLoaned(false), isPeeked(false), entrySize(sizeof(T)), depth(0), waitSet(nullptr), waitSetBit(0) {}
         /**
          * @brief Destroy the Ipc Queue object
          */
@@ -26,12 +37,12 @@ class IpcQueue {
         /**
          * @brief Copy Constructorは禁止
          */
-        IpcQueue(const IpcQueue<T>&) = delete;
+        IpcQueue(const IpcQueue&) = delete;
 
         /**
          * @brief Copy Constructorは禁止
          */
-        IpcQueue<T>& operator=(const IpcQueue<T>&) = delete;
+        IpcQueue& operator=(const IpcQueue&) = delete;
 
         /**
          * @brief Create a RTOS Queue
@@ -47,15 +58,57 @@ class IpcQueue {
             // already created
             if (this->isInitialized) return false;
 
-            // create from rtos api
-            this->queueHandle = xQueueCreate(queueDepth, this->entrySize);
-            if (this->queueHandle == nullptr) return false;
+            // create from backend
+            if (!this->backend.create(queueDepth)) return false;
+            if (!this->stats.allocate(queueDepth)) {
+                this->backend.destroy();
+                return false;
+            }
 
             this->depth = queueDepth;
             this->isInitialized = true;
             return true;
         }
 
+        /**
+         * @brief 静的に確保するQueueの領域です
+         * @note RtosTopology.hでRAM使用量の集計に使用します
+         * 
+         * @tparam Depth Queueの要素数
+         */
+        template<size_t Depth>
+        struct StaticStorage {
+            typename Backend::template StaticStorage<Depth> backend; /**< Backendの領域 */
+            IpcQueueStatsStorage<Depth> stats; /**< 送受信統計の領域、無効時は空 */
+        };
+
+        /**
+         * @brief 静的に確保した領域にQueueを作成します。FreeRTOS Heapは使用しません
+         * @note この関数はQueue class内部変数が変更されるため、割り込み/中断が発生しない状況で使用する必要があります
+         * 
+         * @tparam Depth Queueの要素数
+         * @param storage Queueの領域、Queueを削除するまで破棄しないでください
+         * @return true 作成成功
+         * @return false 作成失敗
+         */
+        template<size_t Depth>
+        bool createQueue(StaticStorage<Depth>& storage) {
+            static_assert(Depth > 0, "IpcQueue depth must be greater than 0");
+            // already created
+            if (this->isInitialized) return false;
+
+            // create from backend
+            if (!this->backend.create(storage.backend)) return false;
+            if (!this->stats.assign(storage.stats)) {
+                this->backend.destroy();
+                return false;
+            }
+
+            this->depth = Depth;
+            this->isInitialized = true;
+            return true;
+        }
+
         /**
          * @brief Delete a RTOS Queue
          * @note この関数はQueue class内部変数が変更されるため、割り込み/中断が発生しない状況で使用する必要があります
@@ -67,10 +120,12 @@ class IpcQueue {
             // not created
             if (!this->isInitialized) return true;
             
-            vQueueDelete(this->queueHandle);
+            this->backend.destroy();
+            this->stats.release();
 
             this->depth = 0;
             this->isInitialized = false;
+            return true;
         }
 
         /**
@@ -83,8 +138,8 @@ class IpcQueue {
             // not created
             if (!this->isInitialized) return true;
 
-            const auto result = xQueueReset(this->queueHandle);
-            return (result == pdTRUE);
+            this->stats.resetSequence();
+            return this->backend.reset();
         }
 
         /**
@@ -100,8 +155,11 @@ class IpcQueue {
             // invalid dataPtr
             if (dataPtr == nullptr) return false;
 
-            const auto result = xQueueSend(this->queueHandle, dataPtr, 0);
-            return (result == pdPASS);
+            const bool result = (this->pushWithStats(1, [&](){ return this->backend.push(dataPtr) ? 1 : 0; }) > 0);
+            if (result) {
+                this->signalWaitSet();
+            }
+            return result;
         }
 
         /**
@@ -118,8 +176,167 @@ class IpcQueue {
             // invalid dataPtr
             if (dataPtr == nullptr) return false;
 
-            const auto result = xQueueReceive(this->queueHandle, dataPtr, (isBlocking ? portMAX_DELAY : 0)); // portMAX_DELAYを指定するとMessageが貯まるまで待つ
-            return (result == pdPASS);
+            return this->receiveWithTick(dataPtr, (isBlocking ? portMAX_DELAY : 0)); // portMAX_DELAYを指定するとMessageが貯まるまで待つ
+        }
+
+        /**
+         * @brief Queueからデータを受信します。受信できるまで最大timeoutMs待機します
+         * 
+         * @param dataPtr 受信するデータの格納先
+         * @param timeoutMs 最大待機時間[ms]
+         * @return true 受信成功
+         * @return false 受信失敗、未初期化及びtimeout、dataPtrがnullptrの可能性があります
+         */
+        bool receiveFor(T* dataPtr, uint32_t timeoutMs) {
+            // not created
+            if (!this->isInitialized) return false;
+            // invalid dataPtr
+            if (dataPtr == nullptr) return false;
+
+            return this->receiveWithTick(dataPtr, SysTimer::msToTick(timeoutMs));
+        }
+
+        /**
+         * @brief 送信時にIpcWaitSetへ通知するようにします
+         * @note IpcWaitSetの待機TaskはこのQueueをBlockingで受信しないでください
+         * 
+         * @param set 通知先
+         * @return true 登録成功
+         * @return false すでに登録済、またはsetに空きがない
+         */
+        bool attachWaitSet(IpcWaitSet& set) {
+            // already attached
+            if (this->waitSet != nullptr) return false;
+
+            const uint32_t bit = set.allocateBit();
+            if (bit == 0) return false;
+
+            this->waitSetBit = bit;
+            this->waitSet = &set;
+            return true;
+        }
+
+        /**
+         * @brief attachWaitSet()で割り当てられたbitを取得します
+         * 
+         * @return uint32_t IpcWaitSet::wait()の戻り値と比較するbit、未登録の場合は0
+         */
+        uint32_t getWaitSetBit(void) {
+            return this->waitSetBit;
+        }
+
+        /**
+         * @brief Queueに複数のデータをまとめて送信します
+         * 
+         * @param dataPtr 送信するデータの先頭、内容はQueue上にコピーされます
+         * @param num 送信するデータ数
+         * @return size_t 送信できたデータ数。Queueの空きが足りない場合は先頭から送れた分だけ送信します
+         */
+        size_t sendBatch(const T* dataPtr, size_t num) {
+            // not created
+            if (!this->isInitialized) return 0;
+            // invalid dataPtr
+            if (dataPtr == nullptr) return 0;
+
+            const size_t sentNum = this->pushWithStats(num, [&](){ return this->backend.pushBatch(dataPtr, num); });
+            if (sentNum > 0) {
+                this->signalWaitSet();
+            }
+            return sentNum;
+        }
+
+        /**
+         * @brief Queueに積まれているデータをすべて受信します
+         * @note 呼び出し中に追加されたデータは次回の呼び出しで受信します
+         * 
+         * @tparam F void(const T&) の型に一致する関数
+         * @param callback 受信したデータごとに古い順に呼び出されます。SpscRingBackendでは呼び出し中のSlotが解放されないため、長時間Blockingする処理は避けてください
+         * @return size_t 受信したデータ数
+         */
+        template<class F>
+        size_t receiveAll(F callback) {
+            // not created
+            if (!this->isInitialized) return 0;
+
+            return this->backend.popAll([&](const T& data) {
+                this->stats.onReceive();
+                callback(data);
+            });
+        }
+
+        /**
+         * @brief 送信データをQueue上で直接組み立てるための書き込み先を借用します
+         * @note commit()するまで他のTaskからは見えません。sizeof(T)が大きいデータを送信する場合に使用します
+         * @note Backend::IsZeroCopyがtrueの場合のみ使用できます
+         * 
+         * @return T* 書き込み先。未初期化、Queue Full、commit()前に再度呼び出した場合はnullptr
+         */
+        T* loan(void) {
+            static_assert(Backend::IsZeroCopy, "IpcQueue::loan requires a zero-copy backend such as SpscRingBackend");
+            // not created
+            if (!this->isInitialized) return nullptr;
+            // already loaned
+            if (this->isLoaned) return nullptr;
+
+            T* ptr = this->backend.loan();
+            this->isLoaned = (ptr != nullptr);
+            return ptr;
+        }
+
+        /**
+         * @brief loan()で借用した領域の内容を送信します
+         * 
+         * @return true 送信成功
+         * @return false 送信失敗。loan()していない可能性があります
+         */
+        bool commit(void) {
+            static_assert(Backend::IsZeroCopy, "IpcQueue::commit requires a zero-copy backend such as SpscRingBackend");
+            // not loaned
+            if (!this->isLoaned) return false;
+
+            this->isLoaned = false;
+            const bool result = (this->pushWithStats(1, [&](){ return this->backend.commit() ? 1 : 0; }) > 0);
+            if (result) {
+                this->signalWaitSet();
+            }
+            return result;
+        }
+
+        /**
+         * @brief Queueの先頭データを取り出さずに参照します
+         * @note 参照が終わったらrelease()を呼び出してください。release()するまでQueueから取り除かれません
+         * @note Backend::IsZeroCopyがtrueの場合のみ使用できます
+         * 
+         * @param isBlocking 受信できるまで待機する場合はtrue
+         * @return const T* 先頭データ。未初期化、Queue Emptyの場合はnullptr
+         */
+        const T* peek(bool isBlocking) {
+            static_assert(Backend::IsZeroCopy, "IpcQueue::peek requires a zero-copy backend such as SpscRingBackend");
+            // not created
+            if (!this->isInitialized) return nullptr;
+
+            const T* ptr = this->backend.peek(isBlocking ? portMAX_DELAY : 0);
+            this->isPeeked = (ptr != nullptr);
+            return ptr;
+        }
+
+        /**
+         * @brief peek()で参照した先頭データをQueueから取り除きます
+         * 
+         * @return true 解放成功
+         * @return false 解放失敗。peek()していない可能性があります
+         */
+        bool release(void) {
+            static_assert(Backend::IsZeroCopy, "IpcQueue::release requires a zero-copy backend such as SpscRingBackend");
+            // not peeked
+            if (!this->isPeeked) return false;
+
+            this->isPeeked = false;
+            const bool result = this->backend.release();
+            if (result) {
+                this->stats.onReceive();
+            }
+            return result;
         }
 
         /**
@@ -131,7 +348,7 @@ class IpcQueue {
             // not created
             if (!this->isInitialized) return 0;
 
-            return uxQueueMessagesWaiting(this->queueHandle);
+            return this->backend.count();
         }
 
         /**
@@ -143,7 +360,7 @@ class IpcQueue {
             // not created
             if (!this->isInitialized) return 0;
 
-            return this->depth - uxQueueMessagesWaiting(this->queueHandle);
+            return this->depth - this->backend.count();
         }
 
         /**
@@ -154,11 +371,79 @@ class IpcQueue {
         size_t getDepth(void) { 
             return this->depth; 
         }
+
+        /**
+         * @brief 送受信統計を取得します
+         * @note WFH_MONITOR_ENABLE_IPC_QUEUE_STATSを定義してビルドした場合のみ記録されます
+         * 
+         * @param dst 統計の書き込み先
+         * @return true 取得成功
+         * @return false 統計は無効化されている
+         */
+        bool getStats(IpcQueueStats& dst) {
+            return this->stats.get(dst);
+        }
+
+        /**
+         * @brief 送受信統計をクリアします
+         */
+        void clearStats(void) {
+            this->stats.clear();
+        }
     protected:
-        QueueHandle_t queueHandle;
+        Backend backend;
+        IpcQueueStatsRecorder stats; /**< 送受信統計、無効時は何も記録しない */
         bool isInitialized;
+        bool isLoaned; /**< loan()後、commit()前ならtrue */
+        bool isPeeked; /**< peek()後、release()前ならtrue */
         size_t entrySize;
         size_t depth;
+        IpcWaitSet* waitSet; /**< 送信時の通知先 */
+        uint32_t waitSetBit; /**< waitSetで割り当てられたbit */
+
+        /**
+         * @brief Backendに送信して統計を記録します
+         * @note 複数Producerから送信されるBackendでは、送信時刻の記録順と送信順がずれないようScheduler停止中にまとめて行います
+         *
+         * @tparam F size_t(void) の型に一致する関数
+         * @param num 送信する要素数
+         * @param push Backendに送信し、送信できた要素数を返す関数
+         * @return size_t 送信できた要素数
+         */
+        template<class F>
+        size_t pushWithStats(size_t num, F push) {
+            const bool isSerialized = IpcQueueStatsRecorder::IsEnabled && Backend::IsMultiProducer;
+            if (isSerialized) {
+                vTaskSuspendAll();
+            }
+            this->stats.beforeSend(num);
+            const size_t sentNum = push();
+            this->stats.afterSend(num, sentNum, [&](){ return this->backend.count(); });
+            if (isSerialized) {
+                xTaskResumeAll();
+            }
+            return sentNum;
+        }
+
+        /**
+         * @brief Backendから受信して統計を記録します
+         */
+        bool receiveWithTick(T* dataPtr, TickType_t waitTick) {
+            const bool result = this->backend.pop(dataPtr, waitTick);
+            if (result) {
+                this->stats.onReceive();
+            }
+            return result;
+        }
+
+        /**
+         * @brief 登録されたIpcWaitSetに送信を通知します
+         */
+        void signalWaitSet(void) {
+            if (this->waitSet != nullptr) {
+                this->waitSet->signal(this->waitSetBit);
+            }
+        }
 };
 
 #endif /* IPCQUEUE_H */
\ No newline at end of file
@@ -0,0 +1,490 @@
+#ifndef IPCQUEUEBACKEND_H
+#define IPCQUEUEBACKEND_H
+
+#include <cstdint>
+#include <atomic>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+// Task/QueueはRtosTopology.hで定義した領域に静的に確保するため、FreeRTOS Heapへのfallbackは持たない
+#if (configSUPPORT_STATIC_ALLOCATION != 1)
+#error "configSUPPORT_STATIC_ALLOCATION must be 1 (see build.sh)"
+#endif
+
+/**
+ * @brief FreeRTOS Queueを使用するIpcQueueのBackendです
+ * @note 複数Producer/複数Consumerでも使用できますが、送受信ごとにKernelに入りCritical Section内でコピーが発生します
+ * @note FreeRTOS Queue上の領域は直接参照できないため、loan()/peek()には対応していません
+ *
+ * @tparam T 送受信するデータ型
+ */
+template<typename T>
+class RtosQueueBackend {
+    public:
+        /**
+         * @brief loan()/peek()でQueue上の領域を直接読み書きできないことを示します
+         */
+        static constexpr bool IsZeroCopy = false;
+
+        /**
+         * @brief 複数のTaskから同時に送信できることを示します
+         */
+        static constexpr bool IsMultiProducer = true;
+
+        /**
+         * @brief Construct a new Rtos Queue Backend object
+         */
+        RtosQueueBackend(void): queueHandle(nullptr) {}
+
+        /**
+         * @brief Queueを作成します
+         *
+         * @param queueDepth Queueの要素数
+         * @return true 作成成功
+         * @return false 作成失敗
+         */
+        bool create(size_t queueDepth) {
+            this->queueHandle = xQueueCreate(queueDepth, sizeof(T));
+            return (this->queueHandle != nullptr);
+        }
+
+        /**
+         * @brief 静的に確保するQueueの領域です
+         *
+         * @tparam Depth Queueの要素数
+         */
+        template<size_t Depth>
+        struct StaticStorage {
+            uint8_t buffer[Depth * sizeof(T)]; /**< 要素の格納先 */
+            StaticQueue_t queue; /**< Queueの管理領域 */
+        };
+
+        /**
+         * @brief 静的に確保した領域にQueueを作成します。FreeRTOS Heapは使用しません
+         *
+         * @tparam Depth Queueの要素数
+         * @param storage Queueの領域、Queueを削除するまで破棄しないでください
+         * @return true 作成成功
+         * @return false 作成失敗
+         */
+        template<size_t Depth>
+        bool create(StaticStorage<Depth>& storage) {
+            this->queueHandle = xQueueCreateStatic(Depth, sizeof(T), storage.buffer, &storage.queue);
+            return (this->queueHandle != nullptr);
+        }
+
+        /**
+         * @brief Queueを削除します
+         */
+        void destroy(void) {
+            vQueueDelete(this->queueHandle);
+            this->queueHandle = nullptr;
+        }
+
+        /**
+         * @brief Queueの内容をすべてクリアします
+         *
+         * @return true クリア成功
+         * @return false クリア失敗
+         */
+        bool reset(void) {
+            return (xQueueReset(this->queueHandle) == pdTRUE);
+        }
+
+        /**
+         * @brief Queueにデータを追加します
+         *
+         * @param dataPtr 送信するデータのポインタ
+         * @return true 送信成功
+         * @return false Queue Full
+         */
+        bool push(const T* dataPtr) {
+            return (xQueueSend(this->queueHandle, dataPtr, 0) == pdPASS);
+        }
+
+        /**
+         * @brief Queueからデータを取り出します
+         *
+         * @param dataPtr 受信するデータの格納先
+         * @param waitTick 受信できるまで待機するTick数
+         * @return true 受信成功
+         * @return false Queue Empty
+         */
+        bool pop(T* dataPtr, TickType_t waitTick) {
+            return (xQueueReceive(this->queueHandle, dataPtr, waitTick) == pdPASS);
+        }
+
+        /**
+         * @brief Queueに複数のデータをまとめて追加します
+         * @note 途中でContext Switchが発生しないよう、Scheduler停止中にまとめて追加します
+         *
+         * @param dataPtr 送信するデータの先頭
+         * @param num 送信するデータ数
+         * @return size_t 送信できたデータ数
+         */
+        size_t pushBatch(const T* dataPtr, size_t num) {
+            size_t pushedNum = 0;
+            vTaskSuspendAll();
+            {
+                while ((pushedNum < num) && this->push(&dataPtr[pushedNum])) {
+                    pushedNum++;
+                }
+            }
+            xTaskResumeAll();
+            return pushedNum;
+        }
+
+        /**
+         * @brief popAll()でScheduler停止中にまとめて取り出す要素数です
+         * @note 呼び出し元のStackにこの要素数分の領域を確保します
+         */
+        static constexpr size_t PopAllBatchNum = 4;
+
+        /**
+         * @brief Queueに積まれているデータをすべて取り出します
+         * @note PopAllBatchNum要素ずつScheduler停止中に手元の領域へ取り出し、Scheduler再開後にcallbackを呼び出します
+         *       xQueueReceiveは要素ごとに呼び出されます
+         *
+         * @tparam F void(const T&) の型に一致する関数
+         * @param callback 取り出したデータごとに呼び出されます
+         * @return size_t 取り出したデータ数
+         */
+        template<class F>
+        size_t popAll(F callback) {
+            T batch[PopAllBatchNum];
+            const size_t num = this->count(); // 呼び出し中に追加された分は次回に回す
+            size_t poppedNum = 0;
+            while (poppedNum < num) {
+                size_t batchNum = 0;
+                vTaskSuspendAll();
+                {
+                    while ((batchNum < PopAllBatchNum) && ((poppedNum + batchNum) < num) && this->pop(&batch[batchNum], 0)) {
+                        batchNum++;
+                    }
+                }
+                xTaskResumeAll();
+
+                // callbackはScheduler再開後に呼び出すので、Blockingする処理も使用できる
+                for (size_t i = 0; i < batchNum; i++) {
+                    callback(static_cast<const T&>(batch[i]));
+                }
+                poppedNum += batchNum;
+                // 他のConsumerが先に取り出した
+                if (batchNum < PopAllBatchNum) break;
+            }
+            return poppedNum;
+        }
+
+        /**
+         * @brief Queueに追加された要素数を取得します
+         *
+         * @return size_t 要素数
+         */
+        size_t count(void) {
+            return uxQueueMessagesWaiting(this->queueHandle);
+        }
+
+    protected:
+        QueueHandle_t queueHandle;
+};
+
+/**
+ * @brief std::atomicのhead/tail indexで管理するLock-freeなRing BufferのBackendです
+ * @note Producer/Consumerがそれぞれ1Taskの場合のみ使用できます。送受信でKernelには入りません
+ * @note 受信待ちにはConsumer TaskのTask Notificationを使用するため、Consumer Taskで他の用途にTask Notificationを使わないでください
+ *
+ * @tparam T 送受信するデータ型
+ */
+template<typename T>
+class SpscRingBackend {
+    public:
+        /**
+         * @brief loan()/peek()でRing Buffer上のSlotを直接読み書きできることを示します
+         */
+        static constexpr bool IsZeroCopy = true;
+
+        /**
+         * @brief 送信できるのは1Taskのみであることを示します
+         */
+        static constexpr bool IsMultiProducer = false;
+
+        /**
+         * @brief Construct a new Spsc Ring Backend object
+         */
+        SpscRingBackend(void): buffer(nullptr), slotNum(0), isOwnedBuffer(false), head(0), tail(0), waitingTask(nullptr) {}
+
+        /**
+         * @brief Ring Bufferを作成します
+         * @note full/emptyを区別するため、queueDepth + 1要素分の領域をFreeRTOS Heapから確保します
+         *
+         * @param queueDepth Queueの要素数
+         * @return true 作成成功
+         * @return false 作成失敗
+         */
+        bool create(size_t queueDepth) {
+            const size_t num = queueDepth + 1;
+            T* allocated = static_cast<T*>(pvPortMalloc(sizeof(T) * num));
+            if (allocated == nullptr) return false;
+
+            this->assign(allocated, num, true);
+            return true;
+        }
+
+        /**
+         * @brief 静的に確保するRing Bufferの領域です
+         *
+         * @tparam Depth Queueの要素数
+         */
+        template<size_t Depth>
+        struct StaticStorage {
+            alignas(T) uint8_t buffer[(Depth + 1) * sizeof(T)]; /**< full/emptyを区別するため1要素多く確保する */
+        };
+
+        /**
+         * @brief 静的に確保した領域にRing Bufferを作成します。FreeRTOS Heapは使用しません
+         *
+         * @tparam Depth Queueの要素数
+         * @param storage Ring Bufferの領域、Ring Bufferを削除するまで破棄しないでください
+         * @return true 作成成功
+         */
+        template<size_t Depth>
+        bool create(StaticStorage<Depth>& storage) {
+            this->assign(reinterpret_cast<T*>(storage.buffer), Depth + 1, false);
+            return true;
+        }
+
+        /**
+         * @brief Ring Bufferを削除します
+         */
+        void destroy(void) {
+            if (this->isOwnedBuffer) {
+                vPortFree(this->buffer);
+            }
+            this->buffer = nullptr;
+            this->slotNum = 0;
+            this->isOwnedBuffer = false;
+        }
+
+        /**
+         * @brief Ring Bufferの内容をすべてクリアします
+         * @note Producer/Consumerのどちらも動作していない状況で使用してください
+         *
+         * @return true クリア成功
+         */
+        bool reset(void) {
+            this->tail.store(this->head.load(std::memory_order_acquire), std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Ring Bufferにデータを追加します。Producer Taskからのみ呼び出せます
+         *
+         * @param dataPtr 送信するデータのポインタ
+         * @return true 送信成功
+         * @return false Queue Full
+         */
+        bool push(const T* dataPtr) {
+            const size_t h    = this->head.load(std::memory_order_relaxed);
+            const size_t next = this->nextIndex(h);
+            // 1要素空けておかないとemptyと区別できない
+            if (next == this->tail.load(std::memory_order_acquire)) return false;
+
+            this->buffer[h] = *dataPtr;
+            this->head.store(next, std::memory_order_release);
+
+            // 受信待ちのTaskがいれば起こす
+            this->notifyConsumer();
+            return true;
+        }
+
+        /**
+         * @brief Ring Bufferからデータを取り出します。Consumer Taskからのみ呼び出せます
+         *
+         * @param dataPtr 受信するデータの格納先
+         * @param waitTick 受信できるまで待機するTick数
+         * @return true 受信成功
+         * @return false Queue Empty
+         */
+        bool pop(T* dataPtr, TickType_t waitTick) {
+            if (!this->waitForData(waitTick)) return false;
+
+            const size_t t = this->tail.load(std::memory_order_relaxed);
+            *dataPtr = this->buffer[t];
+            this->tail.store(this->nextIndex(t), std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Ring Bufferに複数のデータをまとめて追加します。Producer Taskからのみ呼び出せます
+         * @note headの更新とConsumerへの通知は1回だけ行います
+         *
+         * @param dataPtr 送信するデータの先頭
+         * @param num 送信するデータ数
+         * @return size_t 送信できたデータ数
+         */
+        size_t pushBatch(const T* dataPtr, size_t num) {
+            const size_t t = this->tail.load(std::memory_order_acquire);
+            size_t h = this->head.load(std::memory_order_relaxed);
+            size_t pushedNum = 0;
+            while ((pushedNum < num) && (this->nextIndex(h) != t)) {
+                this->buffer[h] = dataPtr[pushedNum];
+                h = this->nextIndex(h);
+                pushedNum++;
+            }
+            if (pushedNum > 0) {
+                this->head.store(h, std::memory_order_release);
+                this->notifyConsumer();
+            }
+            return pushedNum;
+        }
+
+        /**
+         * @brief Ring Bufferに積まれているデータをすべて取り出します。Consumer Taskからのみ呼び出せます
+         * @note callbackにはRing Buffer上のデータを直接渡し、tailの更新は最後に1回だけ行います
+         *
+         * @tparam F void(const T&) の型に一致する関数
+         * @param callback 取り出したデータごとに呼び出されます
+         * @return size_t 取り出したデータ数
+         */
+        template<class F>
+        size_t popAll(F callback) {
+            const size_t h = this->head.load(std::memory_order_acquire); // 呼び出し中に追加された分は次回に回す
+            size_t t = this->tail.load(std::memory_order_relaxed);
+            size_t poppedNum = 0;
+            while (t != h) {
+                callback(static_cast<const T&>(this->buffer[t]));
+                t = this->nextIndex(t);
+                poppedNum++;
+            }
+            if (poppedNum > 0) {
+                this->tail.store(t, std::memory_order_release);
+            }
+            return poppedNum;
+        }
+
+        /**
+         * @brief 次に送信するSlotを直接書き込み先として取得します。Producer Taskからのみ呼び出せます
+         *
+         * @return T* Ring Buffer上の書き込み先、Queue Fullの場合はnullptr
+         */
+        T* loan(void) {
+            const size_t h = this->head.load(std::memory_order_relaxed);
+            if (this->nextIndex(h) == this->tail.load(std::memory_order_acquire)) return nullptr;
+            return &this->buffer[h];
+        }
+
+        /**
+         * @brief loan()で取得したSlotを公開します。Producer Taskからのみ呼び出せます
+         *
+         * @return true 送信成功
+         */
+        bool commit(void) {
+            const size_t h = this->head.load(std::memory_order_relaxed);
+            this->head.store(this->nextIndex(h), std::memory_order_release);
+            this->notifyConsumer();
+            return true;
+        }
+
+        /**
+         * @brief 先頭のSlotを取り出さずに直接参照します。Consumer Taskからのみ呼び出せます
+         *
+         * @param waitTick 受信できるまで待機するTick数
+         * @return const T* Ring Buffer上の先頭データ、Queue Emptyの場合はnullptr
+         */
+        const T* peek(TickType_t waitTick) {
+            if (!this->waitForData(waitTick)) return nullptr;
+            return &this->buffer[this->tail.load(std::memory_order_relaxed)];
+        }
+
+        /**
+         * @brief peek()で参照した先頭Slotを解放します。Consumer Taskからのみ呼び出せます
+         *
+         * @return true 解放成功
+         * @return false Queue Empty
+         */
+        bool release(void) {
+            if (this->count() == 0) return false;
+            const size_t t = this->tail.load(std::memory_order_relaxed);
+            this->tail.store(this->nextIndex(t), std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Ring Bufferに追加された要素数を取得します
+         *
+         * @return size_t 要素数
+         */
+        size_t count(void) {
+            const size_t h = this->head.load(std::memory_order_acquire);
+            const size_t t = this->tail.load(std::memory_order_acquire);
+            return (h >= t) ? (h - t) : (this->slotNum - t + h);
+        }
+
+    protected:
+        T* buffer; /**< slotNum要素分の格納先 */
+        size_t slotNum; /**< depth + 1 */
+        bool isOwnedBuffer; /**< bufferをFreeRTOS Heapから確保していればtrue */
+        std::atomic<size_t> head; /**< 次に書き込むindex, Producerのみ更新する */
+        std::atomic<size_t> tail; /**< 次に読み出すindex, Consumerのみ更新する */
+        std::atomic<TaskHandle_t> waitingTask; /**< 受信待ちしているConsumer Task */
+
+        /**
+         * @brief Ring Bufferの領域を割り当てて、空の状態にします
+         */
+        void assign(T* slots, size_t num, bool isOwned) {
+            this->buffer = slots;
+            this->slotNum = num;
+            this->isOwnedBuffer = isOwned;
+            this->head.store(0, std::memory_order_relaxed);
+            this->tail.store(0, std::memory_order_relaxed);
+            this->waitingTask.store(nullptr, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 次のindexを取得します
+         */
+        size_t nextIndex(size_t index) {
+            return (index + 1 == this->slotNum) ? 0 : (index + 1);
+        }
+
+        /**
+         * @brief データが読み出せるまで待機します
+         *
+         * @param waitTick 待機するTick数, 0なら待たない
+         * @return true 読み出せるデータがある
+         * @return false timeout
+         */
+        bool waitForData(TickType_t waitTick) {
+            if (this->count() > 0) return true;
+            if (waitTick == 0) return false;
+
+            // 通知先を登録してから再確認することで、Producerとの間で通知を取りこぼさない
+            this->waitingTask.store(xTaskGetCurrentTaskHandle(), std::memory_order_seq_cst);
+            const TickType_t startTick = xTaskGetTickCount();
+            bool isReady = (this->count() > 0);
+            while (!isReady) {
+                TickType_t remainTick = portMAX_DELAY;
+                if (waitTick != portMAX_DELAY) {
+                    const TickType_t elapsedTick = xTaskGetTickCount() - startTick;
+                    if (elapsedTick >= waitTick) break;
+                    remainTick = waitTick - elapsedTick;
+                }
+                ulTaskNotifyTake(pdTRUE, remainTick);
+                isReady = (this->count() > 0);
+            }
+            this->waitingTask.store(nullptr, std::memory_order_seq_cst);
+            return isReady;
+        }
+
+        /**
+         * @brief 受信待ちしているConsumerを起床させます
+         */
+        void notifyConsumer(void) {
+            const TaskHandle_t task = this->waitingTask.load(std::memory_order_seq_cst);
+            if (task != nullptr) {
+                xTaskNotifyGive(task);
+            }
+        }
+};
+
+#endif /* IPCQUEUEBACKEND_H */
@@ -2,9 +2,40 @@
 #define IPCQUEUEDEFS_H
 
 #include <cstdint>
+#include <type_traits>
 
 #include "def/MeasureData.h"
 #include "def/ButtonEvent.h"
 #include "def/WifiTaskData.h"
+#include "def/SdTaskData.h"
+
+#include "FixedConfig.h"
+#include "IpcQueueBackend.h"
+#include "IpcQueue.h"
+#include "PubSubTopic.h"
+
+/**
+ * @brief Producer/Consumerが1Taskずつに決まっているTask間通信に使用するQueueです
+ * @note FixedConfig::UseLockFreeIpcQueueでBackendを切り替えます
+ *
+ * @tparam T 送受信するデータ型
+ */
+template<typename T>
+using PointToPointQueue = IpcQueue<T, typename std::conditional<FixedConfig::UseLockFreeIpcQueue, SpscRingBackend<T>, RtosQueueBackend<T>>::type>;
+
+/**
+ * @brief Producer/Consumerが1Taskずつで、loan()/peek()でQueue上のデータを直接読み書きするTask間通信に使用するQueueです
+ * @note FreeRTOS Queueはloan()/peek()に対応していないため、FixedConfig::UseLockFreeIpcQueueによらずSpscRingBackendを使用します
+ *
+ * @tparam T 送受信するデータ型
+ */
+template<typename T>
+using ZeroCopyQueue = IpcQueue<T, SpscRingBackend<T>>;
+
+/**
+ * @brief GroveTaskの測定データを時系列で受け取りたいTaskに配信するTopicです
+ * @note 最新値だけが必要な場合はLatestValue<MeasureData>を使用します
+ */
+using MeasureDataTopic = PubSubTopic<MeasureData, FixedConfig::MeasureDataTopicSubscriberMax, FixedConfig::MeasureDataTopicDepth>;
 
 #endif /* IPCQUEUEDEFS_H */
\ No newline at end of file
@@ -0,0 +1,228 @@
+#ifndef IPCQUEUESTATS_H
+#define IPCQUEUESTATS_H
+
+#include <cstdint>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "SysTimer.h"
+
+/**
+ * @brief IpcQueueStatsのLatency Histogramのbin数です
+ * @note bin[0]は0tick, bin[i]は[2^(i-1), 2^i)tick, 最後のbinはそれ以上をすべて含みます
+ */
+static constexpr size_t IpcQueueStatsLatencyBinNum = 16;
+
+/**
+ * @brief IpcQueueの送受信統計です
+ */
+struct IpcQueueStats {
+    uint32_t sendNum;      /**< 送信に成功した要素数 */
+    uint32_t sendFailNum;  /**< Queue Fullなどで送信に失敗した要素数 */
+    uint32_t receiveNum;   /**< 受信した要素数 */
+    size_t   maxOccupancy; /**< 送信直後に観測したQueue内の最大要素数 */
+    uint32_t latencyHistogram[IpcQueueStatsLatencyBinNum]; /**< 送信してから受信されるまでのtick数の分布 */
+};
+
+#ifdef WFH_MONITOR_ENABLE_IPC_QUEUE_STATS
+
+/**
+ * @brief 静的に確保する送信時刻の記録領域です
+ *
+ * @tparam Depth 記録対象のQueueの要素数
+ */
+template<size_t Depth>
+struct IpcQueueStatsStorage {
+    uint32_t sendTicks[Depth + 1]; /**< Backendの領域と同数あれば上書きされない */
+};
+
+/**
+ * @brief IpcQueueの送受信統計を記録します
+ * @note 送信側の記録は同時に1Task、受信側の記録はConsumer Taskからのみ行われる前提です
+ *       複数Producerの場合は、IpcQueueが送信と記録をまとめてScheduler停止中に行います
+ */
+class IpcQueueStatsRecorder {
+    public:
+        /**
+         * @brief 統計を記録することを示します
+         */
+        static constexpr bool IsEnabled = true;
+
+        /**
+         * @brief Construct a new Ipc Queue Stats Recorder object
+         */
+        IpcQueueStatsRecorder(void): sendTicks(nullptr), slotNum(0), isOwnedTicks(false), sendSequence(0), receiveSequence(0) {
+            this->clear();
+        }
+
+        /**
+         * @brief 送信時刻の記録領域を確保します
+         *
+         * @param queueDepth 記録対象のQueueの要素数
+         * @return true 確保成功
+         * @return false 確保失敗
+         */
+        bool allocate(size_t queueDepth) {
+            const size_t num = queueDepth + 1; // Backendの領域と同数あれば上書きされない
+            this->sendTicks = static_cast<uint32_t*>(pvPortMalloc(sizeof(uint32_t) * num));
+            if (this->sendTicks == nullptr) return false;
+
+            this->slotNum = num;
+            this->isOwnedTicks = true;
+            this->resetSequence();
+            return true;
+        }
+
+        /**
+         * @brief 静的に確保した送信時刻の記録領域を割り当てます
+         *
+         * @tparam Depth 記録対象のQueueの要素数
+         * @param storage 記録領域
+         * @return true 割り当て成功
+         */
+        template<size_t Depth>
+        bool assign(IpcQueueStatsStorage<Depth>& storage) {
+            this->sendTicks = storage.sendTicks;
+            this->slotNum = Depth + 1;
+            this->isOwnedTicks = false;
+            this->resetSequence();
+            return true;
+        }
+
+        /**
+         * @brief 送信時刻の記録領域を解放します
+         */
+        void release(void) {
+            if (this->isOwnedTicks) {
+                vPortFree(this->sendTicks);
+            }
+            this->sendTicks = nullptr;
+            this->slotNum = 0;
+            this->isOwnedTicks = false;
+        }
+
+        /**
+         * @brief Queueの内容がクリアされたときに、送信時刻の対応関係をリセットします
+         */
+        void resetSequence(void) {
+            this->sendSequence = 0;
+            this->receiveSequence = 0;
+        }
+
+        /**
+         * @brief 統計をクリアします
+         */
+        void clear(void) {
+            this->stats.sendNum = 0;
+            this->stats.sendFailNum = 0;
+            this->stats.receiveNum = 0;
+            this->stats.maxOccupancy = 0;
+            for (size_t i = 0; i < IpcQueueStatsLatencyBinNum; i++) {
+                this->stats.latencyHistogram[i] = 0;
+            }
+        }
+
+        /**
+         * @brief 送信直前に呼び出し、送信時刻を記録します
+         * @note Consumerから見える前に記録しておく必要があるため、送信の成否が決まる前に呼び出します
+         *
+         * @param num これから送信する要素数
+         */
+        void beforeSend(size_t num) {
+            const uint32_t tick = SysTimer::getTickCount();
+            const size_t stampNum = (num < this->slotNum) ? num : this->slotNum;
+            for (size_t i = 0; i < stampNum; i++) {
+                this->sendTicks[(this->sendSequence + i) % this->slotNum] = tick;
+            }
+        }
+
+        /**
+         * @brief 送信結果を記録します
+         *
+         * @tparam F size_t(void) の型に一致する関数
+         * @param requestNum 送信しようとした要素数
+         * @param sentNum 送信できた要素数
+         * @param getOccupancy 送信後のQueue内の要素数を返す関数
+         */
+        template<class F>
+        void afterSend(size_t requestNum, size_t sentNum, F getOccupancy) {
+            this->sendSequence += sentNum;
+            this->stats.sendNum += sentNum;
+            this->stats.sendFailNum += (requestNum - sentNum);
+            if (sentNum == 0) return;
+
+            const size_t occupancy = getOccupancy();
+            if (occupancy > this->stats.maxOccupancy) {
+                this->stats.maxOccupancy = occupancy;
+            }
+        }
+
+        /**
+         * @brief 受信を記録します
+         */
+        void onReceive(void) {
+            const uint32_t latencyTick = SysTimer::diff(this->sendTicks[this->receiveSequence % this->slotNum], SysTimer::getTickCount());
+            this->receiveSequence++;
+            this->stats.receiveNum++;
+            this->stats.latencyHistogram[latencyToBin(latencyTick)]++;
+        }
+
+        /**
+         * @brief 現在の統計を取得します
+         *
+         * @param dst 統計の書き込み先
+         * @return true 取得成功
+         */
+        bool get(IpcQueueStats& dst) {
+            dst = this->stats;
+            return true;
+        }
+
+    protected:
+        IpcQueueStats stats;
+        uint32_t* sendTicks;      /**< 送信時刻, sequence % slotNumの位置に記録する */
+        size_t slotNum;           /**< sendTicksの要素数 */
+        bool isOwnedTicks;        /**< sendTicksをFreeRTOS Heapから確保していればtrue */
+        uint32_t sendSequence;    /**< 次に送信する要素の通し番号 */
+        uint32_t receiveSequence; /**< 次に受信する要素の通し番号 */
+
+        /**
+         * @brief LatencyからHistogramのbinを求めます
+         */
+        static size_t latencyToBin(uint32_t latencyTick) {
+            if (latencyTick == 0) return 0;
+            const size_t bin = 32 - __builtin_clz(latencyTick);
+            return (bin < IpcQueueStatsLatencyBinNum) ? bin : (IpcQueueStatsLatencyBinNum - 1);
+        }
+};
+
+#else
+
+/**
+ * @brief WFH_MONITOR_ENABLE_IPC_QUEUE_STATSが未定義の場合は領域を確保しません
+ */
+template<size_t Depth>
+struct IpcQueueStatsStorage {};
+
+/**
+ * @brief WFH_MONITOR_ENABLE_IPC_QUEUE_STATSが未定義の場合は何も記録しません
+ */
+class IpcQueueStatsRecorder {
+    public:
+        static constexpr bool IsEnabled = false;
+        bool allocate(size_t queueDepth) { return true; }
+        template<size_t Depth>
+        bool assign(IpcQueueStatsStorage<Depth>& storage) { return true; }
+        void release(void) {}
+        void resetSequence(void) {}
+        void clear(void) {}
+        void beforeSend(size_t num) {}
+        template<class F>
+        void afterSend(size_t requestNum, size_t sentNum, F getOccupancy) {}
+        void onReceive(void) {}
+        bool get(IpcQueueStats& dst) { return false; }
+};
+
+#endif /* WFH_MONITOR_ENABLE_IPC_QUEUE_STATS */
+
+#endif /* IPCQUEUESTATS_H */
@@ -0,0 +1,97 @@
+#ifndef IPCWAITSET_H
+#define IPCWAITSET_H
+
+#include <cstdint>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+/**
+ * @brief 複数のIpcQueue/LatestValueのいずれかが更新されるまでTaskを待機させます
+ * @note FreeRTOSのQueue Setと同様の用途ですが、SpscRingBackendやLatestValueはFreeRTOS Queueではないため
+ *       待機TaskのTask Notificationのbitで通知します
+ * @note 待機TaskではTask Notificationを他の用途(SpscRingBackendのBlocking受信など)に使わないでください
+ */
+class IpcWaitSet {
+    public:
+        /**
+         * @brief Construct a new Ipc Wait Set object
+         */
+        IpcWaitSet(void): waiterTask(nullptr), allocatedBits(0) {}
+
+        /**
+         * @brief Destroy the Ipc Wait Set object
+         */
+        virtual ~IpcWaitSet(void) {}
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        IpcWaitSet(const IpcWaitSet&) = delete;
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        IpcWaitSet& operator=(const IpcWaitSet&) = delete;
+
+        /**
+         * @brief 通知に使うbitを割り当てます
+         * @note IpcQueue::attachWaitSet/LatestValue::attachWaitSetから呼び出されます
+         *
+         * @return uint32_t 割り当てたbit, 割り当てられるbitがない場合は0
+         */
+        uint32_t allocateBit(void) {
+            uint32_t bit = 0;
+            taskENTER_CRITICAL();
+            {
+                for (uint32_t i = 0; i < 32; i++) {
+                    const uint32_t candidate = (0x1u << i);
+                    if ((this->allocatedBits & candidate) == 0) {
+                        this->allocatedBits |= candidate;
+                        bit = candidate;
+                        break;
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+            return bit;
+        }
+
+        /**
+         * @brief 呼び出したTaskを待機Taskとして登録します。以後のsignal()はこのTaskに通知されます
+         */
+        void bindCurrentTask(void) {
+            this->waiterTask = xTaskGetCurrentTaskHandle();
+        }
+
+        /**
+         * @brief 待機Taskに更新を通知します
+         *
+         * @param bits allocateBit()で割り当てたbit
+         */
+        void signal(uint32_t bits) {
+            const TaskHandle_t task = this->waiterTask;
+            if (task != nullptr) {
+                xTaskNotify(task, bits, eSetBits);
+            }
+        }
+
+        /**
+         * @brief いずれかのメンバーが更新されるか、timeoutするまで待機します。bindCurrentTask()したTaskからのみ呼び出せます
+         *
+         * @param waitTick 最大待機時間, portMAX_DELAYなら更新されるまで待つ
+         * @return uint32_t 更新されたメンバーのbit, timeoutした場合は0
+         */
+        uint32_t wait(TickType_t waitTick) {
+            uint32_t bits = 0;
+            if (xTaskNotifyWait(0, UINT32_MAX, &bits, waitTick) != pdTRUE) {
+                return 0;
+            }
+            return bits;
+        }
+
+    protected:
+        volatile TaskHandle_t waiterTask; /**< 待機Task */
+        uint32_t allocatedBits; /**< 割り当て済のbit */
+};
+
+#endif /* IPCWAITSET_H */
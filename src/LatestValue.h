@@ -0,0 +1,140 @@
+#ifndef LATESTVALUE_H
+#define LATESTVALUE_H
+
+#include <cstdint>
+#include <atomic>
+#include <type_traits>
+
+#include "IpcWaitSet.h"
+
+/**
+ * @brief 最新の値だけを複数Taskで共有するRegisterを提供します
+ * @note 書き込みは1Taskのみ、読み出しは任意数のTaskから行えます。どちらもLockは取りません
+ * @note 2面のBufferを交互に書き換えるSeqlockです。書き込み途中で読み出し側に切り替わっても、書き込み中ではない面から読み出せるため
+ *       読み出し側の優先度が高い場合でも書き込み完了を待つことはありません
+ * @note IpcQueue.h同様 CPU DataCacheの影響を考慮した配置を行ってください
+ *
+ * @tparam T 共有するデータ型, memcpyでコピーできる型である必要があります
+ */
+template<typename T>
+class LatestValue {
+    static_assert(std::is_trivially_copyable<T>::value, "LatestValue<T> requires trivially copyable T");
+
+    public:
+        /**
+         * @brief Construct a new Latest Value object
+         */
+        LatestValue(void): generation(0), waitSet(nullptr), waitSetBit(0) {}
+
+        /**
+         * @brief Destroy the Latest Value object
+         */
+        virtual ~LatestValue(void) {}
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        LatestValue(const LatestValue&) = delete;
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        LatestValue& operator=(const LatestValue&) = delete;
+
+        /**
+         * @brief 最新の値を公開します。書き込みTaskからのみ呼び出せます
+         * @note 読み出し側の状態に関わらず待機せずに完了します
+         *
+         * @param value 公開する値
+         */
+        void publish(const T& value) {
+            const uint32_t next = this->generation.load(std::memory_order_relaxed) + 1;
+            // 前回のpublishで進めた世代を、この面への書き込みより先に読み出し側から見えるようにする
+            // 書き込み途中の面を読んだ読み出し側は、read()のacquire fence以降で必ず世代の変化を観測して読み直す
+            std::atomic_thread_fence(std::memory_order_release);
+            // 読み出し側が参照していない面に書き込んでから世代を進める
+            this->buffers[next & 0x1] = value;
+            this->generation.store(next, std::memory_order_release);
+            // 待機しているTaskがいれば起こす
+            if (this->waitSet != nullptr) {
+                this->waitSet->signal(this->waitSetBit);
+            }
+        }
+
+        /**
+         * @brief publish時にIpcWaitSetへ通知するようにします
+         * @note 通知できるのは1つのIpcWaitSetのみです
+         *
+         * @param set 通知先
+         * @return true 登録成功
+         * @return false すでに登録済、またはsetに空きがない
+         */
+        bool attachWaitSet(IpcWaitSet& set) {
+            if (this->waitSet != nullptr) return false;
+
+            const uint32_t bit = set.allocateBit();
+            if (bit == 0) return false;
+
+            this->waitSetBit = bit;
+            this->waitSet = &set;
+            return true;
+        }
+
+        /**
+         * @brief 最新の値を読み出します
+         *
+         * @param dst 読み出したデータの書き込み先、一度も公開されていない場合は操作しません
+         * @return uint32_t 読み出した値の世代。一度も公開されていない場合は0
+         */
+        uint32_t read(T& dst) {
+            while (true) {
+                const uint32_t before = this->generation.load(std::memory_order_acquire);
+                if (before == 0) return 0;
+
+                T tmp = this->buffers[before & 0x1];
+                // publish()のrelease fenceと対になり、書き込み途中の値を読んでいれば以降の世代の読み出しで必ず検出できる
+                std::atomic_thread_fence(std::memory_order_acquire);
+                // 読んだ面を次に書き換えるのは2つ先の世代なので、読み出し中に世代が進んでいなければ壊れていない
+                const uint32_t after = this->generation.load(std::memory_order_relaxed);
+                if (after == before) {
+                    dst = tmp;
+                    return before;
+                }
+            }
+        }
+
+        /**
+         * @brief 前回読み出した時から値が更新されていれば読み出します
+         *
+         * @param dst 読み出したデータの書き込み先、更新がなければ操作しません
+         * @param lastGeneration 前回読み出した世代、読み出した場合は今回の世代に更新されます
+         * @return true 新しい値を読み出した
+         * @return false 値は更新されていない
+         */
+        bool readIfUpdated(T& dst, uint32_t& lastGeneration) {
+            if (this->getGeneration() == lastGeneration) return false;
+
+            const uint32_t readGeneration = this->read(dst);
+            if (readGeneration == 0) return false;
+
+            lastGeneration = readGeneration;
+            return true;
+        }
+
+        /**
+         * @brief 現在の世代を取得します
+         *
+         * @return uint32_t 公開ごとに1増える値。一度も公開されていない場合は0
+         */
+        uint32_t getGeneration(void) {
+            return this->generation.load(std::memory_order_acquire);
+        }
+
+    protected:
+        std::atomic<uint32_t> generation; /**< 公開回数、下位1bitが最新の面を示す */
+        T buffers[2]; /**< 交互に書き込む2面のBuffer */
+        IpcWaitSet* waitSet; /**< publish時の通知先 */
+        uint32_t waitSetBit; /**< waitSetで割り当てられたbit */
+};
+
+#endif /* LATESTVALUE_H */
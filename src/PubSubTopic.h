@@ -0,0 +1,299 @@
+#ifndef PUBSUBTOPIC_H
+#define PUBSUBTOPIC_H
+
+#include <cstdint>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+/**
+ * @brief Subscriberの受信待ちが一杯になったときの挙動です
+ */
+enum class PubSubOverflowPolicy : uint32_t {
+    DropOldest, /**< 一番古い未受信データを捨てて新しいデータを積む */
+    DropNewest, /**< 新しいデータを捨てる */
+    Block,      /**< 空きができるまでPublisherを待たせる */
+};
+
+/**
+ * @brief Subscriberの受信統計です
+ */
+struct PubSubSubscriberStats {
+    uint32_t receiveNum; /**< 受信したデータ数 */
+    uint32_t droppedNum; /**< overflowで捨てられたデータ数 */
+};
+
+/**
+ * @brief 1つのPublisherから任意数のSubscriberにデータを配信するTopicです
+ * @note publish()時にデータは共有Slotへ1回だけコピーされ、各Subscriberには参照カウント付きのSlot番号が配信されます
+ *       Subscriber数が増えてもコピー回数は増えません
+ * @note Publisherは1Taskのみ、Subscriberは1Subscriberにつき1Taskから操作してください
+ * @note IpcQueue.h同様 CPU DataCacheの影響を考慮した配置を行ってください
+ *
+ * @tparam T 配信するデータ型
+ * @tparam SubscriberMax 登録できるSubscriber数
+ * @tparam Depth Subscriberごとに保持できる未受信データ数の上限
+ */
+template<typename T, size_t SubscriberMax, size_t Depth>
+class PubSubTopic {
+    public:
+        /**
+         * @brief Subscriberを識別する値です
+         */
+        typedef size_t SubscriberId;
+
+        /**
+         * @brief Construct a new Pub Sub Topic object
+         */
+        PubSubTopic(void): subscriberNum(0) {
+            for (size_t i = 0; i < SlotNum; i++) {
+                this->refCounts[i] = 0;
+            }
+        }
+
+        /**
+         * @brief Destroy the Pub Sub Topic object
+         */
+        virtual ~PubSubTopic(void) {}
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        PubSubTopic(const PubSubTopic&) = delete;
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        PubSubTopic& operator=(const PubSubTopic&) = delete;
+
+        /**
+         * @brief Subscriberを登録します。登録以後にpublishされたデータから受信できます
+         *
+         * @param depth 保持する未受信データ数, 1以上Depth以下
+         * @param policy 未受信データが一杯になったときの挙動
+         * @param id 登録されたSubscriberの識別子
+         * @return true 登録成功
+         * @return false 登録数の上限、またはdepthが不正
+         */
+        bool subscribe(size_t depth, PubSubOverflowPolicy policy, SubscriberId& id) {
+            if ((depth == 0) || (depth > Depth)) return false;
+
+            bool result = false;
+            taskENTER_CRITICAL();
+            {
+                if (this->subscriberNum < SubscriberMax) {
+                    Subscriber& s = this->subscribers[this->subscriberNum];
+                    s.depth = depth;
+                    s.policy = policy;
+                    s.head = 0;
+                    s.tail = 0;
+                    s.count = 0;
+                    s.stats.receiveNum = 0;
+                    s.stats.droppedNum = 0;
+                    id = this->subscriberNum;
+                    this->subscriberNum++;
+                    result = true;
+                }
+            }
+            taskEXIT_CRITICAL();
+            return result;
+        }
+
+        /**
+         * @brief データを配信します。Publisher Taskからのみ呼び出せます
+         * @note PubSubOverflowPolicy::BlockのSubscriberに空きがない場合、空きができるまで待機します
+         *
+         * @param data 配信するデータ、共有Slotに1回だけコピーされます
+         * @return size_t 配信したSubscriber数
+         */
+        size_t publish(const T& data) {
+            // SlotNumは全Subscriberが最大数参照していても1つ余るので、必ず空きが見つかる
+            const size_t slot = this->findFreeSlot();
+            this->slots[slot] = data;
+
+            size_t deliveredNum = 0;
+            const size_t num = this->subscriberNum;
+            for (size_t i = 0; i < num; i++) {
+                if (this->deliver(this->subscribers[i], slot)) {
+                    deliveredNum++;
+                }
+            }
+            return deliveredNum;
+        }
+
+        /**
+         * @brief 未受信データを1つ受信します。Subscriber Taskからのみ呼び出せます
+         *
+         * @param id Subscriberの識別子
+         * @param dst 受信したデータの書き込み先
+         * @return true 受信成功
+         * @return false 未受信データがない
+         */
+        bool receive(SubscriberId id, T& dst) {
+            return this->consume(id, [&](const T& data) { dst = data; });
+        }
+
+        /**
+         * @brief 未受信データをすべて受信します。Subscriber Taskからのみ呼び出せます
+         * @note callbackには共有Slot上のデータを直接渡すのでコピーは発生しません
+         *
+         * @tparam F void(const T&) の型に一致する関数
+         * @param id Subscriberの識別子
+         * @param callback 受信したデータごとに古い順に呼び出されます
+         * @return size_t 受信したデータ数
+         */
+        template<class F>
+        size_t receiveAll(SubscriberId id, F callback) {
+            size_t receivedNum = 0;
+            while (this->consume(id, callback)) {
+                receivedNum++;
+            }
+            return receivedNum;
+        }
+
+        /**
+         * @brief 未受信データ数を取得します
+         *
+         * @param id Subscriberの識別子
+         * @return size_t 未受信データ数
+         */
+        size_t remainNum(SubscriberId id) {
+            if (id >= this->subscriberNum) return 0;
+            return this->subscribers[id].count;
+        }
+
+        /**
+         * @brief Subscriberの受信統計を取得します
+         *
+         * @param id Subscriberの識別子
+         * @param dst 統計の書き込み先
+         * @return true 取得成功
+         * @return false idが不正
+         */
+        bool getStats(SubscriberId id, PubSubSubscriberStats& dst) {
+            if (id >= this->subscriberNum) return false;
+
+            taskENTER_CRITICAL();
+            {
+                dst = this->subscribers[id].stats;
+            }
+            taskEXIT_CRITICAL();
+            return true;
+        }
+
+    protected:
+        /**
+         * @brief 共有Slot数, 全Subscriberが未受信Depth個+受信処理中1個を参照しても1つ余る数
+         */
+        static constexpr size_t SlotNum = SubscriberMax * (Depth + 1) + 1;
+
+        /**
+         * @brief Subscriberごとの受信待ちSlot番号のRing Bufferです
+         */
+        struct Subscriber {
+            size_t slotIndexes[Depth]; /**< 未受信データのSlot番号 */
+            size_t depth;   /**< 有効なslotIndexesの要素数 */
+            size_t head;    /**< 次に書き込むindex */
+            size_t tail;    /**< 次に読み出すindex */
+            volatile size_t count; /**< 未受信データ数 */
+            PubSubOverflowPolicy policy;
+            PubSubSubscriberStats stats;
+        };
+
+        T slots[SlotNum]; /**< 配信データの共有Slot */
+        volatile uint32_t refCounts[SlotNum]; /**< Slotを参照しているSubscriber数 */
+        Subscriber subscribers[SubscriberMax];
+        volatile size_t subscriberNum; /**< 登録済Subscriber数 */
+
+        /**
+         * @brief 誰からも参照されていないSlotを探します
+         */
+        size_t findFreeSlot(void) {
+            for (size_t i = 0; i < SlotNum; i++) {
+                if (this->refCounts[i] == 0) return i;
+            }
+            return 0; // SlotNumの定義上ここには来ない
+        }
+
+        /**
+         * @brief Subscriberの受信待ちにSlotを積みます
+         *
+         * @return true 配信した
+         * @return false PubSubOverflowPolicy::DropNewestで捨てた
+         */
+        bool deliver(Subscriber& s, size_t slot) {
+            while (true) {
+                size_t droppedSlot = SlotNum;
+                bool isDelivered = false;
+                bool isBlocked = false;
+                taskENTER_CRITICAL();
+                {
+                    if (s.count == s.depth) {
+                        switch (s.policy) {
+                            case PubSubOverflowPolicy::DropOldest:
+                                // 一番古いものを外して参照を返す
+                                droppedSlot = s.slotIndexes[s.tail];
+                                s.tail = (s.tail + 1) % s.depth;
+                                s.count--;
+                                s.stats.droppedNum++;
+                                this->refCounts[droppedSlot]--;
+                                break;
+                            case PubSubOverflowPolicy::DropNewest:
+                                s.stats.droppedNum++;
+                                break;
+                            case PubSubOverflowPolicy::Block:
+                            default:
+                                isBlocked = true;
+                                break;
+                        }
+                    }
+                    if (s.count < s.depth) {
+                        s.slotIndexes[s.head] = slot;
+                        s.head = (s.head + 1) % s.depth;
+                        s.count++;
+                        this->refCounts[slot]++;
+                        isDelivered = true;
+                    }
+                }
+                taskEXIT_CRITICAL();
+
+                if (!isBlocked) return isDelivered;
+                // Subscriberが受信するまで待つ
+                vTaskDelay(1);
+            }
+        }
+
+        /**
+         * @brief 一番古い未受信データをcallbackに渡して参照を返します
+         */
+        template<class F>
+        bool consume(SubscriberId id, F callback) {
+            if (id >= this->subscriberNum) return false;
+            Subscriber& s = this->subscribers[id];
+
+            // Slot番号を取り出す、参照は保持したまま
+            size_t slot = SlotNum;
+            taskENTER_CRITICAL();
+            {
+                if (s.count > 0) {
+                    slot = s.slotIndexes[s.tail];
+                    s.tail = (s.tail + 1) % s.depth;
+                    s.count--;
+                    s.stats.receiveNum++;
+                }
+            }
+            taskEXIT_CRITICAL();
+            if (slot == SlotNum) return false;
+
+            // 参照中はPublisherに上書きされない
+            callback(static_cast<const T&>(this->slots[slot]));
+
+            taskENTER_CRITICAL();
+            {
+                this->refCounts[slot]--;
+            }
+            taskEXIT_CRITICAL();
+            return true;
+        }
+};
+
+#endif /* PUBSUBTOPIC_H */
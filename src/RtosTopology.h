@@ -0,0 +1,179 @@
+#ifndef RTOSTOPOLOGY_H
+#define RTOSTOPOLOGY_H
+
+#include <cstdint>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "FixedConfig.h"
+#include "TaskBase.h"
+#include "coop/CoopExecutor.h"
+#include "IpcQueue.h"
+#include "IpcQueueDefs.h"
+
+/**
+ * @brief 静的に確保するTaskの定義です
+ */
+struct RtosTaskSpec {
+    const char* name;   /**< Task名, TaskBase::getName()と一致させる */
+    size_t stackSize;   /**< StackSize[word] */
+    uint32_t priority;  /**< Task優先度 */
+    size_t storageSize; /**< 静的に確保する領域[byte] */
+};
+
+/**
+ * @brief 静的に確保するQueueの定義です
+ */
+struct RtosQueueSpec {
+    const char* name;     /**< Queue名 */
+    size_t entrySize;     /**< 要素のサイズ[byte] */
+    size_t depth;         /**< 要素数 */
+    size_t storageSize;   /**< 静的に確保する領域[byte] */
+    const char* producer; /**< 送信するTask名 */
+    const char* consumer; /**< 受信するTask名 */
+};
+
+/**
+ * @brief RtosTaskSpecを作成します
+ *
+ * @tparam StackSize StackSize[word]
+ * @param name Task名
+ * @param priority Task優先度
+ * @return constexpr RtosTaskSpec 
+ */
+template<size_t StackSize>
+constexpr RtosTaskSpec makeRtosTaskSpec(const char* name, uint32_t priority) {
+    return { name, StackSize, priority, (StackSize * sizeof(StackType_t)) + sizeof(StaticTask_t) };
+}
+
+/**
+ * @brief RtosQueueSpecを作成します
+ *
+ * @tparam Queue IpcQueueの型
+ * @tparam Depth 要素数
+ * @param name Queue名
+ * @param producer 送信するTask名
+ * @param consumer 受信するTask名
+ * @return constexpr RtosQueueSpec 
+ */
+template<typename Queue, size_t Depth>
+constexpr RtosQueueSpec makeRtosQueueSpec(const char* name, const char* producer, const char* consumer) {
+    return { name, sizeof(typename Queue::ValueType), Depth, Depth * sizeof(typename Queue::ValueType), producer, consumer };
+}
+
+/**
+ * @brief ProjectのTask/Queueの構成をコンパイル時に定義します
+ * @note Task/Queueはここで定義した領域に静的に確保され、FreeRTOS Heapは使用しません
+ *       合計がFixedConfig::RtosStaticRamBudgetを超える場合、またはQueueの送受信先が存在しないTaskの場合はビルドエラーになります
+ * @note TaskはStack+TCB, Queueは要素数x要素サイズで集計します。Idle Task/Timer Service TaskもvApplicationGet*TaskMemory()で静的に確保するので含めます
+ */
+namespace RtosTopology {
+    /****************************** Task ******************************/
+    static constexpr RtosTaskSpec GroveTaskSpec  = makeRtosTaskSpec<FixedConfig::GroveTaskStackSize>("GroveTask", configMAX_PRIORITIES - 2);
+    static constexpr RtosTaskSpec UiTaskSpec     = makeRtosTaskSpec<FixedConfig::UiTaskStackSize>("UiTask", configMAX_PRIORITIES - 1);
+    static constexpr RtosTaskSpec WifiTaskSpec   = makeRtosTaskSpec<FixedConfig::wifiTaskStackSize>("WifiTask", configMAX_PRIORITIES - 1); // UiTaskからの要求がなければ寝っぱなし
+    static constexpr RtosTaskSpec CoopExecutorSpec = makeRtosTaskSpec<FixedConfig::CoopExecutorStackSize>("CoopExecutor", configMAX_PRIORITIES - 2); // ButtonTask/LoggerTaskが相乗りする
+    static constexpr RtosTaskSpec SdTaskSpec     = makeRtosTaskSpec<FixedConfig::SdTaskStackSize>("SdTask", configMAX_PRIORITIES - 3);
+    static constexpr RtosTaskSpec TimerTaskSpec  = makeRtosTaskSpec<FixedConfig::TimerTaskStackSize>("TimerTask", configMAX_PRIORITIES - 1); // 期限を各Taskに渡すだけなので遅らせない
+    static constexpr RtosTaskSpec WatchdogTaskSpec = makeRtosTaskSpec<FixedConfig::WatchdogTaskStackSize>("WatchdogTask", configMAX_PRIORITIES - 1); // 他Taskが暴走していても監視できるよう最高優先度
+    static constexpr RtosTaskSpec IdleTaskSpec   = makeRtosTaskSpec<configMINIMAL_STACK_SIZE>("IDLE", 0); // FreeRTOSが作成する, 領域はvApplicationGetIdleTaskMemory()で渡す
+#if (configUSE_TIMERS == 1)
+    static constexpr RtosTaskSpec TimerServiceTaskSpec = makeRtosTaskSpec<configTIMER_TASK_STACK_DEPTH>("Tmr Svc", configTIMER_TASK_PRIORITY); // FreeRTOSが作成する, 領域はvApplicationGetTimerTaskMemory()で渡す
+#endif
+
+    static constexpr RtosTaskSpec Tasks[] = {
+        GroveTaskSpec,
+        UiTaskSpec,
+        WifiTaskSpec,
+        SdTaskSpec,
+        CoopExecutorSpec,
+        TimerTaskSpec,
+        WatchdogTaskSpec,
+        IdleTaskSpec,
+#if (configUSE_TIMERS == 1)
+        TimerServiceTaskSpec,
+#endif
+    };
+
+    /****************************** Queue ******************************/
+    using ButtonStateQueue  = PointToPointQueue<ButtonEventData>;
+    using WifiRequestQueue  = ZeroCopyQueue<WifiTaskRequest>; // loan/peekで直接読み書きする
+    using WifiResponseQueue = ZeroCopyQueue<WifiTaskResponse>;
+    using SdRequestQueue    = IpcQueue<SdRequest>; // 複数Taskから要求されるのでFreeRTOS Queueを使う
+    using CoopExecutor      = ::CoopExecutor<FixedConfig::CoopExecutorTaskMax>;
+
+    static constexpr RtosQueueSpec ButtonStateQueueSpec  = makeRtosQueueSpec<ButtonStateQueue, FixedConfig::DefaultQueueSize>("buttonStateQueue", "CoopExecutor", "UiTask"); // ButtonTask -> UiTask;
+    static constexpr RtosQueueSpec WifiRequestQueueSpec  = makeRtosQueueSpec<WifiRequestQueue, FixedConfig::DefaultQueueSize>("wifiRequestQueue", "UiTask", "WifiTask");
+    static constexpr RtosQueueSpec WifiResponseQueueSpec = makeRtosQueueSpec<WifiResponseQueue, FixedConfig::DefaultQueueSize>("wifiResponseQueue", "WifiTask", "UiTask");
+    static constexpr RtosQueueSpec SdRequestQueueSpec    = makeRtosQueueSpec<SdRequestQueue, FixedConfig::SdTaskQueueSize>("sdRequestQueue", "CoopExecutor", "SdTask"); // LoggerTask -> SdTask;
+
+    static constexpr RtosQueueSpec Queues[] = {
+        ButtonStateQueueSpec,
+        WifiRequestQueueSpec,
+        WifiResponseQueueSpec,
+        SdRequestQueueSpec,
+    };
+
+    /****************************** Budget ******************************/
+    /**
+     * @brief Taskの静的領域の合計を求めます
+     */
+    static constexpr size_t getTaskRamSize(void) {
+        size_t sum = 0;
+        for (const auto& t : Tasks) {
+            sum += t.storageSize;
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Queueの静的領域の合計を求めます
+     */
+    static constexpr size_t getQueueRamSize(void) {
+        size_t sum = 0;
+        for (const auto& q : Queues) {
+            sum += q.storageSize;
+        }
+        return sum;
+    }
+
+    /**
+     * @brief 文字列が一致するか判定します
+     */
+    static constexpr bool isSameName(const char* a, const char* b) {
+        while ((*a != '\0') && (*a == *b)) {
+            a++;
+            b++;
+        }
+        return (*a == *b);
+    }
+
+    /**
+     * @brief Task名が定義されているか判定します
+     */
+    static constexpr bool isTaskDefined(const char* name) {
+        for (const auto& t : Tasks) {
+            if (isSameName(t.name, name)) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief すべてのQueueの送受信先が定義済のTaskか判定します
+     */
+    static constexpr bool isAllQueueConnected(void) {
+        for (const auto& q : Queues) {
+            if (!isTaskDefined(q.producer) || !isTaskDefined(q.consumer)) return false;
+        }
+        return true;
+    }
+
+    static constexpr size_t TaskRamSize  = getTaskRamSize();  /**< Taskの静的領域の合計[byte] */
+    static constexpr size_t QueueRamSize = getQueueRamSize(); /**< Queueの静的領域の合計[byte] */
+    static constexpr size_t TotalRamSize = TaskRamSize + QueueRamSize; /**< 静的領域の合計[byte] */
+
+    static_assert(TotalRamSize <= FixedConfig::RtosStaticRamBudget, "RTOS static RAM exceeds FixedConfig::RtosStaticRamBudget");
+    static_assert(isAllQueueConnected(), "RtosTopology queue refers to an undefined task");
+}
+
+#endif /* RTOSTOPOLOGY_H */
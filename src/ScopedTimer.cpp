@@ -0,0 +1,5 @@
+#include "ScopedTimer.h"
+
+#ifdef WFH_MONITOR_ENABLE_SCOPED_TIMER
+ScopedTimerStats* ScopedTimerStats::registryHead = nullptr;
+#endif
@@ -0,0 +1,192 @@
+#ifndef SCOPEDTIMER_H
+#define SCOPEDTIMER_H
+
+#include <cstdint>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "SysTimer.h"
+
+/**
+ * @brief 計測区間の処理時間の統計です
+ */
+struct ScopedTimerProfile {
+    uint32_t count;  /**< 計測回数 */
+    uint32_t minUs;  /**< 最小処理時間 */
+    uint32_t meanUs; /**< 平均処理時間 */
+    uint32_t maxUs;  /**< 最大処理時間 */
+    uint32_t lastUs; /**< 直近の処理時間 */
+};
+
+/**
+ * @brief ScopedTimerProfileを出力します
+ *
+ * @tparam P print, printlnが使えるclass
+ * @param oStream 出力先
+ * @param name 計測区間名
+ * @param profile 出力する統計
+ */
+template<typename P>
+static void printScopedTimerProfile(P& oStream, const char* name, const ScopedTimerProfile& profile) {
+    oStream.print("[timer] ");
+    oStream.print(name);
+    oStream.print(" count=");
+    oStream.print(profile.count);
+    oStream.print(" min/mean/max/last=");
+    oStream.print(profile.minUs);
+    oStream.print("/");
+    oStream.print(profile.meanUs);
+    oStream.print("/");
+    oStream.print(profile.maxUs);
+    oStream.print("/");
+    oStream.print(profile.lastUs);
+    oStream.println("[us]");
+}
+
+#ifdef WFH_MONITOR_ENABLE_SCOPED_TIMER
+
+/**
+ * @brief 計測区間ごとの処理時間をCPU Cycle単位で集計します
+ * @note 関数内のstatic変数として定義してください。constexprで初期化されるので、初回呼び出し時の排他は不要です
+ * @note 最初に計測した時点でRegistryに登録され、forEach()で列挙できます
+ */
+class ScopedTimerStats {
+    public:
+        /**
+         * @brief Construct a new Scoped Timer Stats object
+         *
+         * @param name 計測区間名, 文字列リテラルを指定してください
+         */
+        constexpr ScopedTimerStats(const char* name): name(name), count(0), sumCycle(0), minCycle(UINT32_MAX), maxCycle(0), lastCycle(0), isRegistered(false), registryNext(nullptr) {}
+
+        /**
+         * @brief 1回分の処理時間を記録します
+         *
+         * @param cycle 処理時間[cycle]
+         */
+        void add(uint32_t cycle) {
+            taskENTER_CRITICAL();
+            {
+                if (!this->isRegistered) {
+                    this->registryNext = registryHead;
+                    registryHead = this;
+                    this->isRegistered = true;
+                }
+                this->count++;
+                this->sumCycle += cycle;
+                if (cycle < this->minCycle) this->minCycle = cycle;
+                if (cycle > this->maxCycle) this->maxCycle = cycle;
+                this->lastCycle = cycle;
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * @brief 起動以降の統計を取得します
+         *
+         * @param dst 統計の書き込み先
+         * @return true 取得成功
+         */
+        bool get(ScopedTimerProfile& dst) {
+            taskENTER_CRITICAL();
+            const uint32_t count = this->count;
+            const uint64_t sumCycle = this->sumCycle;
+            const uint32_t minCycle = this->minCycle;
+            const uint32_t maxCycle = this->maxCycle;
+            const uint32_t lastCycle = this->lastCycle;
+            taskEXIT_CRITICAL();
+
+            dst.count = count;
+            dst.minUs = (count > 0) ? SysTimer::cycleToUs(minCycle) : 0;
+            dst.meanUs = (count > 0) ? SysTimer::cycleToUs(static_cast<uint32_t>(sumCycle / count)) : 0;
+            dst.maxUs = SysTimer::cycleToUs(maxCycle);
+            dst.lastUs = SysTimer::cycleToUs(lastCycle);
+            return true;
+        }
+
+        /**
+         * @brief 計測区間名を取得します
+         */
+        const char* getName(void) const {
+            return this->name;
+        }
+
+        /**
+         * @brief 登録済のすべての計測区間を列挙します
+         *
+         * @tparam F void(ScopedTimerStats&) の型に一致する関数
+         * @param functor 各計測区間に対して呼び出す関数
+         */
+        template<typename F>
+        static void forEach(F functor) {
+            for (ScopedTimerStats* s = registryHead; s != nullptr; s = s->registryNext) {
+                functor(*s);
+            }
+        }
+
+    protected:
+        const char* name;   /**< 計測区間名 */
+        uint32_t count;     /**< 計測回数 */
+        uint64_t sumCycle;  /**< 処理時間の合計 */
+        uint32_t minCycle;  /**< 最小処理時間 */
+        uint32_t maxCycle;  /**< 最大処理時間 */
+        uint32_t lastCycle; /**< 直近の処理時間 */
+        bool isRegistered;  /**< Registryに登録済ならtrue */
+        ScopedTimerStats* registryNext; /**< Registryの次の要素 */
+
+        static ScopedTimerStats* registryHead; /**< Registryの先頭 */
+};
+
+/**
+ * @brief 生成からscopeを抜けるまでの処理時間をScopedTimerStatsに記録します
+ */
+class ScopedTimer {
+    public:
+        /**
+         * @brief 計測を開始します
+         *
+         * @param stats 記録先
+         */
+        ScopedTimer(ScopedTimerStats& stats): stats(stats), startCycle(SysTimer::getCycleCount()) {}
+
+        /**
+         * @brief 計測を終了して記録します
+         */
+        ~ScopedTimer(void) {
+            this->stats.add(SysTimer::diff(this->startCycle, SysTimer::getCycleCount()));
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    protected:
+        ScopedTimerStats& stats; /**< 記録先 */
+        uint32_t startCycle;     /**< 計測開始時のCycle Counter */
+};
+
+#else
+
+/**
+ * @brief WFH_MONITOR_ENABLE_SCOPED_TIMERが未定義の場合は何も記録しません
+ */
+class ScopedTimerStats {
+    public:
+        constexpr ScopedTimerStats(const char* name) {}
+        void add(uint32_t cycle) {}
+        bool get(ScopedTimerProfile& dst) { return false; }
+        const char* getName(void) const { return ""; }
+        template<typename F>
+        static void forEach(F functor) {}
+};
+
+/**
+ * @brief WFH_MONITOR_ENABLE_SCOPED_TIMERが未定義の場合は何も記録しません
+ */
+class ScopedTimer {
+    public:
+        ScopedTimer(ScopedTimerStats& stats) {}
+};
+
+#endif /* WFH_MONITOR_ENABLE_SCOPED_TIMER */
+
+#endif /* SCOPEDTIMER_H */
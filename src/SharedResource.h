@@ -5,9 +5,15 @@
 
 #include <Seeed_Arduino_FreeRTOS.h>
 
+#include "SysTimer.h"
+#include "TaskBase.h"
+#include "SharedResourceStats.h"
+
 /**
  * @brief Task間共有リソースを定義します
  * @note IpcQueue.h同様 CPU DataCacheの影響を考慮した配置を行ってください
+ * @note WFH_MONITOR_ENABLE_SHARED_RESOURCE_STATSを定義した場合はLockの待ち時間/保持時間を記録します
+ * @note 獲得待ち/保持中はTaskBaseに記録され、WatchdogTaskはその間Taskを作り直しません
  * 
  * @tparam T 共有リソースの型
  */
@@ -18,9 +24,14 @@ class SharedResource {
          * @brief Construct a new Shared Resource object
          * 
          * @param v 管理するデータ。NonCache 属性またはWriteBackが保証される領域に配置されることが望ましいです
+         * @param name 統計出力時に表示するリソース名
          */
-        SharedResource(T& v) : value(v) {
+        SharedResource(T& v, const char* name = nullptr) : value(v), name(name) {
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+            this->semaphoreHandle = xSemaphoreCreateMutexStatic(&this->semaphoreBuffer);
+#else
             this->semaphoreHandle = xSemaphoreCreateMutex();
+#endif
         }
 
         /**
@@ -36,11 +47,45 @@ class SharedResource {
          */
         template<class F>
         void operate(F functor) {
+            TaskBase::beginSharedLock();
+            auto stamp = this->stats.beforeAcquire();
             xSemaphoreTake(this->semaphoreHandle, portMAX_DELAY);
+            this->stats.afterAcquire(stamp, true, true);
             {
                 functor(this->value);
             }
+            this->stats.beforeRelease(stamp, true);
             xSemaphoreGive(this->semaphoreHandle);
+            TaskBase::endSharedLock();
+        }
+
+        /**
+         * @brief 指定時間内にリソースロックできた場合のみデータを操作します
+         * @note 処理が遅れるくらいなら諦めたいTaskから使用します
+         * 
+         * @tparam F void(T&) の型に一致する関数
+         * @param timeoutMs セマフォ獲得の最大待ち時間[ms]
+         * @param functor 処理関数
+         * @return true 操作した
+         * @return false timeoutしたので操作していない
+         */
+        template<class F>
+        bool tryOperate(uint32_t timeoutMs, F functor) {
+            TaskBase::beginSharedLock();
+            auto stamp = this->stats.beforeAcquire();
+            const bool isAcquired = (xSemaphoreTake(this->semaphoreHandle, SysTimer::msToTick(timeoutMs)) == pdTRUE);
+            this->stats.afterAcquire(stamp, isAcquired, true);
+            if (!isAcquired) {
+                TaskBase::endSharedLock();
+                return false;
+            }
+            {
+                functor(this->value);
+            }
+            this->stats.beforeRelease(stamp, true);
+            xSemaphoreGive(this->semaphoreHandle);
+            TaskBase::endSharedLock();
+            return true;
         }
 
         /**
@@ -52,17 +97,63 @@ class SharedResource {
          */
         template<class F>
         void operateCritial(F functor) {
+            TaskBase::beginSharedLock();
+            auto stamp = this->stats.beforeAcquire();
             xSemaphoreTake(this->semaphoreHandle, portMAX_DELAY);
+            this->stats.afterAcquire(stamp, true, true);
             taskENTER_CRITICAL();
             {
                 functor(this->value);
             }
             taskEXIT_CRITICAL();
+            this->stats.beforeRelease(stamp, true);
             xSemaphoreGive(this->semaphoreHandle);
+            TaskBase::endSharedLock();
         }
+
+        /**
+         * @brief Lock競合統計を取得します
+         * 
+         * @param dst 統計の書き込み先
+         * @return true 取得成功
+         * @return false WFH_MONITOR_ENABLE_SHARED_RESOURCE_STATSが未定義
+         */
+        bool getStats(SharedResourceStats& dst) {
+            return this->stats.get(dst);
+        }
+
+        /**
+         * @brief Lock競合統計をクリアします
+         */
+        void clearStats(void) {
+            this->stats.clear();
+        }
+
+        /**
+         * @brief Lock競合統計を出力します
+         * @note 出力先自体がSharedResourceの場合は、そのロックを獲得した上で呼び出してください
+         * 
+         * @tparam P print, printlnが使えるclass
+         * @param oStream 出力先
+         * @return true 出力した
+         * @return false WFH_MONITOR_ENABLE_SHARED_RESOURCE_STATSが未定義
+         */
+        template<class P>
+        bool printStats(P& oStream) {
+            SharedResourceStats dst;
+            if (!this->getStats(dst)) return false;
+            printSharedResourceStats(oStream, this->name, dst);
+            return true;
+        }
+
     protected:
         SemaphoreHandle_t semaphoreHandle;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+        StaticSemaphore_t semaphoreBuffer; /**< FreeRTOS Heapを使わずにSemaphoreを作成する領域 */
+#endif
         T& value;
+        const char* name; /**< 統計出力時に表示するリソース名 */
+        SharedResourceStatsRecorder stats; /**< Lock競合統計 */
 };
 
 #endif /* SHAREDRESOURCE_H */
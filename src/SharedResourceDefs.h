@@ -9,15 +9,16 @@
 #include "GlobalConfig.h"
 #include "FixedConfig.h"
 #include "SharedResource.h"
+#include "SharedRwResource.h"
 
 /**
  * @brief Project上固有のリソースで、複数のTaskから操作されるものを定義します
- * @note インスタンスは必ずSharedResourceでラップしたものを定義してください
+ * @note インスタンスは必ずSharedResource/SharedRwResourceでラップしたものを定義してください
  */
 struct SharedResourceDefs {
     SharedResource<Serial_>& serial;
     SharedResource<SDFS>& sd;
-    SharedResource<GlobalConfig<FixedConfig::ConfigAllocateSize>>& config;
+    SharedRwResource<GlobalConfig<FixedConfig::ConfigAllocateSize>>& config;
 };
 
 #endif /* SHAREDRESOURCEDEFS_H */
\ No newline at end of file
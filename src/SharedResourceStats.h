@@ -0,0 +1,218 @@
+#ifndef SHAREDRESOURCESTATS_H
+#define SHAREDRESOURCESTATS_H
+
+#include <cstdint>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "SysTimer.h"
+
+/**
+ * @brief SharedResourceStatsのHistogramのbin数です
+ * @note bin[0]は0tick, bin[i]は[2^(i-1), 2^i)tick, 最後のbinはそれ以上をすべて含みます
+ */
+static constexpr size_t SharedResourceStatsBinNum = 12;
+
+/**
+ * @brief SharedResourceのLock競合統計です
+ */
+struct SharedResourceStats {
+    uint32_t acquireNum;  /**< Lockを獲得した回数 */
+    uint32_t timeoutNum;  /**< tryOperateでLockを獲得できなかった回数 */
+    uint32_t maxWaitTick; /**< Lock獲得までの最大待ち時間 */
+    uint32_t maxHoldTick; /**< Lockの最大保持時間 */
+    const char* ownerName;        /**< 現在Lockを保持しているTask名, 保持されていなければnullptr */
+    const char* maxWaitTaskName;  /**< 最大待ち時間を記録したTask名 */
+    const char* maxHoldTaskName;  /**< 最大保持時間を記録したTask名 */
+    uint32_t waitHistogram[SharedResourceStatsBinNum]; /**< Lock獲得までの待ち時間の分布 */
+    uint32_t holdHistogram[SharedResourceStatsBinNum]; /**< Lockの保持時間の分布 */
+};
+
+/**
+ * @brief SharedResourceStatsを出力します
+ *
+ * @tparam P print, printlnが使えるclass
+ * @param oStream 出力先
+ * @param name リソース名
+ * @param stats 出力する統計
+ */
+template<typename P>
+static void printSharedResourceStats(P& oStream, const char* name, const SharedResourceStats& stats) {
+    oStream.print("[lock] ");
+    oStream.print((name != nullptr) ? name : "-");
+    oStream.print(" acquire=");
+    oStream.print(stats.acquireNum);
+    oStream.print(" timeout=");
+    oStream.print(stats.timeoutNum);
+    oStream.print(" owner=");
+    oStream.print((stats.ownerName != nullptr) ? stats.ownerName : "-");
+    oStream.print(" maxWait=");
+    oStream.print(stats.maxWaitTick);
+    oStream.print("(");
+    oStream.print((stats.maxWaitTaskName != nullptr) ? stats.maxWaitTaskName : "-");
+    oStream.print(") maxHold=");
+    oStream.print(stats.maxHoldTick);
+    oStream.print("(");
+    oStream.print((stats.maxHoldTaskName != nullptr) ? stats.maxHoldTaskName : "-");
+    oStream.println(")");
+    // bin単位で出力, [2^(i-1), 2^i)tick
+    oStream.print("  wait:");
+    for (size_t i = 0; i < SharedResourceStatsBinNum; i++) {
+        oStream.print(" ");
+        oStream.print(stats.waitHistogram[i]);
+    }
+    oStream.println("");
+    oStream.print("  hold:");
+    for (size_t i = 0; i < SharedResourceStatsBinNum; i++) {
+        oStream.print(" ");
+        oStream.print(stats.holdHistogram[i]);
+    }
+    oStream.println("");
+}
+
+#ifdef WFH_MONITOR_ENABLE_SHARED_RESOURCE_STATS
+
+/**
+ * @brief SharedResourceのLock競合統計を記録します
+ * @note 読み出しLockのように複数Taskから同時に記録される場合があるので、更新は短いCritical Sectionで行います
+ */
+class SharedResourceStatsRecorder {
+    public:
+        /**
+         * @brief Lock獲得の記録に使う値です
+         */
+        typedef uint32_t Stamp;
+
+        /**
+         * @brief Construct a new Shared Resource Stats Recorder object
+         */
+        SharedResourceStatsRecorder(void) {
+            this->clear();
+        }
+
+        /**
+         * @brief 統計をクリアします
+         */
+        void clear(void) {
+            taskENTER_CRITICAL();
+            {
+                this->stats.acquireNum = 0;
+                this->stats.timeoutNum = 0;
+                this->stats.maxWaitTick = 0;
+                this->stats.maxHoldTick = 0;
+                this->stats.ownerName = nullptr;
+                this->stats.maxWaitTaskName = nullptr;
+                this->stats.maxHoldTaskName = nullptr;
+                for (size_t i = 0; i < SharedResourceStatsBinNum; i++) {
+                    this->stats.waitHistogram[i] = 0;
+                    this->stats.holdHistogram[i] = 0;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * @brief Lock獲得を試みる直前に呼び出します
+         *
+         * @return Stamp 以後の記録に渡す値
+         */
+        Stamp beforeAcquire(void) {
+            return SysTimer::getTickCount();
+        }
+
+        /**
+         * @brief Lock獲得の結果を記録します
+         *
+         * @param stamp beforeAcquire()の戻り値, 獲得できた場合は保持時間の計測用に更新されます
+         * @param isAcquired Lockを獲得できたか
+         * @param isExclusive 排他Lockならtrue, 保持Taskとして記録します
+         */
+        void afterAcquire(Stamp& stamp, bool isAcquired, bool isExclusive) {
+            const uint32_t now = SysTimer::getTickCount();
+            const uint32_t waitTick = SysTimer::diff(stamp, now);
+            const char* taskName = pcTaskGetName(nullptr);
+            taskENTER_CRITICAL();
+            {
+                if (isAcquired) {
+                    this->stats.acquireNum++;
+                    if (isExclusive) this->stats.ownerName = taskName;
+                } else {
+                    this->stats.timeoutNum++;
+                }
+                this->stats.waitHistogram[tickToBin(waitTick)]++;
+                if (waitTick > this->stats.maxWaitTick) {
+                    this->stats.maxWaitTick = waitTick;
+                    this->stats.maxWaitTaskName = taskName;
+                }
+            }
+            taskEXIT_CRITICAL();
+            stamp = now;
+        }
+
+        /**
+         * @brief Lock解放直前に呼び出し、保持時間を記録します
+         *
+         * @param stamp afterAcquire()で更新された値
+         * @param isExclusive 排他Lockならtrue
+         */
+        void beforeRelease(Stamp stamp, bool isExclusive) {
+            const uint32_t holdTick = SysTimer::diff(stamp, SysTimer::getTickCount());
+            const char* taskName = pcTaskGetName(nullptr);
+            taskENTER_CRITICAL();
+            {
+                if (isExclusive) this->stats.ownerName = nullptr;
+                this->stats.holdHistogram[tickToBin(holdTick)]++;
+                if (holdTick > this->stats.maxHoldTick) {
+                    this->stats.maxHoldTick = holdTick;
+                    this->stats.maxHoldTaskName = taskName;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * @brief 現在の統計を取得します
+         *
+         * @param dst 統計の書き込み先
+         * @return true 取得成功
+         */
+        bool get(SharedResourceStats& dst) {
+            taskENTER_CRITICAL();
+            {
+                dst = this->stats;
+            }
+            taskEXIT_CRITICAL();
+            return true;
+        }
+
+    protected:
+        SharedResourceStats stats;
+
+        /**
+         * @brief tick数からHistogramのbinを求めます
+         */
+        static size_t tickToBin(uint32_t tick) {
+            if (tick == 0) return 0;
+            const size_t bin = 32 - __builtin_clz(tick);
+            return (bin < SharedResourceStatsBinNum) ? bin : (SharedResourceStatsBinNum - 1);
+        }
+};
+
+#else
+
+/**
+ * @brief WFH_MONITOR_ENABLE_SHARED_RESOURCE_STATSが未定義の場合は何も記録しません
+ */
+class SharedResourceStatsRecorder {
+    public:
+        typedef uint32_t Stamp;
+        void clear(void) {}
+        Stamp beforeAcquire(void) { return 0; }
+        void afterAcquire(Stamp& stamp, bool isAcquired, bool isExclusive) {}
+        void beforeRelease(Stamp stamp, bool isExclusive) {}
+        bool get(SharedResourceStats& dst) { return false; }
+};
+
+#endif /* WFH_MONITOR_ENABLE_SHARED_RESOURCE_STATS */
+
+#endif /* SHAREDRESOURCESTATS_H */
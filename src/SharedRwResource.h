@@ -0,0 +1,217 @@
+#ifndef SHAREDRWRESOURCE_H
+#define SHAREDRWRESOURCE_H
+
+#include <cstdint>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "TaskBase.h"
+#include "SharedResourceStats.h"
+
+/**
+ * @brief 読み出しが大半を占めるTask間共有リソースを定義します
+ * @note 読み出し同士は同時に実行でき、書き込みは排他的に実行されます。書き込み待ちがある間は新しい読み出しを待たせます(Writer優先)
+ * @note IpcQueue.h同様 CPU DataCacheの影響を考慮した配置を行ってください
+ * @note WFH_MONITOR_ENABLE_SHARED_RESOURCE_STATSを定義した場合はSharedResource同様Lockの待ち時間/保持時間を記録します
+ * @note SharedResource同様、獲得待ち/保持中はTaskBaseに記録されます
+ *
+ * @tparam T 共有リソースの型
+ */
+template<typename T>
+class SharedRwResource {
+    public:
+        /**
+         * @brief Construct a new Shared Rw Resource object
+         *
+         * @param v 管理するデータ。NonCache 属性またはWriteBackが保証される領域に配置されることが望ましいです
+         * @param name 統計出力時に表示するリソース名
+         */
+        SharedRwResource(T& v, const char* name = nullptr) : value(v), name(name), readerNum(0), readerWaitNum(0), writerWaitNum(0), isWriting(false) {
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+            this->readGate = xSemaphoreCreateCountingStatic(GateMaxCount, 0, &this->readGateBuffer);
+            this->writeGate = xSemaphoreCreateCountingStatic(GateMaxCount, 0, &this->writeGateBuffer);
+#else
+            this->readGate = xSemaphoreCreateCounting(GateMaxCount, 0);
+            this->writeGate = xSemaphoreCreateCounting(GateMaxCount, 0);
+#endif
+        }
+
+        /**
+         * @brief Destroy the Shared Rw Resource object
+         */
+        virtual ~SharedRwResource(void) {}
+
+        /**
+         * @brief 共有ロックした上でデータを読み出します。他の読み出しとは同時に実行されます
+         *
+         * @tparam F void(const T&) の型に一致する関数
+         * @param functor 処理関数
+         */
+        template<class F>
+        void read(F functor) {
+            TaskBase::beginSharedLock();
+            auto stamp = this->stats.beforeAcquire();
+            this->lockShared();
+            this->stats.afterAcquire(stamp, true, false);
+            {
+                functor(static_cast<const T&>(this->value));
+            }
+            this->stats.beforeRelease(stamp, false);
+            this->unlockShared();
+            TaskBase::endSharedLock();
+        }
+
+        /**
+         * @brief 排他ロックした上でデータを操作します。実行中のすべての読み出しが終わるまで待機します
+         *
+         * @tparam F void(T&) の型に一致する関数
+         * @param functor 処理関数
+         */
+        template<class F>
+        void write(F functor) {
+            TaskBase::beginSharedLock();
+            auto stamp = this->stats.beforeAcquire();
+            this->lockExclusive();
+            this->stats.afterAcquire(stamp, true, true);
+            {
+                functor(this->value);
+            }
+            this->stats.beforeRelease(stamp, true);
+            this->unlockExclusive();
+            TaskBase::endSharedLock();
+        }
+
+        /**
+         * @brief Lock競合統計を取得します。読み出し/書き込みの合算です
+         *
+         * @param dst 統計の書き込み先
+         * @return true 取得成功
+         * @return false WFH_MONITOR_ENABLE_SHARED_RESOURCE_STATSが未定義
+         */
+        bool getStats(SharedResourceStats& dst) {
+            return this->stats.get(dst);
+        }
+
+        /**
+         * @brief Lock競合統計をクリアします
+         */
+        void clearStats(void) {
+            this->stats.clear();
+        }
+
+        /**
+         * @brief Lock競合統計を出力します
+         *
+         * @tparam P print, printlnが使えるclass
+         * @param oStream 出力先
+         * @return true 出力した
+         * @return false WFH_MONITOR_ENABLE_SHARED_RESOURCE_STATSが未定義
+         */
+        template<class P>
+        bool printStats(P& oStream) {
+            SharedResourceStats dst;
+            if (!this->getStats(dst)) return false;
+            printSharedResourceStats(oStream, this->name, dst);
+            return true;
+        }
+
+    protected:
+        T& value;
+        const char* name;       /**< 統計出力時に表示するリソース名 */
+        SharedResourceStatsRecorder stats; /**< Lock競合統計 */
+        uint32_t readerNum;     /**< 読み出し中のTask数 */
+        uint32_t readerWaitNum; /**< 読み出し待ちのTask数 */
+        uint32_t writerWaitNum; /**< 書き込み待ちのTask数 */
+        bool isWriting;         /**< 書き込み中ならtrue */
+
+        /**
+         * @brief 待機Taskを起こすSemaphoreの最大値, 同時に待機しうるTask数以上にしておく
+         */
+        static constexpr UBaseType_t GateMaxCount = 16;
+
+        SemaphoreHandle_t readGate;  /**< 読み出し待ちのTaskを起こす */
+        SemaphoreHandle_t writeGate; /**< 書き込み待ちのTaskを起こす */
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+        StaticSemaphore_t readGateBuffer;  /**< FreeRTOS Heapを使わずにreadGateを作成する領域 */
+        StaticSemaphore_t writeGateBuffer; /**< FreeRTOS Heapを使わずにwriteGateを作成する領域 */
+#endif
+
+        void lockShared(void) {
+            while (true) {
+                bool isAcquired = false;
+                taskENTER_CRITICAL();
+                {
+                    if (!this->isWriting && (this->writerWaitNum == 0)) {
+                        this->readerNum++;
+                        isAcquired = true;
+                    } else {
+                        this->readerWaitNum++;
+                    }
+                }
+                taskEXIT_CRITICAL();
+                if (isAcquired) return;
+                // 書き込みが終わるまで待って再確認
+                xSemaphoreTake(this->readGate, portMAX_DELAY);
+            }
+        }
+
+        void unlockShared(void) {
+            bool isWakeWriter = false;
+            taskENTER_CRITICAL();
+            {
+                this->readerNum--;
+                isWakeWriter = (this->readerNum == 0) && (this->writerWaitNum > 0);
+            }
+            taskEXIT_CRITICAL();
+            if (isWakeWriter) {
+                xSemaphoreGive(this->writeGate);
+            }
+        }
+
+        void lockExclusive(void) {
+            bool isWaiting = false;
+            while (true) {
+                bool isAcquired = false;
+                taskENTER_CRITICAL();
+                {
+                    if (!this->isWriting && (this->readerNum == 0)) {
+                        this->isWriting = true;
+                        if (isWaiting) this->writerWaitNum--;
+                        isAcquired = true;
+                    } else if (!isWaiting) {
+                        // 以後の読み出しを待たせる
+                        this->writerWaitNum++;
+                        isWaiting = true;
+                    }
+                }
+                taskEXIT_CRITICAL();
+                if (isAcquired) return;
+                // 読み出し/書き込みが終わるまで待って再確認
+                xSemaphoreTake(this->writeGate, portMAX_DELAY);
+            }
+        }
+
+        void unlockExclusive(void) {
+            bool isWakeWriter = false;
+            uint32_t wakeReaderNum = 0;
+            taskENTER_CRITICAL();
+            {
+                this->isWriting = false;
+                if (this->writerWaitNum > 0) {
+                    isWakeWriter = true;
+                } else {
+                    wakeReaderNum = this->readerWaitNum;
+                    this->readerWaitNum = 0;
+                }
+            }
+            taskEXIT_CRITICAL();
+            if (isWakeWriter) {
+                xSemaphoreGive(this->writeGate);
+            }
+            for (uint32_t i = 0; i < wakeReaderNum; i++) {
+                xSemaphoreGive(this->readGate);
+            }
+        }
+};
+
+#endif /* SHAREDRWRESOURCE_H */
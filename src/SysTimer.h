@@ -3,6 +3,7 @@
 
 #include <cstdint>
 
+#include <Arduino.h>
 #include <Seeed_Arduino_FreeRTOS.h>
 
 /**
@@ -18,17 +19,98 @@ namespace SysTimer {
         return xTaskGetTickCount();
     }
 
+    /**
+     * @brief 起動以降の経過時間をus単位で取得します
+     * @note Systickより細かい処理時間の計測に使います。約71分で1周します
+     * 
+     * @return uint32_t 
+     */
+    static uint32_t getMicroCount(void) {
+        return micros();
+    }
+
+    /**
+     * @brief FreeRTOSのスケジューラ開始以降のSystickを64bitで取得します
+     * @note FreeRTOSが管理しているTickのOverflow回数と組み合わせるので、呼び出し間隔によらず周回しません
+     * 
+     * @return uint64_t 
+     */
+    static uint64_t getTickCount64(void) {
+        TimeOut_t timeOut;
+        vTaskSetTimeOutState(&timeOut);
+        return (static_cast<uint64_t>(timeOut.xOverflowCount) << 32) | static_cast<uint32_t>(timeOut.xTimeOnEntering);
+    }
+
+    /**
+     * @brief 起動以降の経過時間をus単位で64bitで取得します
+     * @note getMicroCount()の値を、getTickCount64()から求めた現在時刻に最も近くなるよう上位bitを補って拡張します
+     *       2つの時計のずれが約35分未満であれば正しく拡張されます
+     * 
+     * @return uint64_t 
+     */
+    static uint64_t getMicroCount64(void) {
+        const uint64_t approxUs = getTickCount64() * portTICK_RATE_MS * 1000;
+        const uint32_t nowUs = getMicroCount();
+        const int32_t offsetUs = static_cast<int32_t>(nowUs - static_cast<uint32_t>(approxUs));
+        return approxUs + offsetUs;
+    }
+
+    /**
+     * @brief getCycleCount()の周波数[Hz]
+     */
+#if defined(__SAMD51__)
+    static constexpr uint32_t CycleCountHz = F_CPU;
+#else
+    static constexpr uint32_t CycleCountHz = 1000000;
+#endif
+
+    /**
+     * @brief getCycleCount()を使用可能にします。setup()で一度だけ呼び出してください
+     * @note SAMD51ではDWTのCycle Counterを有効化します。それ以外ではgetMicroCount()を使うので何もしません
+     */
+    static void beginCycleCount(void) {
+#if defined(__SAMD51__)
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    }
+
+    /**
+     * @brief CPU Cycle単位のCounterを取得します
+     * @note SAMD51ではDWT CYCCNT(120MHzで約35秒で1周)、それ以外ではgetMicroCount()の値です
+     *       短い区間の処理時間の計測に使い、差分はdiff()で求めてください
+     * 
+     * @return uint32_t 
+     */
+    static uint32_t getCycleCount(void) {
+#if defined(__SAMD51__)
+        return DWT->CYCCNT;
+#else
+        return getMicroCount();
+#endif
+    }
+
+    /**
+     * @brief getCycleCount()の差分をus単位に変換します
+     * 
+     * @param cycle getCycleCount()の差分
+     * @return uint32_t us
+     */
+    static uint32_t cycleToUs(uint32_t cycle) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(cycle) * 1000000) / CycleCountHz);
+    }
+
     /**
      * @brief 2つの時間差分をOverflow考慮で計算します
-     * @remark 1週してもとのTickを追い越した場合の検知はできません
+     * @remark 1週してもとのTickを追い越した場合の検知はできません。約49日を超える差分はgetTickCount64()の値で求めてください
      * 
      * @param startTick 開始地点
      * @param endTick 終了地点
      * @return uint32_t 差分のTick
      */
     static uint32_t diff(uint32_t startTick, uint32_t endTick) {
-        return (startTick < endTick) ? (endTick - startTick) // 通常ケース
-                                     : (UINT32_MAX - startTick + endTick); // 裏回った場合
+        return endTick - startTick; // 裏回った場合もuint32_tの剰余演算で正しい差分になる
     }
 
     /**
@@ -78,6 +160,26 @@ namespace SysTimer {
     static uint32_t msToTick(T ms) {
         return static_cast<T>(ms * portTICK_RATE_MS);
     }
+
+    /**
+     * @brief 64bitのTickCountやus単位の時刻を10進数で出力します
+     * @note printfの%lluやprint(uint64_t)に対応していない環境向けです
+     * 
+     * @tparam P printが使えるclass
+     * @param oStream 出力先
+     * @param value 出力する値
+     */
+    template<typename P>
+    static void print64(P& oStream, uint64_t value) {
+        char buffer[21];
+        size_t index = sizeof(buffer) - 1;
+        buffer[index] = '\0';
+        do {
+            buffer[--index] = static_cast<char>('0' + (value % 10));
+            value /= 10;
+        } while (value > 0);
+        oStream.print(&buffer[index]);
+    }
 }
 
 #endif /* SYSTIMER_H */
\ No newline at end of file
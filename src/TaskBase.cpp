@@ -1,13 +1,51 @@
 #include "TaskBase.h"
 
+TaskBase* TaskBase::registryHead = nullptr;
+
+void TaskBase::registerSelf(void) {
+    taskENTER_CRITICAL();
+    {
+        this->registryNext = registryHead;
+        registryHead = this;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void TaskBase::unregisterSelf(void) {
+    taskENTER_CRITICAL();
+    {
+        for (TaskBase** p = &registryHead; *p != nullptr; p = &(*p)->registryNext) {
+            if (*p == this) {
+                *p = this->registryNext;
+                break;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+TaskBase* TaskBase::findCurrent(void) {
+    const TaskHandle_t current = xTaskGetCurrentTaskHandle();
+    for (TaskBase* t = registryHead; t != nullptr; t = t->registryNext) {
+        if (t->taskHandle == current) return t;
+    }
+    return nullptr;
+}
+
 void TaskBase::createTask(size_t stackSize, uint32_t priority) {
     // already running
     if (this->isRunning) return;
 
+    this->createStackSize = stackSize;
+    this->createPriority = priority;
+    this->createStack = nullptr;
+    this->createTcb = nullptr;
     this->isRunning = true;
     xTaskCreate(
         [](void* pvParameter){
             TaskBase* this_ptr = static_cast<TaskBase*>(pvParameter);
+            // 作成元にHandleが返る前に共有ロックを取る場合に備え、findCurrent()で見つかるようにしておく
+            this_ptr->taskHandle = xTaskGetCurrentTaskHandle();
             this_ptr->taskMain();
         },
         this->getName(),
@@ -18,6 +56,31 @@ void TaskBase::createTask(size_t stackSize, uint32_t priority) {
     );
 }
 
+void TaskBase::createTaskStatic(StackType_t* stack, size_t stackSize, StaticTask_t* tcb, uint32_t priority) {
+    // already running
+    if (this->isRunning) return;
+
+    this->createStackSize = stackSize;
+    this->createPriority = priority;
+    this->createStack = stack;
+    this->createTcb = tcb;
+    this->isRunning = true;
+    this->taskHandle = xTaskCreateStatic(
+        [](void* pvParameter){
+            TaskBase* this_ptr = static_cast<TaskBase*>(pvParameter);
+            // 作成元にHandleが返る前に共有ロックを取る場合に備え、findCurrent()で見つかるようにしておく
+            this_ptr->taskHandle = xTaskGetCurrentTaskHandle();
+            this_ptr->taskMain();
+        },
+        this->getName(),
+        stackSize,
+        this,
+        priority,
+        stack,
+        tcb
+    );
+}
+
 void TaskBase::deleteTask(void) {
     // task is not running
     if (!this->isRunning) return;
@@ -26,6 +89,30 @@ void TaskBase::deleteTask(void) {
     vTaskDelete(this->taskHandle);
 }
 
+bool TaskBase::restartTask(void) {
+    // task is not running
+    if (!this->isRunning) return false;
+
+    // 確認してから削除するまでの間に共有ロックを取られないよう、Schedulerを止めておく
+    vTaskSuspendAll();
+    if (this->getHeldLockNum() > 0) {
+        xTaskResumeAll();
+        return false;
+    }
+    vTaskDelete(this->taskHandle);
+    this->isRunning = false;
+    this->isHeartbeatArmed = false;
+    xTaskResumeAll();
+
+    // 作成時と同じ引数で作り直す
+    if (this->createStack != nullptr) {
+        this->createTaskStatic(this->createStack, this->createStackSize, this->createTcb, this->createPriority);
+        return true;
+    }
+    this->createTask(this->createStackSize, this->createPriority);
+    return true;
+}
+
 TaskHandle_t TaskBase::getTaskHandle(void) { 
     return this->taskHandle;
 }
@@ -35,7 +122,10 @@ void TaskBase::taskMain(void) {
 
     setup();
     do {
+        this->profiler.beginLoop();
         isAbort = loop();
+        this->profiler.endLoop();
+        this->beat(0);
     } while(!isAbort);
 
     // delete itself
@@ -1,24 +1,50 @@
 #ifndef TASKBASE_H
 #define TASKBASE_H
 
+#include <atomic>
 #include <cstdint>
 
 #include <Seeed_Arduino_FreeRTOS.h>
 
+#include "SysTimer.h"
+#include "FixedConfig.h"
+#include "TaskProfiler.h"
+
+// Task/QueueはRtosTopology.hで定義した領域に静的に確保するため、FreeRTOS Heapへのfallbackは持たない
+#if (configSUPPORT_STATIC_ALLOCATION != 1)
+#error "configSUPPORT_STATIC_ALLOCATION must be 1 (see build.sh)"
+#endif
+
+/**
+ * @brief Heartbeatが途絶えた場合にWatchdogTaskが行う処理です
+ */
+enum class WatchdogAction : uint32_t {
+    Log,     /**< 記録のみ行う */
+    Restart, /**< Taskを削除して、作成時と同じ引数で作り直す。setup()から再実行される。共有ロックを保持している場合はResetとして扱う */
+    Reset,   /**< Hardware Watchdogにより再起動する */
+};
+
 /**
  * @brief FreeRTOSのTaskをWrapした基底クラスです
+ * @note 生成されたインスタンスはすべてRegistryに登録され、forEach()で列挙できます
+ * @note loop()のたびにHeartbeatを更新し、WatchdogTaskが期限切れを監視します
  */
 class TaskBase {
     public:
         /**
          * @brief Construct a new Task Base object
          */
-        TaskBase(void): isRunning(false) {}
+        TaskBase(void): taskHandle(nullptr), isRunning(false), heartbeatDeadlineTick(0), isHeartbeatArmed(false), stallNum(0), heldLockNum(0), createStackSize(0), createPriority(0), createStack(nullptr), createTcb(nullptr) {
+            this->registerSelf();
+        }
 
         /**
          * @brief Destroy the Task Base object
          */
-        virtual ~TaskBase(void) { this->deleteTask(); }
+        virtual ~TaskBase(void) {
+            this->deleteTask();
+            this->unregisterSelf();
+        }
 
         /**
          * @brief Create a Task object
@@ -28,6 +54,30 @@ class TaskBase {
          */
         void createTask(size_t stackSize, uint32_t priority);
 
+        /**
+         * @brief 静的に確保するTaskの領域です
+         * @note RtosTopology.hでRAM使用量の集計に使用します
+         * 
+         * @tparam StackSize FreeRTOSで割り当てるStackSize[word]
+         */
+        template<size_t StackSize>
+        struct StaticStorage {
+            StackType_t stack[StackSize]; /**< Stack */
+            StaticTask_t tcb; /**< Task Control Block */
+        };
+
+        /**
+         * @brief 静的に確保した領域でTaskを作成します。FreeRTOS Heapは使用しません
+         * 
+         * @tparam StackSize FreeRTOSで割り当てるStackSize[word]
+         * @param storage Taskの領域、Taskを削除するまで破棄しないでください
+         * @param priority Task優先度
+         */
+        template<size_t StackSize>
+        void createTask(StaticStorage<StackSize>& storage, uint32_t priority) {
+            this->createTaskStatic(storage.stack, StackSize, &storage.tcb, priority);
+        }
+
         /**
          * @brief Delete Task
          */
@@ -47,9 +97,141 @@ class TaskBase {
          * @return const char* TaskName
          */
         virtual const char* getName(void) = 0;
+
+        /**
+         * @brief 直近の実行統計を取得します
+         * @note WFH_MONITOR_ENABLE_TASK_PROFILERを定義してビルドした場合のみ記録されます
+         * 
+         * @param dst 統計の書き込み先
+         * @return true 取得成功
+         * @return false WFH_MONITOR_ENABLE_TASK_PROFILERが未定義
+         */
+        bool getProfile(TaskProfile& dst) { return this->profiler.get(dst); }
+
+        /**
+         * @brief Heartbeatの期限が切れているか判定します
+         * 
+         * @param nowTick 現在のSystick
+         * @return true 期限切れ
+         * @return false 期限内、またはTaskが動いていない/Heartbeatの監視対象外の待機中
+         */
+        bool isHeartbeatExpired(uint32_t nowTick) {
+            bool result = false;
+            taskENTER_CRITICAL();
+            {
+                result = this->isRunning && this->isHeartbeatArmed && (static_cast<int32_t>(nowTick - this->heartbeatDeadlineTick) > 0);
+            }
+            taskEXIT_CRITICAL();
+            return result;
+        }
+
+        /**
+         * @brief Heartbeatの期限切れを記録します。WatchdogTaskから呼び出されます
+         * @note 次のHeartbeatまでは再度期限切れと判定されません
+         */
+        void onStall(void) {
+            taskENTER_CRITICAL();
+            {
+                this->stallNum++;
+                this->isHeartbeatArmed = false;
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * @brief Heartbeatの期限切れ回数を取得します
+         * 
+         * @return uint32_t 期限切れ回数
+         */
+        uint32_t getStallNum(void) { return this->stallNum; }
+
+        /**
+         * @brief Heartbeatが途絶えた場合にWatchdogTaskが行う処理を取得します
+         * 
+         * @return WatchdogAction 
+         */
+        virtual WatchdogAction getWatchdogAction(void) { return WatchdogAction::Log; }
+
+        /**
+         * @brief 獲得中/獲得待ちの共有ロックの数を取得します
+         * 
+         * @return uint32_t SharedResource/SharedRwResourceのロック数
+         */
+        uint32_t getHeldLockNum(void) { return this->heldLockNum.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Taskを削除して、作成時と同じ引数で作り直します
+         * @note 削除したTaskが保持していた共有ロックは解放されず他のTaskが止まるため、共有ロックを保持している間は作り直しません
+         * 
+         * @return true 作り直した
+         * @return false Taskが作成されていない、または共有ロックを保持している
+         */
+        bool restartTask(void);
+
+        /**
+         * @brief 呼び出し元Taskが共有ロックの獲得を始めたことを記録します。SharedResource/SharedRwResourceから呼び出されます
+         * @note SharedRwResourceは待機数も記録するため、獲得待ちの間も保持しているものとして数えます
+         * @note TaskBaseで作成したTask以外(setup()など)からの呼び出しは記録しません
+         */
+        static void beginSharedLock(void) {
+            TaskBase* task = findCurrent();
+            if (task != nullptr) task->heldLockNum.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 呼び出し元Taskが共有ロックを解放したことを記録します。SharedResource/SharedRwResourceから呼び出されます
+         */
+        static void endSharedLock(void) {
+            TaskBase* task = findCurrent();
+            if (task != nullptr) task->heldLockNum.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 登録されているすべてのTaskを列挙します
+         * @note Taskのインスタンスはstaticに確保され、Task開始後に生成/破棄されない前提です
+         * 
+         * @tparam F void(TaskBase&) の型に一致する関数
+         * @param functor 処理関数
+         */
+        template<class F>
+        static void forEach(F functor) {
+            for (TaskBase* t = registryHead; t != nullptr; t = t->registryNext) {
+                functor(*t);
+            }
+        }
+
     protected:
         TaskHandle_t taskHandle;
         bool isRunning;
+        TaskProfiler profiler; /**< loop()の実行統計 */
+        uint32_t heartbeatDeadlineTick; /**< 次のHeartbeatの期限 */
+        bool isHeartbeatArmed; /**< Heartbeatを監視中ならtrue */
+        volatile uint32_t stallNum; /**< Heartbeatの期限切れ回数 */
+        std::atomic<uint32_t> heldLockNum; /**< 獲得中/獲得待ちの共有ロックの数, 自Taskのみが更新する */
+
+        /**
+         * @brief Heartbeatを更新します。taskMainからloop()のたびに呼び出されます
+         * @note loop()内で長時間待機する場合は、待機直前に待機時間を指定して呼び出してください
+         * 
+         * @param waitTick これから待機するtick数, portMAX_DELAYなら次のHeartbeatまで監視しない
+         */
+        void beat(uint32_t waitTick) {
+            const uint32_t deadlineTick = SysTimer::getTickCount() + waitTick + this->getHeartbeatTimeoutTick();
+            taskENTER_CRITICAL();
+            {
+                this->isHeartbeatArmed = (waitTick != portMAX_DELAY);
+                this->heartbeatDeadlineTick = deadlineTick;
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * @brief loop()1回の処理に許容する時間を返します。待機時間にこの値を加えたものがHeartbeatの期限になります
+         * @note 通信などで時間がかかるTaskはoverrideします
+         * 
+         * @return uint32_t 許容するtick数
+         */
+        virtual uint32_t getHeartbeatTimeoutTick(void) { return SysTimer::msToTick(FixedConfig::WatchdogDefaultTimeoutMs); }
 
         /**
          * @brief FreeRTOSから起動されるTask本体です
@@ -74,6 +256,37 @@ class TaskBase {
          * @brief Taskをloop()の戻り値制御でAbortした際に、1回だけ呼び出されます
          */
         virtual void abort(void) {};
+
+    private:
+        /**
+         * @brief 静的に確保した領域でTaskを作成します
+         */
+        void createTaskStatic(StackType_t* stack, size_t stackSize, StaticTask_t* tcb, uint32_t priority);
+
+        size_t createStackSize; /**< 作成時のStackSize */
+        uint32_t createPriority; /**< 作成時のTask優先度 */
+        StackType_t* createStack; /**< 作成時に割り当てた静的領域, 動的確保ならnullptr */
+        StaticTask_t* createTcb; /**< 作成時に割り当てた静的領域, 動的確保ならnullptr */
+
+        static TaskBase* registryHead; /**< Registryの先頭 */
+        TaskBase* registryNext; /**< Registryの次の要素 */
+
+        /**
+         * @brief Registryに自身を登録します
+         */
+        void registerSelf(void);
+
+        /**
+         * @brief Registryから自身を削除します
+         */
+        void unregisterSelf(void);
+
+        /**
+         * @brief 呼び出し元のTaskをRegistryから探します
+         * 
+         * @return TaskBase* 呼び出し元のTask, TaskBaseで作成したTaskでなければnullptr
+         */
+        static TaskBase* findCurrent(void);
 };
 
 #endif /* TASKBASE_H */
\ No newline at end of file
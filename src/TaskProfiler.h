@@ -0,0 +1,251 @@
+#ifndef TASKPROFILER_H
+#define TASKPROFILER_H
+
+#include <cstdint>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "SysTimer.h"
+#include "FixedConfig.h"
+
+/**
+ * @brief TaskProfilerのloop時間Histogramのbin数です
+ * @note bin[0]は0us, bin[i]は[2^(i-1), 2^i)us, 最後のbinはそれ以上をすべて含みます
+ */
+static constexpr size_t TaskProfileBinNum = 24;
+
+/**
+ * @brief Taskの実行統計です。FixedConfig::TaskProfileWindowMsごとに直近の期間の値に更新されます
+ */
+struct TaskProfile {
+    uint32_t loopNum;  /**< 期間内にloop()を呼び出した回数 */
+    uint32_t minUs;    /**< loop()の最小処理時間 */
+    uint32_t meanUs;   /**< loop()の平均処理時間 */
+    uint32_t p99Us;    /**< loop()の99 percentile処理時間, Histogramのbin上限で近似 */
+    uint32_t maxUs;    /**< loop()の最大処理時間 */
+    uint32_t cpuSharePermil; /**< 期間内のCPU使用率[‰] */
+    uint32_t stackHighWaterMark; /**< Stackの残量の最小値[word] */
+};
+
+/**
+ * @brief TaskProfileを出力します
+ *
+ * @tparam P print, printlnが使えるclass
+ * @param oStream 出力先
+ * @param name Task名
+ * @param profile 出力する統計
+ */
+template<typename P>
+static void printTaskProfile(P& oStream, const char* name, const TaskProfile& profile) {
+    oStream.print("[task] ");
+    oStream.print(name);
+    oStream.print(" loop=");
+    oStream.print(profile.loopNum);
+    oStream.print(" min/mean/p99/max=");
+    oStream.print(profile.minUs);
+    oStream.print("/");
+    oStream.print(profile.meanUs);
+    oStream.print("/");
+    oStream.print(profile.p99Us);
+    oStream.print("/");
+    oStream.print(profile.maxUs);
+    oStream.print("[us] cpu=");
+    oStream.print(profile.cpuSharePermil);
+    oStream.print("[permil] stack=");
+    oStream.print(profile.stackHighWaterMark);
+    oStream.println("[word]");
+}
+
+#ifdef WFH_MONITOR_ENABLE_TASK_PROFILER
+
+/**
+ * @brief Taskのloop()処理時間、CPU使用率、Stack残量を記録します
+ * @note 記録は対象Task自身から行い、集計結果の読み出しは任意のTaskから行えます
+ * @note loop()内でQueue待ちなどをしている場合、その時間もloop()の処理時間に含まれます
+ * @note configGENERATE_RUN_TIME_STATS/configUSE_TRACE_FACILITYが有効な場合、CPU使用率はFreeRTOSの実行時間統計から求めます
+ *       無効な場合はloop()の処理時間の合計から求めるので、Preemptionされていた時間も含んだ上限値になります
+ */
+class TaskProfiler {
+    public:
+        /**
+         * @brief Construct a new Task Profiler object
+         */
+        TaskProfiler(void): windowStartUs(0), loopStartUs(0), isStarted(false) {
+            this->clearWindow();
+            this->profile.loopNum = 0;
+            this->profile.minUs = 0;
+            this->profile.meanUs = 0;
+            this->profile.p99Us = 0;
+            this->profile.maxUs = 0;
+            this->profile.cpuSharePermil = 0;
+            this->profile.stackHighWaterMark = 0;
+        }
+
+        /**
+         * @brief loop()の直前に呼び出します
+         */
+        void beginLoop(void) {
+            this->loopStartUs = SysTimer::getMicroCount();
+            if (!this->isStarted) {
+                this->windowStartUs = this->loopStartUs;
+                this->windowStartRunTime = getRunTime();
+                this->windowStartTotalRunTime = getTotalRunTime();
+                this->isStarted = true;
+            }
+        }
+
+        /**
+         * @brief loop()の直後に呼び出します
+         */
+        void endLoop(void) {
+            const uint32_t nowUs = SysTimer::getMicroCount();
+            const uint32_t elapsedUs = nowUs - this->loopStartUs;
+
+            this->loopNum++;
+            this->sumUs += elapsedUs;
+            if (elapsedUs < this->minUs) this->minUs = elapsedUs;
+            if (elapsedUs > this->maxUs) this->maxUs = elapsedUs;
+            this->histogram[usToBin(elapsedUs)]++;
+
+            // 期間が終わったら集計して公開
+            const uint32_t windowUs = nowUs - this->windowStartUs;
+            if (windowUs >= FixedConfig::TaskProfileWindowMs * 1000) {
+                this->publish(nowUs, windowUs);
+            }
+        }
+
+        /**
+         * @brief 直近の期間の統計を取得します
+         *
+         * @param dst 統計の書き込み先
+         * @return true 取得成功
+         */
+        bool get(TaskProfile& dst) {
+            taskENTER_CRITICAL();
+            {
+                dst = this->profile;
+            }
+            taskEXIT_CRITICAL();
+            return true;
+        }
+
+    protected:
+        TaskProfile profile; /**< 直近の期間の集計結果 */
+        uint32_t histogram[TaskProfileBinNum]; /**< 集計中のloop()処理時間の分布 */
+        uint32_t loopNum;  /**< 集計中のloop()呼び出し回数 */
+        uint32_t sumUs;    /**< 集計中のloop()処理時間の合計 */
+        uint32_t minUs;    /**< 集計中のloop()最小処理時間 */
+        uint32_t maxUs;    /**< 集計中のloop()最大処理時間 */
+        uint32_t windowStartUs; /**< 集計を開始した時刻 */
+        uint32_t windowStartRunTime; /**< 集計開始時のTaskの実行時間 */
+        uint32_t windowStartTotalRunTime; /**< 集計開始時のRun Time Counter */
+        uint32_t loopStartUs; /**< loop()を開始した時刻 */
+        bool isStarted; /**< 最初のloop()が始まっていればtrue */
+
+        /**
+         * @brief 集計中の値をクリアします
+         */
+        void clearWindow(void) {
+            this->loopNum = 0;
+            this->sumUs = 0;
+            this->minUs = UINT32_MAX;
+            this->maxUs = 0;
+            for (size_t i = 0; i < TaskProfileBinNum; i++) {
+                this->histogram[i] = 0;
+            }
+        }
+
+        /**
+         * @brief 集計中の値から統計を求めて公開し、次の期間を開始します
+         */
+        void publish(uint32_t nowUs, uint32_t windowUs) {
+            TaskProfile next;
+            next.loopNum = this->loopNum;
+            next.minUs = this->minUs;
+            next.meanUs = this->sumUs / this->loopNum;
+            next.maxUs = this->maxUs;
+            // 99%が収まるbinの上限
+            const uint32_t thresholdNum = this->loopNum - (this->loopNum / 100);
+            uint32_t cumulativeNum = 0;
+            next.p99Us = this->maxUs;
+            for (size_t i = 0; i < TaskProfileBinNum; i++) {
+                cumulativeNum += this->histogram[i];
+                if (cumulativeNum >= thresholdNum) {
+                    const uint32_t upperUs = (i == 0) ? 0 : ((1u << i) - 1);
+                    next.p99Us = (upperUs < this->maxUs) ? upperUs : this->maxUs;
+                    break;
+                }
+            }
+            // CPU使用率
+            const uint32_t runTime = getRunTime();
+            const uint32_t totalRunTime = getTotalRunTime();
+            const uint32_t totalDiff = totalRunTime - this->windowStartTotalRunTime;
+            if (totalDiff > 0) {
+                next.cpuSharePermil = static_cast<uint32_t>((static_cast<uint64_t>(runTime - this->windowStartRunTime) * 1000) / totalDiff);
+            } else {
+                next.cpuSharePermil = static_cast<uint32_t>((static_cast<uint64_t>(this->sumUs) * 1000) / windowUs);
+            }
+            // Stack残量, 自Taskから呼び出しているのでnullptrで良い
+            next.stackHighWaterMark = uxTaskGetStackHighWaterMark(nullptr);
+
+            taskENTER_CRITICAL();
+            {
+                this->profile = next;
+            }
+            taskEXIT_CRITICAL();
+
+            this->clearWindow();
+            this->windowStartUs = nowUs;
+            this->windowStartRunTime = runTime;
+            this->windowStartTotalRunTime = totalRunTime;
+        }
+
+        /**
+         * @brief 自Taskの実行時間を取得します。FreeRTOSの実行時間統計が無効な場合は0
+         */
+        static uint32_t getRunTime(void) {
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+            TaskStatus_t status;
+            vTaskGetInfo(nullptr, &status, pdFALSE, eInvalid);
+            return status.ulRunTimeCounter;
+#else
+            return 0;
+#endif
+        }
+
+        /**
+         * @brief Run Time Counterを取得します。FreeRTOSの実行時間統計が無効な場合は0
+         */
+        static uint32_t getTotalRunTime(void) {
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+            return portGET_RUN_TIME_COUNTER_VALUE();
+#else
+            return 0;
+#endif
+        }
+
+        /**
+         * @brief 処理時間からHistogramのbinを求めます
+         */
+        static size_t usToBin(uint32_t us) {
+            if (us == 0) return 0;
+            const size_t bin = 32 - __builtin_clz(us);
+            return (bin < TaskProfileBinNum) ? bin : (TaskProfileBinNum - 1);
+        }
+};
+
+#else
+
+/**
+ * @brief WFH_MONITOR_ENABLE_TASK_PROFILERが未定義の場合は何も記録しません
+ */
+class TaskProfiler {
+    public:
+        void beginLoop(void) {}
+        void endLoop(void) {}
+        bool get(TaskProfile& dst) { return false; }
+};
+
+#endif /* WFH_MONITOR_ENABLE_TASK_PROFILER */
+
+#endif /* TASKPROFILER_H */
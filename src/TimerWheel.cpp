@@ -0,0 +1,219 @@
+#include "TimerWheel.h"
+
+/**
+ * @brief 64bit値を右に回転します
+ */
+static uint64_t rotateRight(uint64_t value, uint32_t shift) {
+    shift &= 63;
+    if (shift == 0) return value;
+    return (value >> shift) | (value << (64 - shift));
+}
+
+/****************************** TimerDispatcher ******************************/
+size_t TimerDispatcher::dispatch(void) {
+    size_t dispatchNum = 0;
+    while (true) {
+        TimerEntry* entry = nullptr;
+        taskENTER_CRITICAL();
+        {
+            entry = this->pending.front();
+            if (entry != nullptr) {
+                this->pending.remove(*entry);
+                entry->state = TimerState::Firing;
+            }
+        }
+        taskEXIT_CRITICAL();
+        if (entry == nullptr) break;
+
+        entry->callback(entry->context);
+        dispatchNum++;
+
+        // 周期Timerは次の期限で再登録、Callback内で再登録/停止された場合はそちらを優先する
+        if ((entry->periodTick > 0) && (entry->wheel != nullptr)) {
+            entry->wheel->rearm(*entry);
+        } else {
+            taskENTER_CRITICAL();
+            {
+                if (entry->state == TimerState::Firing) {
+                    entry->state = TimerState::Idle;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+    return dispatchNum;
+}
+
+/****************************** TimerWheel ******************************/
+void TimerWheel::arm(TimerEntry& entry, uint64_t expiryTick, uint32_t periodTick) {
+    const uint64_t nowUnit = SysTimer::getTickCount64() / SysTimer::msToTick(FixedConfig::TimerWheelResolutionMs);
+    bool isEarlier = false;
+    taskENTER_CRITICAL();
+    {
+        if (!this->isStarted) {
+            this->currentUnit = nowUnit;
+            this->isStarted = true;
+        }
+        this->detach(entry);
+        entry.wheel = this;
+        entry.expiryTick = expiryTick;
+        entry.periodTick = periodTick;
+        const uint64_t unit = this->insert(entry, this->currentUnit + 1);
+        isEarlier = (unit < this->scheduledWakeUnit);
+    }
+    taskEXIT_CRITICAL();
+
+    // TimerTaskが予定より早く起きる必要がある
+    if (isEarlier && (this->waitSet != nullptr)) {
+        this->waitSet->signal(this->waitSetBit);
+    }
+}
+
+void TimerWheel::rearm(TimerEntry& entry) {
+    const uint64_t nowTick = SysTimer::getTickCount64();
+    bool isEarlier = false;
+    taskENTER_CRITICAL();
+    {
+        if (entry.state == TimerState::Firing) {
+            // 呼び出しが遅れて過ぎた周期は飛ばし、位相は保つ
+            uint64_t nextTick = entry.expiryTick + entry.periodTick;
+            if (nextTick <= nowTick) {
+                nextTick = getAlignedTick(nowTick, entry.periodTick, static_cast<uint32_t>(entry.expiryTick % entry.periodTick));
+            }
+            entry.expiryTick = nextTick;
+            const uint64_t unit = this->insert(entry, this->currentUnit + 1);
+            isEarlier = (unit < this->scheduledWakeUnit);
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (isEarlier && (this->waitSet != nullptr)) {
+        this->waitSet->signal(this->waitSetBit);
+    }
+}
+
+void TimerWheel::detach(TimerEntry& entry) {
+    if (entry.list == nullptr) return;
+
+    entry.list->remove(entry);
+    if ((entry.state == TimerState::Armed) && this->slots[entry.level][entry.slot].isEmpty()) {
+        this->occupied[entry.level] &= ~(0x1ull << entry.slot);
+    }
+}
+
+uint64_t TimerWheel::insert(TimerEntry& entry, uint64_t minUnit) {
+    uint64_t unit = tickToUnit(entry.expiryTick);
+    if (unit < minUnit) {
+        unit = minUnit;
+    }
+    // 期限までの距離で階層を決める。最上位を超える場合は最上位に入れて、周回してきたら入れ直す
+    const uint64_t deltaUnit = unit - this->currentUnit;
+    uint32_t level = 0;
+    while (((level + 1) < LevelNum) && (deltaUnit >= (0x1ull << (SlotBits * (level + 1))))) {
+        level++;
+    }
+    const uint32_t slot = static_cast<uint32_t>(unit >> (SlotBits * level)) & (SlotNum - 1);
+
+    entry.state = TimerState::Armed;
+    entry.level = static_cast<uint8_t>(level);
+    entry.slot = static_cast<uint8_t>(slot);
+    this->slots[level][slot].pushBack(entry);
+    this->occupied[level] |= (0x1ull << slot);
+    return unit;
+}
+
+uint64_t TimerWheel::getNextEventUnit(uint32_t level) const {
+    if (this->occupied[level] == 0) return UINT64_MAX;
+
+    // 現在のslotの次から1周分で、最初にTimerが入っているslot
+    const uint32_t shift = SlotBits * level;
+    const uint64_t baseIndex = (this->currentUnit >> shift) + 1;
+    const uint64_t rotated = rotateRight(this->occupied[level], static_cast<uint32_t>(baseIndex & (SlotNum - 1)));
+    const uint64_t offset = static_cast<uint64_t>(__builtin_ctzll(rotated));
+    return (baseIndex + offset) << shift;
+}
+
+uint64_t TimerWheel::getNextEventUnit(void) const {
+    uint64_t nextUnit = UINT64_MAX;
+    for (uint32_t level = 0; level < LevelNum; level++) {
+        const uint64_t unit = this->getNextEventUnit(level);
+        if (unit < nextUnit) {
+            nextUnit = unit;
+        }
+    }
+    return nextUnit;
+}
+
+void TimerWheel::advance(TimerDispatcher& defaultDispatcher) {
+    const uint64_t nowUnit = SysTimer::getTickCount64() / SysTimer::msToTick(FixedConfig::TimerWheelResolutionMs);
+    bool isFinished = false;
+    while (!isFinished) {
+        TimerDispatcher* signalDst = nullptr;
+        // Critical Sectionが長くならないよう、1回に渡すTimerは1つにする
+        taskENTER_CRITICAL();
+        {
+            if (!this->isStarted) {
+                this->currentUnit = nowUnit;
+                this->isStarted = true;
+            }
+            TimerEntry* entry = this->slots[0][this->currentUnit & (SlotNum - 1)].front();
+            if (entry != nullptr) {
+                // 期限が来た
+                this->detach(*entry);
+                signalDst = (entry->dispatcher != nullptr) ? entry->dispatcher : &defaultDispatcher;
+                signalDst->enqueue(*entry);
+            } else {
+                // 次にTimerがあるslotまで空のslotを飛ばす
+                const uint64_t nextUnit = this->getNextEventUnit();
+                if (nextUnit > nowUnit) {
+                    if (nowUnit > this->currentUnit) {
+                        this->currentUnit = nowUnit;
+                    }
+                    isFinished = true;
+                } else {
+                    this->currentUnit = nextUnit;
+                    // 上位の階層から順に、区切りに到達したslotを下位に入れ直す
+                    for (uint32_t level = (LevelNum - 1); level > 0; level--) {
+                        const uint32_t shift = SlotBits * level;
+                        if ((nextUnit & ((0x1ull << shift) - 1)) != 0) continue;
+                        const uint32_t slot = static_cast<uint32_t>(nextUnit >> shift) & (SlotNum - 1);
+                        TimerList cascade;
+                        while (!this->slots[level][slot].isEmpty()) {
+                            TimerEntry* e = this->slots[level][slot].front();
+                            this->slots[level][slot].remove(*e);
+                            cascade.pushBack(*e);
+                        }
+                        this->occupied[level] &= ~(0x1ull << slot);
+                        while (!cascade.isEmpty()) {
+                            TimerEntry* e = cascade.front();
+                            cascade.remove(*e);
+                            this->insert(*e, this->currentUnit);
+                        }
+                    }
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if (signalDst != nullptr) {
+            signalDst->signal();
+        }
+    }
+}
+
+uint32_t TimerWheel::getIdleTimeoutTick(void) {
+    uint64_t nextUnit = UINT64_MAX;
+    taskENTER_CRITICAL();
+    {
+        nextUnit = this->getNextEventUnit();
+        this->scheduledWakeUnit = nextUnit;
+    }
+    taskEXIT_CRITICAL();
+    if (nextUnit == UINT64_MAX) return portMAX_DELAY;
+
+    const uint64_t nextTick = unitToTick(nextUnit);
+    const uint64_t nowTick = SysTimer::getTickCount64();
+    if (nextTick <= nowTick) return 0;
+    const uint64_t remainTick = nextTick - nowTick;
+    return (remainTick < portMAX_DELAY) ? static_cast<uint32_t>(remainTick) : (portMAX_DELAY - 1);
+}
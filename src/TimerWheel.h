@@ -0,0 +1,402 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <cstdint>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+#include "SysTimer.h"
+#include "FixedConfig.h"
+#include "IpcWaitSet.h"
+
+class TimerWheel;
+class TimerDispatcher;
+class TimerList;
+
+/**
+ * @brief Timerの期限が来た時に呼び出される関数です
+ *
+ * @param context TimerEntry::init()で指定した引数
+ */
+typedef void (*TimerCallback)(void* context);
+
+/**
+ * @brief TimerEntryの状態です
+ */
+enum class TimerState : uint32_t {
+    Idle,    /**< 停止中 */
+    Armed,   /**< TimerWheelで期限待ち */
+    Pending, /**< 期限が来てTimerDispatcherで呼び出し待ち */
+    Firing,  /**< Callback呼び出し中 */
+};
+
+/**
+ * @brief TimerWheelに登録するTimerです
+ * @note 領域は利用者が確保し、登録中は破棄しないでください。TimerWheel/TimerDispatcherは領域を確保しません
+ */
+class TimerEntry {
+    public:
+        /**
+         * @brief Construct a new Timer Entry object
+         */
+        TimerEntry(void): callback(nullptr), context(nullptr), dispatcher(nullptr), wheel(nullptr), state(TimerState::Idle), expiryTick(0), periodTick(0), level(0), slot(0), list(nullptr), prev(nullptr), next(nullptr) {}
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        TimerEntry(const TimerEntry&) = delete;
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        TimerEntry& operator=(const TimerEntry&) = delete;
+
+        /**
+         * @brief 呼び出し先を設定します。停止中に呼び出してください
+         *
+         * @param callback 期限が来た時に呼び出す関数
+         * @param context callbackの引数
+         * @param dispatcher callbackを呼び出すTaskのTimerDispatcher, nullptrならTimerTaskで呼び出す
+         */
+        void init(TimerCallback callback, void* context, TimerDispatcher* dispatcher) {
+            this->callback = callback;
+            this->context = context;
+            this->dispatcher = dispatcher;
+        }
+
+        /**
+         * @brief 現在の状態を取得します
+         */
+        TimerState getState(void) const { return this->state; }
+
+        /**
+         * @brief 次の期限を取得します
+         *
+         * @return uint64_t SysTimer::getTickCount64()基準のtick
+         */
+        uint64_t getExpiryTick(void) const { return this->expiryTick; }
+
+    protected:
+        TimerCallback callback;      /**< 呼び出し先 */
+        void* context;               /**< callbackの引数 */
+        TimerDispatcher* dispatcher; /**< callbackを呼び出すTask, nullptrならTimerTask */
+        TimerWheel* wheel;           /**< 登録先, 周期Timerの再登録に使う */
+        volatile TimerState state;   /**< 現在の状態 */
+        uint64_t expiryTick;         /**< 次の期限 */
+        uint32_t periodTick;         /**< 周期, 0ならOne-Shot */
+        uint8_t level;               /**< 登録中のTimerWheelの階層 */
+        uint8_t slot;                /**< 登録中のTimerWheelのslot */
+        TimerList* list;             /**< 所属するlist, どこにも所属していなければnullptr */
+        TimerEntry* prev;            /**< 所属するlistの前の要素 */
+        TimerEntry* next;            /**< 所属するlistの次の要素 */
+
+        friend class TimerList;
+        friend class TimerWheel;
+        friend class TimerDispatcher;
+};
+
+/**
+ * @brief TimerEntryの侵入型双方向listです。追加/削除はO(1)です
+ */
+class TimerList {
+    public:
+        TimerList(void): head(nullptr), tail(nullptr) {}
+
+        bool isEmpty(void) const { return this->head == nullptr; }
+        TimerEntry* front(void) const { return this->head; }
+
+        void pushBack(TimerEntry& entry) {
+            entry.list = this;
+            entry.prev = this->tail;
+            entry.next = nullptr;
+            if (this->tail != nullptr) {
+                this->tail->next = &entry;
+            } else {
+                this->head = &entry;
+            }
+            this->tail = &entry;
+        }
+
+        void remove(TimerEntry& entry) {
+            if (entry.prev != nullptr) {
+                entry.prev->next = entry.next;
+            } else {
+                this->head = entry.next;
+            }
+            if (entry.next != nullptr) {
+                entry.next->prev = entry.prev;
+            } else {
+                this->tail = entry.prev;
+            }
+            entry.list = nullptr;
+            entry.prev = nullptr;
+            entry.next = nullptr;
+        }
+
+    protected:
+        TimerEntry* head; /**< 先頭 */
+        TimerEntry* tail; /**< 末尾 */
+};
+
+/**
+ * @brief 期限が来たTimerのCallbackを、所有するTaskのContextで呼び出します
+ * @note 所有するTaskのloop()からdispatch()を呼び出してください。attachWaitSet()しておくと期限が来た時にTaskを起床させます
+ */
+class TimerDispatcher {
+    public:
+        /**
+         * @brief Construct a new Timer Dispatcher object
+         */
+        TimerDispatcher(void): waitSet(nullptr), waitSetBit(0) {}
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        TimerDispatcher(const TimerDispatcher&) = delete;
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        TimerDispatcher& operator=(const TimerDispatcher&) = delete;
+
+        /**
+         * @brief 期限が来た時に通知するIpcWaitSetを登録します
+         *
+         * @param set 通知先
+         * @return true 登録成功
+         * @return false すでに登録済、またはsetに空きがない
+         */
+        bool attachWaitSet(IpcWaitSet& set) {
+            if (this->waitSet != nullptr) return false;
+
+            const uint32_t bit = set.allocateBit();
+            if (bit == 0) return false;
+
+            this->waitSetBit = bit;
+            this->waitSet = &set;
+            return true;
+        }
+
+        /**
+         * @brief 期限が来たTimerのCallbackをすべて呼び出します
+         * @note 周期Timerは呼び出し後に次の期限で再登録されます。呼び出しが遅れた場合、過ぎた周期は飛ばします
+         *
+         * @return size_t 呼び出した数
+         */
+        size_t dispatch(void);
+
+    protected:
+        TimerList pending;    /**< 呼び出し待ちのTimer */
+        IpcWaitSet* waitSet;  /**< 通知先 */
+        uint32_t waitSetBit;  /**< 通知に使うbit */
+
+        /**
+         * @brief 期限が来たTimerを追加します。Critical Section内から呼び出されます
+         */
+        void enqueue(TimerEntry& entry) {
+            entry.state = TimerState::Pending;
+            this->pending.pushBack(entry);
+        }
+
+        /**
+         * @brief 所有するTaskに通知します
+         */
+        void signal(void) {
+            if (this->waitSet != nullptr) {
+                this->waitSet->signal(this->waitSetBit);
+            }
+        }
+
+        friend class TimerWheel;
+};
+
+/**
+ * @brief 階層型Timer Wheelです。Timerの登録/解除はTimer数によらずO(1)で行えます
+ * @note 1slotの幅はFixedConfig::TimerWheelResolutionMsで、同じslotに入ったTimerは同時に期限を迎えます
+ * @note 期限の確認はTimerTaskがadvance()で行い、各TimerはTimerEntry::init()で指定したTaskのTimerDispatcherで呼び出されます
+ */
+class TimerWheel {
+    public:
+        static constexpr uint32_t SlotBits = 6; /**< 1階層のslot数のbit幅 */
+        static constexpr uint32_t SlotNum = (0x1u << SlotBits); /**< 1階層のslot数 */
+        static constexpr uint32_t LevelNum = 4; /**< 階層数, 最上位の範囲を超える期限は最上位を何度か周回します */
+
+        /**
+         * @brief Construct a new Timer Wheel object
+         */
+        TimerWheel(void): currentUnit(0), isStarted(false), scheduledWakeUnit(UINT64_MAX), waitSet(nullptr), waitSetBit(0) {
+            for (uint32_t i = 0; i < LevelNum; i++) {
+                this->occupied[i] = 0;
+            }
+        }
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        TimerWheel(const TimerWheel&) = delete;
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        /**
+         * @brief One-Shot Timerを登録します。登録済の場合は期限を変更します
+         *
+         * @param entry 登録するTimer
+         * @param delayMs 現在からの期限[ms]
+         */
+        void armOneShot(TimerEntry& entry, uint32_t delayMs) {
+            this->arm(entry, SysTimer::getTickCount64() + SysTimer::msToTick(delayMs), 0);
+        }
+
+        /**
+         * @brief 周期Timerを登録します。最初の期限は現在から1周期後です
+         *
+         * @param entry 登録するTimer
+         * @param periodMs 周期[ms]
+         */
+        void armPeriodic(TimerEntry& entry, uint32_t periodMs) {
+            const uint32_t periodTick = SysTimer::msToTick(periodMs);
+            this->arm(entry, SysTimer::getTickCount64() + periodTick, periodTick);
+        }
+
+        /**
+         * @brief 起動からの時刻がperiodMsの倍数+phaseMsになるたびに呼び出される周期Timerを登録します
+         * @note 同じ周期と位相のTimerは同時に期限を迎えるので、複数の周期処理で起床をまとめられます
+         *
+         * @param entry 登録するTimer
+         * @param periodMs 周期[ms]
+         * @param phaseMs 位相[ms], periodMs未満
+         */
+        void armPeriodicAligned(TimerEntry& entry, uint32_t periodMs, uint32_t phaseMs) {
+            const uint32_t periodTick = SysTimer::msToTick(periodMs);
+            const uint32_t phaseTick = SysTimer::msToTick(phaseMs);
+            this->arm(entry, getAlignedTick(SysTimer::getTickCount64(), periodTick, phaseTick), periodTick);
+        }
+
+        /**
+         * @brief Timerを停止します。期限待ち/呼び出し待ちのどちらでも解除できます
+         * @note Callback呼び出し中に他Taskから停止した場合、呼び出しは中断されませんが周期Timerの再登録は行われません
+         *
+         * @param entry 停止するTimer
+         */
+        void cancel(TimerEntry& entry) {
+            taskENTER_CRITICAL();
+            {
+                this->detach(entry);
+                entry.state = TimerState::Idle;
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * @brief 期限を確認するTaskのIpcWaitSetを登録します。現在の待機期限より早いTimerが登録されると通知します
+         *
+         * @param set 通知先
+         * @return true 登録成功
+         * @return false すでに登録済、またはsetに空きがない
+         */
+        bool attachWaitSet(IpcWaitSet& set) {
+            if (this->waitSet != nullptr) return false;
+
+            const uint32_t bit = set.allocateBit();
+            if (bit == 0) return false;
+
+            this->waitSetBit = bit;
+            this->waitSet = &set;
+            return true;
+        }
+
+        /**
+         * @brief 現在時刻までに期限が来たTimerを各TimerDispatcherに渡します。TimerTaskから呼び出されます
+         * @note 空のslotはbitmapで読み飛ばすので、前回からの経過時間によらず処理量は期限を迎えたTimer数程度です
+         *
+         * @param defaultDispatcher 呼び出し先が指定されていないTimerを渡すTimerDispatcher
+         */
+        void advance(TimerDispatcher& defaultDispatcher);
+
+        /**
+         * @brief 次にadvance()を呼び出す必要があるまでのtick数を求めます
+         *
+         * @return uint32_t 待機tick, 登録中のTimerがなければportMAX_DELAY
+         */
+        uint32_t getIdleTimeoutTick(void);
+
+    protected:
+        TimerList slots[LevelNum][SlotNum]; /**< 各階層のslot */
+        uint64_t occupied[LevelNum];        /**< 各階層でTimerが登録されているslotのbitmap */
+        uint64_t currentUnit;               /**< 処理済の時刻[slot] */
+        bool isStarted;                     /**< currentUnitを初期化済ならtrue */
+        uint64_t scheduledWakeUnit;         /**< TimerTaskが次に起床する予定の時刻[slot] */
+        IpcWaitSet* waitSet;                /**< TimerTaskの通知先 */
+        uint32_t waitSetBit;                /**< 通知に使うbit */
+
+        /**
+         * @brief baseTickより後で、periodTickの倍数+phaseTickになる最初の時刻を求めます
+         */
+        static uint64_t getAlignedTick(uint64_t baseTick, uint32_t periodTick, uint32_t phaseTick) {
+            if (periodTick == 0) return baseTick;
+            const uint64_t offsetTick = (baseTick + periodTick - (phaseTick % periodTick)) % periodTick;
+            return baseTick + (periodTick - offsetTick);
+        }
+
+        /**
+         * @brief tickを切り上げてslot単位の時刻に変換します
+         */
+        static uint64_t tickToUnit(uint64_t tick) {
+            const uint64_t resolutionTick = SysTimer::msToTick(FixedConfig::TimerWheelResolutionMs);
+            return (tick + resolutionTick - 1) / resolutionTick;
+        }
+
+        /**
+         * @brief slot単位の時刻をtickに変換します
+         */
+        static uint64_t unitToTick(uint64_t unit) {
+            return unit * SysTimer::msToTick(FixedConfig::TimerWheelResolutionMs);
+        }
+
+        /**
+         * @brief Timerを登録します
+         *
+         * @param entry 登録するTimer
+         * @param expiryTick 期限
+         * @param periodTick 周期, 0ならOne-Shot
+         */
+        void arm(TimerEntry& entry, uint64_t expiryTick, uint32_t periodTick);
+
+        /**
+         * @brief Callback呼び出し後の周期Timerを次の期限で登録します
+         */
+        void rearm(TimerEntry& entry);
+
+        /**
+         * @brief 所属しているlistからTimerを外します。Critical Section内から呼び出します
+         */
+        void detach(TimerEntry& entry);
+
+        /**
+         * @brief Timerを期限に対応するslotに入れます。Critical Section内から呼び出します
+         *
+         * @param entry 登録するTimer
+         * @param minUnit 登録できる最も早い時刻[slot], これより前の期限はこの時刻に丸めます
+         * @return uint64_t 登録した時刻[slot]
+         */
+        uint64_t insert(TimerEntry& entry, uint64_t minUnit);
+
+        /**
+         * @brief 階層levelで次に処理が必要になる時刻[slot]を求めます。Critical Section内から呼び出します
+         *
+         * @return uint64_t 時刻, 階層が空ならUINT64_MAX
+         */
+        uint64_t getNextEventUnit(uint32_t level) const;
+
+        /**
+         * @brief 全階層で次に処理が必要になる時刻[slot]を求めます。Critical Section内から呼び出します
+         */
+        uint64_t getNextEventUnit(void) const;
+
+        friend class TimerDispatcher;
+};
+
+#endif /* TIMERWHEEL_H */
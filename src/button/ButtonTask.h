@@ -5,15 +5,16 @@
 #include "../IpcQueueDefs.h"
 #include "../IpcQueue.h"
 #include "../SysTimer.h"
-#include "../FpsControlTask.h"
+#include "../coop/CoopFpsTask.h"
 
 /**
  * @brief Wio Terminalについている上部ボタンと4方向ボタンの値を取得するタスクです
+ * @note CoopExecutor上で動作するので、専用のStackは持ちません
  * 
  * @tparam N debounceする履歴値数
  */
 template<size_t N>
-class ButtonTask : public FpsControlTask {
+class ButtonTask : public CoopFpsTask {
     public:
 
         /**
@@ -24,7 +25,7 @@ class ButtonTask : public FpsControlTask {
          */
         ButtonTask(
             const SharedResourceDefs& resource,
-            IpcQueue<ButtonEventData>& sendQueue
+            PointToPointQueue<ButtonEventData>& sendQueue
         ): resource(resource), sendQueue(sendQueue) {}
 
         /**
@@ -32,22 +33,36 @@ class ButtonTask : public FpsControlTask {
          */
         virtual ~ButtonTask(void) {}
         const char* getName(void) override { return "ButtonTask"; }
+
+        /**
+         * @brief 送信待ちの領域も一杯で破棄したサンプル数を取得します
+         * 
+         * @return uint32_t 破棄したサンプル数
+         */
+        uint32_t getDroppedNum(void) { return this->droppedNum; }
     protected:
         // resource
         const SharedResourceDefs& resource; /**< 共有リソース群 */
-        IpcQueue<ButtonEventData>& sendQueue; /**< ボタン入力送信用 */
+        PointToPointQueue<ButtonEventData>& sendQueue; /**< ボタン入力送信用 */
         // variables
+        uint32_t oldRaw;      /**< 前回の入力値 */
         uint32_t oldDebounce; /**< 前回のdebounce済の値 */
         uint32_t recentsPtr;  /**< 次に書き込むrecentsのindex */
         uint32_t recents[N];  /**< debounce用の履歴値 */
+        uint32_t sequence;    /**< 次に送信するサンプルの通し番号 */
+        uint32_t droppedNum;  /**< 送信できずに破棄したサンプル数 */
+        size_t pendingNum;    /**< pendingに積まれているサンプル数 */
+        ButtonEventData pending[FixedConfig::ButtonTaskPendingNum]; /**< Queue Fullで送信できなかったサンプル */
+        GlobalConfigSubscriber configSubscriber; /**< configの再読み込み通知 */
 
         void setup(void) override {
             // configure
-            this->resource.config.operate([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+            this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
                 // fps
-                auto fps = GlobalConfigDefaultValues::ButtonTaskFps;
-                config.read(GlobalConfigKeys::ButtonTaskFps, fps);
-                this->setFps(fps);
+                this->setFps(config.get<GlobalConfigId::ButtonTaskFps>());
+            });
+            this->resource.config.write([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                config.subscribe(this->configSubscriber);
             });
 
             // port initialize
@@ -61,17 +76,23 @@ class ButtonTask : public FpsControlTask {
             pinMode(WIO_KEY_C,    INPUT_PULLUP);
 
             // variable initialize
+            this->oldRaw      = static_cast<uint32_t>(ButtonState::None);
             this->oldDebounce = static_cast<uint32_t>(ButtonState::None);
             this->recentsPtr  = 0;
             for (uint32_t i = 0; i < N; i++) {
                 this->recents[i] = 0;
             }
+            this->sequence   = 0;
+            this->droppedNum = 0;
+            this->pendingNum = 0;
         }
 
         bool loop(void) override {
-            // Queueに空きがない場合、edgeが抜け落ちる可能性があるので何もしない
-            if (this->sendQueue.emptyNum() == 0) {
-                return false; /**< no abort */            
+            // 再読み込みされた設定を反映する
+            if (this->configSubscriber.takeChanges().contains(GlobalConfigId::ButtonTaskFps)) {
+                this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                    this->setFps(config.get<GlobalConfigId::ButtonTaskFps>());
+                });
             }
 
             // get raw button input
@@ -99,21 +120,46 @@ class ButtonTask : public FpsControlTask {
             const uint32_t push    = currentDebounce   & (currentDebounce ^ this->oldDebounce); // 差分かつ今回いるもの
             const uint32_t release = this->oldDebounce & (currentDebounce ^ this->oldDebounce); // 差分かつ前回いるもの
 
-            // send Queue
+            // 入力に変化がなければ送らない(受信側を無駄に起こさない)
+            const bool isChanged = (raw != this->oldRaw) || (push != 0) || (release != 0);
+            this->oldRaw = raw;
+            this->oldDebounce = currentDebounce;
+            if (!isChanged) {
+                this->flushPending();
+                return false; /**< no abort */
+            }
+
+            // Queueに空きがなくてもサンプリングは止めず、送信待ちに積んでおく
             const ButtonEventData data = {
                 .raw = raw,
                 .debounce = currentDebounce,
                 .push = push,
                 .release = release,
-                .timestamp = SysTimer::getTickCount(),
+                .timestamp = SysTimer::getTickCount64(),
+                .sequence = this->sequence++,
             };
-            this->sendQueue.send(&data);
+            if (this->pendingNum < FixedConfig::ButtonTaskPendingNum) {
+                this->pending[this->pendingNum++] = data;
+            } else {
+                this->droppedNum++; // 受信側ではsequenceの欠番として見える
+            }
 
-            // update oldDebounce
-            this->oldDebounce = currentDebounce;
+            // send Queue, 送信待ちをまとめて送る
+            this->flushPending();
 
             return false; /**< no abort */            
         }
+
+        /**
+         * @brief 送信待ちのサンプルをQueueに送信し、送れなかった分を先頭に詰めます
+         */
+        void flushPending(void) {
+            const size_t sentNum = this->sendQueue.sendBatch(this->pending, this->pendingNum);
+            for (size_t i = sentNum; i < this->pendingNum; i++) {
+                this->pending[i - sentNum] = this->pending[i];
+            }
+            this->pendingNum -= sentNum;
+        }
 };
 
 #endif /* BUTTONTASK_H */
\ No newline at end of file
@@ -0,0 +1,133 @@
+#ifndef COOPEXECUTOR_H
+#define COOPEXECUTOR_H
+
+#include <cstdint>
+
+#include "../SysTimer.h"
+#include "../TaskBase.h"
+#include "../IpcWaitSet.h"
+#include "CoopTask.h"
+
+/**
+ * @brief 複数のCoopTaskを1つのRTOS Taskで協調的に実行します
+ * @note CoopTaskごとにStackを持たないため、低頻度のTaskをまとめるとStackとTCBの分だけRAMを節約できます
+ * @note 全CoopTaskが待機中の場合は、一番近い期限までIpcWaitSetで待機します
+ *
+ * @tparam TaskMax 登録できるCoopTask数
+ */
+template<size_t TaskMax>
+class CoopExecutor : public TaskBase {
+    public:
+        /**
+         * @brief Construct a new Coop Executor object
+         * 
+         * @param name Task名
+         */
+        CoopExecutor(const char* name): name(name), taskNum(0), pendingBits(0) {}
+
+        /**
+         * @brief Destroy the Coop Executor object
+         */
+        virtual ~CoopExecutor(void) {}
+        const char* getName(void) override { return this->name; }
+
+        /**
+         * @brief CoopTaskを登録します。createTask()の前に呼び出してください
+         * 
+         * @param task 登録するCoopTask
+         * @return true 登録成功
+         * @return false 登録数の上限
+         */
+        bool add(CoopTask& task) {
+            if (this->taskNum >= TaskMax) return false;
+            this->tasks[this->taskNum] = &task;
+            this->awaits[this->taskNum] = CoopAwait::yield();
+            this->taskNum++;
+            return true;
+        }
+
+        /**
+         * @brief COOP_WAIT_EVENT()で待機するためのIpcWaitSetを取得します
+         * @note IpcQueue/LatestValueをattachして得たbitをCOOP_WAIT_EVENT()に指定します
+         * 
+         * @return IpcWaitSet& 
+         */
+        IpcWaitSet& getWaitSet(void) { return this->waitSet; }
+
+    protected:
+        const char* name; /**< Task名 */
+        CoopTask* tasks[TaskMax]; /**< 登録されたCoopTask */
+        CoopAwait awaits[TaskMax]; /**< 各CoopTaskの再開条件 */
+        size_t taskNum; /**< 登録済のCoopTask数 */
+        uint32_t pendingBits; /**< 通知されたがまだ再開に使っていないbit */
+        IpcWaitSet waitSet; /**< CoopTaskのイベント待ちに使用する */
+
+        void setup(void) override {
+            this->waitSet.bindCurrentTask();
+            this->pendingBits = 0;
+            for (size_t i = 0; i < this->taskNum; i++) {
+                // restartTask()で作り直された場合も最初から実行する
+                this->tasks[i]->resetCoroutine();
+                this->awaits[i] = CoopAwait::yield();
+                this->tasks[i]->setup();
+            }
+        }
+
+        bool loop(void) override {
+            // 再開条件を満たしたものを順に進める
+            uint32_t consumedBits = 0;
+            for (size_t i = 0; i < this->taskNum; i++) {
+                const uint32_t nowTick = SysTimer::getTickCount();
+                if (!isReady(this->awaits[i], nowTick, this->pendingBits)) continue;
+
+                const uint32_t bits = this->pendingBits & this->awaits[i].bits;
+                consumedBits |= bits;
+                this->tasks[i]->setReceivedBits(bits);
+                this->awaits[i] = this->tasks[i]->step();
+            }
+            this->pendingBits &= ~consumedBits;
+
+            // 次に再開するものまで待つ
+            bool isAllDone = true;
+            uint32_t waitTick = portMAX_DELAY;
+            const uint32_t nowTick = SysTimer::getTickCount();
+            for (size_t i = 0; i < this->taskNum; i++) {
+                const CoopAwait& a = this->awaits[i];
+                if (a.kind == CoopAwaitKind::Done) continue;
+                isAllDone = false;
+
+                uint32_t remainTick = portMAX_DELAY;
+                if (isReady(a, nowTick, this->pendingBits)) {
+                    remainTick = 0;
+                } else if ((a.kind == CoopAwaitKind::Sleep) || a.hasTimeout) {
+                    remainTick = a.wakeTick - nowTick; // isReadyでなければ期限前
+                }
+                if (remainTick < waitTick) waitTick = remainTick;
+            }
+            if (isAllDone) return true; // abort
+
+            this->beat(waitTick);
+            this->pendingBits |= this->waitSet.wait(waitTick);
+            return false; // no abort
+        }
+
+        /**
+         * @brief 再開条件を満たしているか判定します
+         */
+        static bool isReady(const CoopAwait& a, uint32_t nowTick, uint32_t bits) {
+            const bool isExpired = static_cast<int32_t>(nowTick - a.wakeTick) >= 0;
+            switch (a.kind) {
+                case CoopAwaitKind::Yield:
+                    return true;
+                case CoopAwaitKind::Sleep:
+                    return isExpired;
+                case CoopAwaitKind::Event:
+                    return ((a.bits & bits) != 0) || (a.hasTimeout && isExpired);
+                case CoopAwaitKind::Done:
+                default:
+                    return false;
+            }
+        }
+};
+
+#endif /* COOPEXECUTOR_H */
@@ -0,0 +1,47 @@
+#include "CoopFpsTask.h"
+
+void CoopFpsTask::setFps(uint32_t fps) {
+    // fast
+    if (fps == 0) {
+        this->durationTick = 0;
+        return;
+    }
+    // Convert: [fps->duration]->tickCount
+    const uint32_t durationMs = 1000 / fps;
+    this->durationTick = SysTimer::msToTick(durationMs);
+}
+
+void CoopFpsTask::advanceDeadline(void) {
+    const uint32_t nowTick = SysTimer::getTickCount();
+    // fast
+    if (this->durationTick == 0) {
+        this->deadlineTick = nowTick;
+        return;
+    }
+
+    this->deadlineTick += this->durationTick;
+    // 間に合わなかった周期は飛ばす。期限ちょうどならすぐに再開できるので飛ばさない
+    const int32_t lateTick = static_cast<int32_t>(nowTick - this->deadlineTick);
+    if (lateTick > 0) {
+        const uint32_t skipNum = static_cast<uint32_t>(lateTick - 1) / this->durationTick + 1;
+        this->missedNum += skipNum;
+        this->deadlineTick += skipNum * this->durationTick;
+    }
+}
+
+CoopAwait CoopFpsTask::step(void) {
+    COOP_BEGIN();
+    this->isYieldRequested = false;
+    this->deadlineTick = SysTimer::getTickCount();
+    while (!this->loop()) {
+        // 再実行の要求があれば、他のCoopTaskを進めてから期限を進めずに呼び直す
+        if (this->isYieldRequested) {
+            this->isYieldRequested = false;
+            COOP_YIELD();
+            continue;
+        }
+        this->advanceDeadline();
+        COOP_SLEEP_UNTIL(this->deadlineTick);
+    }
+    COOP_END();
+}
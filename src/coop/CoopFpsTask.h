@@ -0,0 +1,69 @@
+#ifndef COOPFPSTASK_H
+#define COOPFPSTASK_H
+
+#include <cstdint>
+
+#include "../SysTimer.h"
+#include "CoopTask.h"
+
+/**
+ * @brief FpsControlTaskと同じsetup()/loop()の書き方で、CoopExecutor上で固定FPS実行するCoopTaskです
+ * @note 期限は絶対時刻で管理し、間に合わなかった周期はFpsCatchUpPolicy::Skip同様に飛ばします
+ */
+class CoopFpsTask : public CoopTask {
+    public:
+        /**
+         * @brief Construct a new Coop Fps Task object
+         */
+        CoopFpsTask(void): durationTick(SysTimer::secToTick(1)), deadlineTick(0), missedNum(0), isYieldRequested(false) {}
+
+        /**
+         * @brief Destroy the Coop Fps Task object
+         */
+        virtual ~CoopFpsTask(void) {}
+
+        /**
+         * @brief FPSを再設定します
+         * 
+         * @param fps 設定したいFPS
+         */
+        void setFps(uint32_t fps);
+
+        /**
+         * @brief 期限に間に合わなかった周期の数を取得します
+         * 
+         * @return uint32_t 間に合わなかった周期の数
+         */
+        uint32_t getMissedNum(void) { return this->missedNum; }
+
+        CoopAwait step(void) override;
+
+    protected:
+        uint32_t durationTick; /**< 周期 */
+        uint32_t deadlineTick; /**< 次にloop()を呼び出す時刻 */
+        uint32_t missedNum; /**< 期限に間に合わなかった周期の数 */
+        bool isYieldRequested; /**< loop()から再実行を要求された */
+
+        /**
+         * @brief 周期ごとに呼び出されます。戻り値でCoopTaskの継続可否を制御できます
+         * @note 他のCoopTaskを止めないよう、Blockingする処理は避けてください
+         * 
+         * @return true CoopTaskを終了する
+         * @return false CoopTaskを継続する
+         */
+        virtual bool loop(void) = 0;
+
+        /**
+         * @brief loop()の戻り後、次の周期を待たずに他のCoopTaskに譲ってからloop()を再度呼び出します
+         * @note Lockが取れなかった場合などに、Blockingせずに後から再試行するために使います
+         *       再試行でも失敗し続けると同じ優先度以下のTaskが動けなくなるため、連続して要求しないでください
+         */
+        void requestYield(void) { this->isYieldRequested = true; }
+
+        /**
+         * @brief 次の期限を求めます
+         */
+        void advanceDeadline(void);
+};
+
+#endif /* COOPFPSTASK_H */
@@ -0,0 +1,143 @@
+#ifndef COOPTASK_H
+#define COOPTASK_H
+
+#include <cstdint>
+
+#include "../SysTimer.h"
+
+/**
+ * @brief CoopTaskが中断した理由です
+ */
+enum class CoopAwaitKind : uint32_t {
+    Yield, /**< 他のCoopTaskに譲ってすぐに再開する */
+    Sleep, /**< wakeTickまで待つ */
+    Event, /**< bitsのいずれかが通知されるか、wakeTickまで待つ */
+    Done,  /**< 終了した */
+};
+
+/**
+ * @brief CoopTask::step()の戻り値で、次に再開する条件を表します
+ */
+struct CoopAwait {
+    CoopAwaitKind kind; /**< 中断した理由 */
+    uint32_t wakeTick;  /**< 再開する時刻 */
+    uint32_t bits;      /**< (kind=Event) 待機するIpcWaitSetのbit */
+    bool hasTimeout;    /**< (kind=Event) wakeTickでtimeoutするならtrue */
+
+    static CoopAwait yield(void) { return { CoopAwaitKind::Yield, 0, 0, false }; }
+    static CoopAwait sleepUntil(uint32_t tick) { return { CoopAwaitKind::Sleep, tick, 0, true }; }
+    static CoopAwait event(uint32_t bits, uint32_t timeoutTick) {
+        const bool hasTimeout = (timeoutTick != portMAX_DELAY);
+        return { CoopAwaitKind::Event, hasTimeout ? (SysTimer::getTickCount() + timeoutTick) : 0, bits, hasTimeout };
+    }
+    static CoopAwait done(void) { return { CoopAwaitKind::Done, 0, 0, false }; }
+};
+
+/**
+ * @brief step()の先頭に記述します
+ */
+#define COOP_BEGIN() switch (this->coopLine) { case 0:
+
+/**
+ * @brief step()の末尾に記述します。到達するとCoopTaskは終了します
+ */
+#define COOP_END() } this->coopLine = 0; return CoopAwait::done()
+
+/**
+ * @brief 他のCoopTaskに処理を譲ります
+ */
+#define COOP_YIELD() \
+    do { this->coopLine = __LINE__; return CoopAwait::yield(); case __LINE__:; } while (0)
+
+/**
+ * @brief 指定した時刻まで待機します
+ *
+ * @param tick 再開するSystick
+ */
+#define COOP_SLEEP_UNTIL(tick) \
+    do { this->coopLine = __LINE__; return CoopAwait::sleepUntil(tick); case __LINE__:; } while (0)
+
+/**
+ * @brief 指定した時間待機します
+ *
+ * @param tick 待機するtick数
+ */
+#define COOP_SLEEP_FOR(tick) COOP_SLEEP_UNTIL(SysTimer::getTickCount() + (tick))
+
+/**
+ * @brief IpcWaitSetのbitが通知されるか、timeoutまで待機します。再開後はgetReceivedBits()で通知されたbitを確認できます
+ * @note IpcQueue/LatestValueをCoopExecutor::getWaitSet()にattachして得たbitを指定し、再開後にnon-blockingで受信してください
+ *
+ * @param bits 待機するbit
+ * @param timeoutTick 最大待機tick数, portMAX_DELAYなら通知されるまで待つ
+ */
+#define COOP_WAIT_EVENT(bits, timeoutTick) \
+    do { this->coopLine = __LINE__; return CoopAwait::event((bits), (timeoutTick)); case __LINE__:; } while (0)
+
+/**
+ * @brief CoopExecutorで1つのRTOS Taskに相乗りさせる処理の基底クラスです
+ * @note C++14ではC++20 coroutineが使えないため、switch文で再開位置を記録するStackless Coroutine(protothread)として実装しています
+ *       step()はCOOP_BEGIN()で始めてCOOP_END()で終え、待機はCOOP_SLEEP_UNTIL()/COOP_WAIT_EVENT()などで行います
+ * @note 中断をまたいで値を保持したい変数はローカル変数ではなくメンバー変数にしてください。step()内で別のswitch文は使えません
+ * @note 同じRTOS Taskの他のCoopTaskが止まるため、step()内で長時間Blockingする処理は避けてください
+ *       IpcQueueの受信もnon-blockingで行ってください(SpscRingBackendのBlocking受信はTask Notificationが競合します)
+ */
+class CoopTask {
+    public:
+        /**
+         * @brief Construct a new Coop Task object
+         */
+        CoopTask(void): coopLine(0), receivedBits(0) {}
+
+        /**
+         * @brief Destroy the Coop Task object
+         */
+        virtual ~CoopTask(void) {}
+
+        /**
+         * @brief Get the Name object
+         * 
+         * @return const char* TaskName
+         */
+        virtual const char* getName(void) = 0;
+
+        /**
+         * @brief CoopExecutorのTask起動後1回だけ呼び出されます
+         */
+        virtual void setup(void) {}
+
+        /**
+         * @brief 次の中断まで処理を進めます
+         * 
+         * @return CoopAwait 次に再開する条件
+         */
+        virtual CoopAwait step(void) = 0;
+
+        /**
+         * @brief 再開時に通知されていたbitを設定します。CoopExecutorから呼び出されます
+         * 
+         * @param bits 通知されていたbit
+         */
+        void setReceivedBits(uint32_t bits) { this->receivedBits = bits; }
+
+        /**
+         * @brief 次のstep()を先頭から実行するようにします。CoopExecutorから呼び出されます
+         */
+        void resetCoroutine(void) {
+            this->coopLine = 0;
+            this->receivedBits = 0;
+        }
+
+    protected:
+        uint32_t coopLine; /**< 再開位置, COOP_*マクロで使用 */
+        uint32_t receivedBits; /**< 再開時に通知されていたbit */
+
+        /**
+         * @brief COOP_WAIT_EVENT()から再開した時に通知されていたbitを取得します
+         * 
+         * @return uint32_t 通知されていたbit, timeoutの場合は0
+         */
+        uint32_t getReceivedBits(void) { return this->receivedBits; }
+};
+
+#endif /* COOPTASK_H */
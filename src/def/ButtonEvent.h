@@ -27,7 +27,8 @@ struct ButtonEventData {
     uint32_t debounce;  /**< チャタリング除去済の値 */
     uint32_t push;      /**< debounceの内、release->push変化した値 */
     uint32_t release;   /**< debounceの内、push->release変化した値 */
-    uint32_t timestamp;
+    uint64_t timestamp; /**< 入力時のTickTimerの値, SysTimer::getTickCount64() */
+    uint32_t sequence;  /**< サンプルごとの通し番号、受信側で欠落検出に使用する */
 };
 
 
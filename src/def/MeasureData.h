@@ -5,14 +5,18 @@
 
 /**
  * @brief 測定データ
+ * @note Channelごとに測定周期が異なるので、各値がいつ測定されたかは個別のtimestampを参照してください
  */
 struct MeasureData {
-    float visibleLux;   /**< 明るさセンサの値 */
-    float tempature;    /**< 温度センサの値 */
-    float pressure;     /**< 気圧センサの値 */
-    float humidity;     /**< 湿度センサの値 */
-    float gas;          /**< ガスセンサの値 */
-    uint32_t timestamp; /**< for debug */
+    float visibleLux;        /**< 明るさセンサの値 */
+    float tempature;         /**< 温度センサの値 */
+    float pressure;          /**< 気圧センサの値 */
+    float humidity;          /**< 湿度センサの値 */
+    float gas;               /**< ガスセンサの値 */
+    uint64_t timestamp;      /**< 最後にいずれかのChannelを測定したTickTimerの値, SysTimer::getTickCount64() */
+    uint64_t luxTimestamp;   /**< visibleLuxを測定したTickTimerの値, 未測定なら0 */
+    uint64_t tphTimestamp;   /**< tempature/pressure/humidityを測定したTickTimerの値, 未測定なら0 */
+    uint64_t gasTimestamp;   /**< gasを測定したTickTimerの値, 未測定なら0 */
 };
 
 #endif /* MEASUREDATA_H */
\ No newline at end of file
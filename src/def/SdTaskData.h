@@ -0,0 +1,51 @@
+#ifndef SDTASKDATA_H
+#define SDTASKDATA_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include <Seeed_Arduino_FreeRTOS.h>
+
+class IpcWaitSet;
+
+/**
+ * @brief SdTaskへの要求の完了通知です
+ * @note 要求元で確保し、完了するまで破棄しないでください
+ * @note Task Notificationを直接使わないので、IpcWaitSetで待機しているTaskからも要求できます。通知先は必要なものだけ指定してください
+ */
+struct SdCompletion {
+    void (*callback)(void* context, bool isSuccess, size_t size); /**< 完了時にSdTask上で呼び出す関数, nullptrなら呼び出さない */
+    void* context; /**< callbackに渡す値 */
+    SemaphoreHandle_t doneSemaphore; /**< 完了時にxSemaphoreGiveするBinary Semaphore, nullptrなら通知しない。SdTask::waitForCompletion()で待てます */
+    IpcWaitSet* waitSet; /**< 完了時にwaitSetBitを通知するWaitSet, nullptrなら通知しない */
+    uint32_t waitSetBit; /**< waitSetのallocateBit()で割り当てたbit */
+    volatile bool isDone; /**< 完了したらtrue */
+    volatile bool isSuccess; /**< エラーなく完了していればtrue */
+    volatile size_t transferredSize; /**< 読み書きしたbyte数, (id=ReloadConfig) 値が変わった項目数 */
+    const char* volatile message; /**< (id=LoadConfig/ReloadConfig) Jsonの解析結果, それ以外はnullptr */
+};
+
+/**
+ * @brief SdTaskへの要求種類
+ */
+enum class SdRequestId : uint32_t {
+    FlushAppend, /**< append()で溜まったBufferを書き出す */
+    WriteFile, /**< Fileを新規作成して書き込む */
+    ReadFile, /**< Fileを読み出す */
+    LoadConfig, /**< GlobalConfigをSD Cardから読み出す */
+    SaveConfig, /**< GlobalConfigをSD Cardに保存する */
+    ReloadConfig, /**< GlobalConfigを読み直して変更を各Taskに通知する */
+};
+
+/**
+ * @brief SdTaskへの要求
+ */
+struct SdRequest {
+    SdRequestId id; /**< 要求種別 */
+    const char* path; /**< (id=WriteFile/ReadFile) 対象のFile Path */
+    uint8_t* buffer; /**< (id=WriteFile) 書き込むデータ, (id=ReadFile) 読み出し先。完了するまで保持すること */
+    size_t size; /**< (id=WriteFile) 書き込むbyte数, (id=ReadFile) bufferのbyte数 */
+    SdCompletion* completion; /**< 完了通知先, nullptrなら通知しない */
+};
+
+#endif /* SDTASKDATA_H */
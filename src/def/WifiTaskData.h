@@ -11,7 +11,7 @@
 struct WifiStatusData {
     uint8_t ipAddr[4]; /**< ip address, isConnected=falseならdon't care */
     wl_status_t status; /**< 接続ステータス */
-    uint32_t timestamp; /**< 更新時のTickTimerの値 */
+    uint64_t timestamp; /**< 更新時のTickTimerの値, SysTimer::getTickCount64() */
 };
 
 /**
@@ -25,12 +25,10 @@ enum class WifiTaskRequestId : uint32_t {
 
 /**
  * @brief WifiTaskへの要求
+ * @note 測定データはWifiTaskがLatestValueから直接読み出すので、要求には含めない
  */
 struct WifiTaskRequest {
     WifiTaskRequestId id; /**< 要求種別 */
-    union {
-        MeasureData measureData; /**< (id=SendSensorData) 測定データ */
-    } data; /**< Data Body、領域がもったいないのでRequestIdごとに切り替えて使う */
 };
 
 /**
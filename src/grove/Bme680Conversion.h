@@ -0,0 +1,125 @@
+#ifndef BME680CONVERSION_H
+#define BME680CONVERSION_H
+
+#include <seeed_bme680.h>
+
+#include "../SysTimer.h"
+
+/**
+ * @brief BME680のForced Modeの測定を開始(trigger)と読み出し(collect)に分けて行います
+ * @note Seeed_BME680::read_sensor_data()は温湿度/気圧の変換とガスヒーターの加熱が終わるまで呼び出し元で待ち続けるので、
+ *       Seeed_BME680::sensor_paramを使ってBosch APIを直接呼び出し、変換中は他のセンサの読み出しやSleepができるようにします
+ * @note 結果はread_sensor_data()と同じくSeeed_BME680::sensor_result_valueに書き込みます
+ * @note ガスを測定しない変換ではヒーターを止めるので、変換時間と消費電力が減ります
+ */
+class Bme680Conversion {
+    public:
+        /**
+         * @brief 変換の状態です
+         */
+        enum class Phase : uint8_t {
+            Idle,       /**< 変換していない */
+            Converting, /**< trigger()済、readyTickまで変換中 */
+        };
+
+        /**
+         * @brief Construct a new Bme680 Conversion object
+         *
+         * @param bme680 対象のセンサ。init()済であること
+         */
+        Bme680Conversion(Seeed_BME680& bme680): bme680(bme680), phase(Phase::Idle), readyTick(0) {}
+
+        /**
+         * @brief Destroy the Bme680 Conversion object
+         */
+        virtual ~Bme680Conversion(void) {}
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        Bme680Conversion(const Bme680Conversion&) = delete;
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        Bme680Conversion& operator=(const Bme680Conversion&) = delete;
+
+        /**
+         * @brief Forced Modeで1回分の変換を開始します。I2Cの書き込みのみで待機はしません
+         *
+         * @param isGasEnabled trueならヒーターを加熱してガスも測定する
+         * @return true 開始成功
+         * @return false I2C通信に失敗
+         */
+        bool trigger(bool isGasEnabled) {
+            struct bme680_dev& dev = this->bme680.sensor_param;
+            // ヒーターの有無が前回と変わる場合のみ設定を書き込む
+            const uint8_t runGas = isGasEnabled ? BME680_ENABLE_GAS_MEAS : BME680_DISABLE_GAS_MEAS;
+            if (dev.gas_sett.run_gas != runGas) {
+                const uint8_t previousRunGas = dev.gas_sett.run_gas;
+                dev.gas_sett.run_gas = runGas;
+                if (bme680_set_sensor_settings(BME680_GAS_SENSOR_SEL, &dev) != BME680_OK) {
+                    dev.gas_sett.run_gas = previousRunGas;
+                    this->phase = Phase::Idle;
+                    return false;
+                }
+            }
+            dev.power_mode = BME680_FORCED_MODE;
+            if (bme680_set_sensor_mode(&dev) != BME680_OK) {
+                this->phase = Phase::Idle;
+                return false;
+            }
+            // 変換時間はOversamplingとヒーター加熱時間の設定から求まる
+            uint16_t durationMs = 0;
+            bme680_get_profile_dur(&durationMs, &dev);
+            this->readyTick = SysTimer::getTickCount() + SysTimer::msToTick(durationMs);
+            this->phase = Phase::Converting;
+            return true;
+        }
+
+        /**
+         * @brief 変換が完了するまでTaskをSleepさせます。Busy-waitはしません
+         */
+        void sleepUntilReady(void) {
+            if (this->phase != Phase::Converting) return;
+            const int32_t remainTick = static_cast<int32_t>(this->readyTick - SysTimer::getTickCount());
+            if (remainTick > 0) {
+                vTaskDelay(static_cast<TickType_t>(remainTick));
+            }
+        }
+
+        /**
+         * @brief 変換結果を読み出し、Seeed_BME680::sensor_result_valueに書き込みます
+         * @note ガスの値はヒーターを加熱して安定していた場合のみ更新します
+         *
+         * @param isGasUpdated ガスの値を更新したかの書き込み先
+         * @return true 読み出し成功
+         * @return false 変換していない、I2C通信に失敗、もしくは変換が終わっていない
+         */
+        bool collect(bool& isGasUpdated) {
+            isGasUpdated = false;
+            if (this->phase != Phase::Converting) return false;
+            this->phase = Phase::Idle;
+
+            struct bme680_field_data data;
+            if (bme680_get_sensor_data(&data, &this->bme680.sensor_param) != BME680_OK) return false;
+            if ((data.status & BME680_NEW_DATA_MSK) == 0) return false;
+
+            auto& result = this->bme680.sensor_result_value;
+            result.temperature = data.temperature / 100.0f;
+            result.pressure    = static_cast<float>(data.pressure);
+            result.humidity    = data.humidity / 1000.0f;
+            if ((this->bme680.sensor_param.gas_sett.run_gas == BME680_ENABLE_GAS_MEAS) && ((data.status & BME680_HEAT_STAB_MSK) != 0)) {
+                result.gas = static_cast<float>(data.gas_resistance);
+                isGasUpdated = true;
+            }
+            return true;
+        }
+
+    protected:
+        Seeed_BME680& bme680; /**< 対象のセンサ */
+        Phase phase; /**< 変換の状態 */
+        uint32_t readyTick; /**< 変換が完了する予定のTick, SysTimer::getTickCount() */
+};
+
+#endif /* BME680CONVERSION_H */
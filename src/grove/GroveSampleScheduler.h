@@ -0,0 +1,133 @@
+#ifndef GROVESAMPLESCHEDULER_H
+#define GROVESAMPLESCHEDULER_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "../SysTimer.h"
+
+/**
+ * @brief GroveTaskで個別の周期で測定するChannelです
+ */
+enum class GroveChannel : uint8_t {
+    Lux, /**< 照度(TSL2561) */
+    Tph, /**< 温度/気圧/湿度(BME680, ヒーターなし) */
+    Gas, /**< ガス(BME680, ヒーターあり)。温度/気圧/湿度も同時に測定される */
+    Count,
+};
+
+/**
+ * @brief Channelごとの測定周期から、次に測定すべきChannelと待機時間を決めます
+ * @note 期限は前回の期限に周期を加えて求めるので、起床の遅れで周期がずれることはありません。周期以上遅れた場合は今を基準にやり直します
+ * @note 期限がGroupWindow以内に迫っているChannelは一緒に測定し、起床回数とI2Cの通信回数を減らします
+ */
+class GroveSampleScheduler {
+    public:
+        /**
+         * @brief Construct a new Grove Sample Scheduler object
+         *
+         * @param groupWindowMs 期限前でも一緒に測定する猶予[ms]
+         */
+        GroveSampleScheduler(uint32_t groupWindowMs): groupWindowTick(SysTimer::msToTick(groupWindowMs)) {
+            for (size_t i = 0; i < ChannelNum; i++) {
+                this->periodTick[i] = SysTimer::secToTick(1);
+                this->dueTick[i] = 0;
+            }
+        }
+
+        /**
+         * @brief Destroy the Grove Sample Scheduler object
+         */
+        virtual ~GroveSampleScheduler(void) {}
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        GroveSampleScheduler(const GroveSampleScheduler&) = delete;
+
+        /**
+         * @brief Copy Constructorは禁止
+         */
+        GroveSampleScheduler& operator=(const GroveSampleScheduler&) = delete;
+
+        /**
+         * @brief 測定周期を設定します。次の期限は今から1周期後になります
+         *
+         * @param channel 対象のChannel
+         * @param periodMs 測定周期[ms], 0は1tickとして扱います
+         * @param nowTick 現在のSystick
+         */
+        void setPeriodMs(GroveChannel channel, uint32_t periodMs, uint32_t nowTick) {
+            const size_t index = static_cast<size_t>(channel);
+            const uint32_t tick = SysTimer::msToTick(periodMs);
+            this->periodTick[index] = (tick == 0) ? 1 : tick;
+            this->dueTick[index] = nowTick + this->periodTick[index];
+        }
+
+        /**
+         * @brief 起動直後にすべてのChannelを測定させます
+         *
+         * @param nowTick 現在のSystick
+         */
+        void makeAllDue(uint32_t nowTick) {
+            for (size_t i = 0; i < ChannelNum; i++) {
+                this->dueTick[i] = nowTick;
+            }
+        }
+
+        /**
+         * @brief 指定されたChannelを今測定すべきか判定します
+         *
+         * @param channel 対象のChannel
+         * @param nowTick 現在のSystick
+         * @return true 期限を過ぎているか、GroupWindow以内に迫っている
+         * @return false まだ測定しない
+         */
+        bool isDue(GroveChannel channel, uint32_t nowTick) const {
+            const size_t index = static_cast<size_t>(channel);
+            return static_cast<int32_t>(nowTick + this->groupWindowTick - this->dueTick[index]) >= 0;
+        }
+
+        /**
+         * @brief 測定したChannelの期限を次の周期に進めます
+         *
+         * @param channel 対象のChannel
+         * @param nowTick 測定したSystick
+         */
+        void markSampled(GroveChannel channel, uint32_t nowTick) {
+            const size_t index = static_cast<size_t>(channel);
+            const uint32_t nextDueTick = this->dueTick[index] + this->periodTick[index];
+            // 1周期以上遅れていれば、過ぎた周期を飛ばして今を基準にする
+            if (static_cast<int32_t>(nextDueTick - nowTick) <= 0) {
+                this->dueTick[index] = nowTick + this->periodTick[index];
+                return;
+            }
+            this->dueTick[index] = nextDueTick;
+        }
+
+        /**
+         * @brief 最も近い期限までの待機時間を取得します
+         *
+         * @param nowTick 現在のSystick
+         * @return uint32_t 待機tick, 期限を過ぎているChannelがあれば0
+         */
+        uint32_t getWaitTick(uint32_t nowTick) const {
+            int32_t minRemainTick = INT32_MAX;
+            for (size_t i = 0; i < ChannelNum; i++) {
+                const int32_t remainTick = static_cast<int32_t>(this->dueTick[i] - nowTick);
+                if (remainTick < minRemainTick) {
+                    minRemainTick = remainTick;
+                }
+            }
+            return (minRemainTick > 0) ? static_cast<uint32_t>(minRemainTick) : 0;
+        }
+
+    protected:
+        static constexpr size_t ChannelNum = static_cast<size_t>(GroveChannel::Count); /**< Channel数 */
+
+        const uint32_t groupWindowTick; /**< 期限前でも一緒に測定する猶予 */
+        uint32_t periodTick[ChannelNum]; /**< Channelごとの測定周期 */
+        uint32_t dueTick[ChannelNum]; /**< Channelごとの次の期限 */
+};
+
+#endif /* GROVESAMPLESCHEDULER_H */
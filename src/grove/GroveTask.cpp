@@ -1,88 +1,108 @@
 #include "../SysTimer.h"
+#include "../ScopedTimer.h"
 
 #include "GroveTask.h"
 
-/**
- * @brief センサの値を出力します
- * 
- * @tparam T print, printlnが使えるclass
- * @param serial Serial Peripheral/ File Handle
- * @param data 測定したSensor Data
- * @param isPrintTimestamp Timestampを出力するか
- */
-template<typename T>
-static void printData(T& oStream, const MeasureData& data, bool isPrintTimestamp) {
-    oStream.print(data.visibleLux);
-    oStream.print(",");
-    oStream.print(data.tempature);
-    oStream.print(",");
-    oStream.print(data.pressure);
-    oStream.print(",");
-    oStream.print(data.humidity);
-    oStream.print(",");
-    oStream.print(data.gas);
-    if (isPrintTimestamp) {
-        oStream.print(",");
-        oStream.print(data.timestamp);
-    }
-    oStream.println(",");
-}
-
-
 void GroveTask::setup(void) {
     // configure
-    this->resource.config.operate([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
-        // fps
-        auto fps = GlobalConfigDefaultValues::GroveTaskFps;
-        config.read(GlobalConfigKeys::GroveTaskFps, fps);
-        this->setFps(fps);
-        // debug print
-        this->isPrintSerial = GlobalConfigDefaultValues::GroveTaskPrintSerial;
-        this->isPrintFile = GlobalConfigDefaultValues::GroveTaskPrintFile;
-        config.read(GlobalConfigKeys::GroveTaskPrintSerial, this->isPrintSerial);
-        config.read(GlobalConfigKeys::GroveTaskPrintFile, this->isPrintFile);
+    this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+        this->applyConfig(config, GlobalConfigChangeSet::all());
+    });
+    this->resource.config.write([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+        config.subscribe(this->configSubscriber);
     });
+    // 固定FPSではなく、configの再読み込みか次のChannelの期限で起床する
+    this->configSubscriber.attachWaitSet(this->configWaitSet);
+    this->setWaitSet(&this->configWaitSet);
 
     // initialize sensor
     // I2C Deviceで問題があったときにsetupでハングアップしないようにタスク内で初期化する
     this->lightSensor.init();
     this->bme680.init();
+
+    // 起動直後は全Channelを測定する
+    this->scheduler.makeAllDue(SysTimer::getTickCount());
+}
+
+void GroveTask::applyConfig(const GlobalConfig<FixedConfig::ConfigAllocateSize>& config, const GlobalConfigChangeSet& changes) {
+    const uint32_t nowTick = SysTimer::getTickCount();
+    if (changes.contains(GlobalConfigId::GroveLuxPeriodMs)) {
+        this->scheduler.setPeriodMs(GroveChannel::Lux, config.get<GlobalConfigId::GroveLuxPeriodMs>(), nowTick);
+    }
+    if (changes.contains(GlobalConfigId::GroveTphPeriodMs)) {
+        this->scheduler.setPeriodMs(GroveChannel::Tph, config.get<GlobalConfigId::GroveTphPeriodMs>(), nowTick);
+    }
+    if (changes.contains(GlobalConfigId::GroveGasPeriodMs)) {
+        this->scheduler.setPeriodMs(GroveChannel::Gas, config.get<GlobalConfigId::GroveGasPeriodMs>(), nowTick);
+    }
 }
 
 bool GroveTask::loop(void) {
-    // Queueに空きがない場合、処理しても仕方ないので抜ける
-    if (this->sendQueue.emptyNum() == 0) {
-        return false; /**< no abort */            
+    // 再読み込みされた設定を反映する
+    const GlobalConfigChangeSet changes = this->configSubscriber.takeChanges();
+    if (!changes.isEmpty()) {
+        this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+            this->applyConfig(config, changes);
+        });
     }
 
-    // get sensor datas
-    bme680.read_sensor_data();
-    const MeasureData data = {
-        .visibleLux = lightSensor.readVisibleLux(),
-        .tempature  = bme680.sensor_result_value.temperature,
-        .pressure   = bme680.sensor_result_value.pressure / 100.0f,
-        .humidity   = bme680.sensor_result_value.humidity,
-        .gas        = bme680.sensor_result_value.gas / 1000.0f,
-        .timestamp  = SysTimer::getTickCount(),
-    };
-    this->sendQueue.send(&data);
+    // 期限が来ているChannelをまとめて測定する。ガスの変換では温度/気圧/湿度も得られるので1回の変換で済ませる
+    const uint32_t nowTick = SysTimer::getTickCount();
+    const bool isLuxDue = this->scheduler.isDue(GroveChannel::Lux, nowTick);
+    const bool isGasDue = this->scheduler.isDue(GroveChannel::Gas, nowTick);
+    const bool isTphDue = isGasDue || this->scheduler.isDue(GroveChannel::Tph, nowTick);
+    // 設定変更のみで起床した場合
+    if (!isLuxDue && !isTphDue) return false;
 
-    // debug print
-    if (this->isPrintSerial) {
-        this->resource.serial.operateCritial([&](Serial_& serial){
-            printData(serial, data, false);
-        });
+    // get sensor datas
+    static ScopedTimerStats bme680TimerStats("GroveTask::bme680");
+    static ScopedTimerStats lightSensorTimerStats("GroveTask::lightSensor");
+    // 1. BME680の変換を開始する。ガスを測定しない場合はヒーターを止める。変換中はI2Cを使わないので、他のセンサを読み出せる
+    bool isTriggered = false;
+    if (isTphDue) {
+        ScopedTimer timer(bme680TimerStats);
+        isTriggered = this->bme680Conversion.trigger(isGasDue);
     }
-    if (this->isPrintFile) {
-        this->resource.sd.operateCritial([&](SDFS& sd){
-            File f = sd.open(FixedConfig::GroveTaskPrintFilePath, FILE_APPEND);
-            // 開けなければ失敗
-            if (!f) return;
-            // 1行追記
-            printData(f, data, true);
-            // 終わり
-            f.close();
-        });
+    // 2. BME680の変換と並行して照度センサを読み出す
+    if (isLuxDue) {
+        ScopedTimer timer(lightSensorTimerStats);
+        this->latestData.visibleLux = lightSensor.readVisibleLux();
+        this->latestData.luxTimestamp = SysTimer::getTickCount64();
+        this->scheduler.markSampled(GroveChannel::Lux, nowTick);
+    }
+    // 3. 残りの変換時間はSleepして他のTaskにCPUを譲り、完了したら読み出す。失敗した場合は前回の値を使い、次の周期で測定し直す
+    bool isTphUpdated = false;
+    if (isTriggered) {
+        this->bme680Conversion.sleepUntilReady();
+        bool isGasUpdated = false;
+        {
+            ScopedTimer timer(bme680TimerStats);
+            isTphUpdated = this->bme680Conversion.collect(isGasUpdated);
+        }
+        const uint64_t timestamp = SysTimer::getTickCount64();
+        if (isTphUpdated) {
+            this->latestData.tempature    = bme680.sensor_result_value.temperature;
+            this->latestData.pressure     = bme680.sensor_result_value.pressure / 100.0f;
+            this->latestData.humidity     = bme680.sensor_result_value.humidity;
+            this->latestData.tphTimestamp = timestamp;
+        }
+        if (isGasUpdated) {
+            this->latestData.gas          = bme680.sensor_result_value.gas / 1000.0f;
+            this->latestData.gasTimestamp = timestamp;
+        }
+    }
+    if (isTphDue) {
+        this->scheduler.markSampled(GroveChannel::Tph, nowTick);
+    }
+    if (isGasDue) {
+        this->scheduler.markSampled(GroveChannel::Gas, nowTick);
+    }
+
+    // 最新値は毎回更新し、時系列の配信は温度/気圧/湿度の周期で行う(照度の周期でLoggerの出力を増やさない)
+    this->latestData.timestamp = SysTimer::getTickCount64();
+    this->measureData.publish(this->latestData);
+    if (isTphUpdated) {
+        this->measureTopic.publish(this->latestData);
     }
 
     return false; /**< no abort */
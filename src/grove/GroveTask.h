@@ -6,11 +6,16 @@
 
 #include "../SharedResourceDefs.h"
 #include "../IpcQueueDefs.h"
-#include "../IpcQueue.h"
+#include "../LatestValue.h"
 #include "../FpsControlTask.h"
+#include "../IpcWaitSet.h"
+#include "Bme680Conversion.h"
+#include "GroveSampleScheduler.h"
 
 /**
  * @brief Grove端子に接続されたIICセンサの値を収集するTaskです
+ * @note 照度、温度/気圧/湿度、ガスをそれぞれの周期で測定します。固定FPSではなく、次に期限が来るChannelの時刻まで待機します
+ * @note BME680は変換開始と読み出しを分けて行い、変換中に照度センサを読み出したうえで残りの変換時間はSleepします
  */
 class GroveTask : public FpsControlTask {
     public:
@@ -18,35 +23,63 @@ class GroveTask : public FpsControlTask {
          * @brief Construct a new Grove Task object
          * 
          * @param resource 共有リソース群
-         * @param sendQueue センサー測定値の送信Queue
+         * @param measureData センサー測定値の公開先
+         * @param measureTopic センサー測定値の配信先
          * @param lightSensor 照度センサー。初期化はTask内で行う
          * @param bme680 温湿度、ガスセンサ。初期化はTask内で行う
          */
         GroveTask(
             const SharedResourceDefs& resource,
-            IpcQueue<MeasureData>& sendQueue,
+            LatestValue<MeasureData>& measureData,
+            MeasureDataTopic& measureTopic,
             TSL2561_CalculateLux& lightSensor,
              Seeed_BME680& bme680
-        ): resource(resource), sendQueue(sendQueue), lightSensor(lightSensor), bme680(bme680) {}
+        ): resource(resource), measureData(measureData), measureTopic(measureTopic), lightSensor(lightSensor), bme680(bme680), bme680Conversion(bme680), scheduler(FixedConfig::GroveSampleGroupWindowMs), latestData() {}
 
         /**
          * @brief Destroy the Grove Task object
          */
         virtual ~GroveTask(void) {}
         const char* getName(void) override { return "GroveTask"; }
+        /**
+         * @brief I2Cでハングアップした場合は、作り直してセンサを初期化し直す
+         * @note configのロックを保持したまま止まっている場合は、WatchdogTaskが再起動に切り替えます
+         */
+        WatchdogAction getWatchdogAction(void) override { return WatchdogAction::Restart; }
     protected:
         // resource
         const SharedResourceDefs& resource; /**< 共有リソース群 */
-        IpcQueue<MeasureData>& sendQueue; /**< 測定データの送信先 */
+        LatestValue<MeasureData>& measureData; /**< 測定データの公開先、読み出し側の状態に関わらず待たずに書き込める */
+        MeasureDataTopic& measureTopic; /**< 測定データの配信先、Subscriberの追加はGroveTaskに影響しない */
         // sensor
         TSL2561_CalculateLux& lightSensor;
         Seeed_BME680& bme680;
-        // configから読み出し
-        bool isPrintSerial; /**< センサ取得値をSerial出力 */
-        bool isPrintFile; /**< センサ取得値をSD Card出力 */
+        Bme680Conversion bme680Conversion; /**< BME680の変換開始と読み出しを分けて行う */
+        // ローカル変数
+        GroveSampleScheduler scheduler; /**< Channelごとの測定周期の管理 */
+        MeasureData latestData; /**< Channelごとに最後に測定した値, 測定していないChannelは前回の値を公開する */
+        IpcWaitSet configWaitSet; /**< configの再読み込み待ち */
+        GlobalConfigSubscriber configSubscriber; /**< configの再読み込み通知 */
 
         void setup(void) override;
         bool loop(void) override;
+
+        /**
+         * @brief 次に期限が来るChannelまでの時間を返します
+         *
+         * @return uint32_t 最大待機tick
+         */
+        uint32_t getIdleTimeoutTick(void) override {
+            return this->scheduler.getWaitTick(SysTimer::getTickCount());
+        }
+
+        /**
+         * @brief configの値を反映します
+         *
+         * @param config 反映するconfig
+         * @param changes 反映する項目
+         */
+        void applyConfig(const GlobalConfig<FixedConfig::ConfigAllocateSize>& config, const GlobalConfigChangeSet& changes);
 };
 
 #endif /* GROVETASK_H */
\ No newline at end of file
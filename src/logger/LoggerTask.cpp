@@ -0,0 +1,157 @@
+#include <cstring>
+
+#include "../ScopedTimer.h"
+
+#include "LoggerTask.h"
+
+/**
+ * @brief 1行分の出力を溜めるPrintです
+ * @note 溢れた分は捨てます
+ */
+class LineBuffer : public Print {
+    public:
+        LineBuffer(void): size(0) {}
+
+        size_t write(uint8_t c) override {
+            if (this->size >= sizeof(this->buffer)) return 0;
+            this->buffer[this->size++] = c;
+            return 1;
+        }
+
+        size_t write(const uint8_t* src, size_t n) override {
+            const size_t remain = sizeof(this->buffer) - this->size;
+            const size_t copySize = (n < remain) ? n : remain;
+            memcpy(&this->buffer[this->size], src, copySize);
+            this->size += copySize;
+            return copySize;
+        }
+
+        const uint8_t* data(void) const { return this->buffer; }
+        size_t length(void) const { return this->size; }
+        void clear(void) { this->size = 0; }
+    protected:
+        uint8_t buffer[128];
+        size_t size;
+};
+
+/**
+ * @brief センサの値を出力します
+ * 
+ * @tparam T print, printlnが使えるclass
+ * @param serial Serial Peripheral/ File Handle
+ * @param data 測定したSensor Data
+ * @param isPrintTimestamp Timestampを出力するか
+ */
+template<typename T>
+static void printData(T& oStream, const MeasureData& data, bool isPrintTimestamp) {
+    oStream.print(data.visibleLux);
+    oStream.print(",");
+    oStream.print(data.tempature);
+    oStream.print(",");
+    oStream.print(data.pressure);
+    oStream.print(",");
+    oStream.print(data.humidity);
+    oStream.print(",");
+    oStream.print(data.gas);
+    if (isPrintTimestamp) {
+        oStream.print(",");
+        SysTimer::print64(oStream, data.timestamp);
+    }
+    oStream.println(",");
+}
+
+void LoggerTask::setup(void) {
+    // configure
+    this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+        // fps
+        this->setFps(config.get<GlobalConfigId::LoggerTaskFps>());
+        // 出力先, 互換性のためGroveTaskのKeyを使う
+        this->isPrintSerial = config.get<GlobalConfigId::GroveTaskPrintSerial>();
+        this->isPrintFile = config.get<GlobalConfigId::GroveTaskPrintFile>();
+    });
+    // 出力先の変更は購読し直しになるので反映しない
+    this->resource.config.write([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+        config.subscribe(this->configSubscriber);
+    });
+
+    // 使う出力先だけ購読する
+    // Serialは最新の値が見たいので古いものから捨て、Fileは記録の連続性を優先して新しいものを捨てる
+    if (this->isPrintSerial) {
+        this->isPrintSerial = this->measureTopic.subscribe(FixedConfig::MeasureDataTopicDepth, PubSubOverflowPolicy::DropOldest, this->serialSubscriber);
+    }
+    if (this->isPrintFile) {
+        this->isPrintFile = this->measureTopic.subscribe(FixedConfig::MeasureDataTopicDepth, PubSubOverflowPolicy::DropNewest, this->fileSubscriber);
+    }
+}
+
+bool LoggerTask::loop(void) {
+    // 再読み込みされた設定を反映する
+    if (this->configSubscriber.takeChanges().contains(GlobalConfigId::LoggerTaskFps)) {
+        this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+            this->setFps(config.get<GlobalConfigId::LoggerTaskFps>());
+        });
+    }
+
+    // 同じCoopExecutorの他のCoopTaskを止めないよう、SerialのLockは待たずに取れた場合のみ出力する
+    bool isSerialBusy = false;
+    if (this->isPrintSerial && (this->measureTopic.remainNum(this->serialSubscriber) > 0)) {
+        isSerialBusy = !this->resource.serial.tryOperate(0, [&](Serial_& serial){
+            this->measureTopic.receiveAll(this->serialSubscriber, [&](const MeasureData& data) {
+                printData(serial, data, false);
+            });
+        });
+    }
+    // Serialからの要求で統計を出力する, 取れなかった場合の入力は次回に処理する
+    isSerialBusy |= !this->resource.serial.tryOperate(0, [&](Serial_& serial){
+        if (serial.available() == 0) return;
+        switch (serial.read()) {
+            case 's': // Lock競合統計
+                this->resource.serial.printStats(serial);
+                this->resource.sd.printStats(serial);
+                this->resource.config.printStats(serial);
+                break;
+            case 'r': // configの再読み込み, 結果はSdTaskが出力する
+                if (!this->sdTask.reloadConfig(nullptr)) {
+                    serial.println("[config] reload request failed");
+                }
+                break;
+            case 't': // Taskの実行統計
+                TaskBase::forEach([&](TaskBase& task){
+                    TaskProfile profile;
+                    if (task.getProfile(profile)) {
+                        printTaskProfile(serial, task.getName(), profile);
+                    }
+                });
+                // 区間ごとの処理時間
+                ScopedTimerStats::forEach([&](ScopedTimerStats& stats){
+                    ScopedTimerProfile profile;
+                    if (stats.get(profile)) {
+                        printScopedTimerProfile(serial, stats.getName(), profile);
+                    }
+                });
+                break;
+            default:
+                break;
+        }
+    });
+
+    if (this->isPrintFile) {
+        // 1行ずつ整形してSdTaskのBufferに積む。書き出しはSdTaskで行われる
+        LineBuffer line;
+        this->measureTopic.receiveAll(this->fileSubscriber, [&](const MeasureData& data) {
+            line.clear();
+            printData(line, data, true);
+            this->sdTask.append(FixedConfig::LoggerTaskPrintFilePath, line.data(), line.length());
+        });
+    }
+
+    // Lockが取れなかった分は1度だけ他のCoopTaskに譲ってから再試行し、それでも取れなければ次の周期に回す
+    if (isSerialBusy && !this->isSerialRetrying) {
+        this->isSerialRetrying = true;
+        this->requestYield();
+    } else {
+        this->isSerialRetrying = false;
+    }
+
+    return false; /**< no abort */
+}
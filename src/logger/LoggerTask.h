@@ -0,0 +1,55 @@
+#ifndef LOGGERTASK_H
+#define LOGGERTASK_H
+
+#include "../SharedResourceDefs.h"
+#include "../IpcQueueDefs.h"
+#include "../PubSubTopic.h"
+#include "../TaskBase.h"
+#include "../coop/CoopFpsTask.h"
+#include "../sd/SdTask.h"
+
+/**
+ * @brief 測定データをSerial/SD Cardに記録するTaskです
+ * @note MeasureDataTopicのSubscriberとして動作するので、GroveTaskの処理時間には影響しません
+ * @note SD Cardへの書き込みはSdTaskに委譲するので、File操作の完了は待ちません
+ * @note CoopExecutor上で動作するので、専用のStackは持ちません。SerialのLockは待たずに、取れなければ後から再試行します
+ */
+class LoggerTask : public CoopFpsTask {
+    public:
+        /**
+         * @brief Construct a new Logger Task object
+         * 
+         * @param resource 共有リソース群
+         * @param measureTopic 測定データの配信元
+         * @param sdTask SD Card出力の委譲先
+         */
+        LoggerTask(
+            const SharedResourceDefs& resource,
+            MeasureDataTopic& measureTopic,
+            SdTask& sdTask
+        ): resource(resource), measureTopic(measureTopic), sdTask(sdTask), isSerialRetrying(false) {}
+
+        /**
+         * @brief Destroy the Logger Task object
+         */
+        virtual ~LoggerTask(void) {}
+        const char* getName(void) override { return "LoggerTask"; }
+    protected:
+        // resource
+        const SharedResourceDefs& resource; /**< 共有リソース群 */
+        MeasureDataTopic& measureTopic; /**< 測定データの配信元 */
+        SdTask& sdTask; /**< SD Card出力の委譲先 */
+        // configから読み出し
+        bool isPrintSerial; /**< センサ取得値をSerial出力 */
+        bool isPrintFile; /**< センサ取得値をSD Card出力 */
+        // ローカル変数
+        MeasureDataTopic::SubscriberId serialSubscriber; /**< Serial出力用の購読 */
+        MeasureDataTopic::SubscriberId fileSubscriber; /**< SD Card出力用の購読 */
+        GlobalConfigSubscriber configSubscriber; /**< configの再読み込み通知 */
+        bool isSerialRetrying; /**< SerialのLockが取れず再試行中 */
+
+        void setup(void) override;
+        bool loop(void) override;
+};
+
+#endif /* LOGGERTASK_H */
@@ -0,0 +1,237 @@
+#include <cstring>
+
+#include "SdTask.h"
+#include "../IpcWaitSet.h"
+
+bool SdTask::append(const char* path, const uint8_t* data, size_t size) {
+    if ((path == nullptr) || (data == nullptr) || (size > FixedConfig::SdTaskSectorSize)) {
+        return false;
+    }
+
+    bool isAccepted = false;
+    bool isSwapped = false;
+    taskENTER_CRITICAL();
+    {
+        // 追記先が変わる、もしくは溢れる場合は先に書き出し待ちにする
+        const bool isPathChanged = (this->appendPath != nullptr) && (this->appendPath != path);
+        if (isPathChanged || (this->frontSize + size > FixedConfig::SdTaskSectorSize)) {
+            isSwapped = this->swapBufferUnsafe();
+        }
+        // 切り替えられなかった場合は書き出しが追いついていない
+        if ((this->frontSize == 0) || (!isPathChanged && (this->frontSize + size <= FixedConfig::SdTaskSectorSize))) {
+            memcpy(&this->appendBuffers[this->frontIndex][this->frontSize], data, size);
+            this->frontSize += size;
+            this->appendPath = path;
+            isAccepted = true;
+        } else {
+            this->droppedAppendNum++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    // 書き出し待ちができたらSdTaskに通知
+    if (isSwapped) {
+        this->sendRequest(SdRequestId::FlushAppend, nullptr, nullptr, 0, nullptr); // Queue Fullでも周期的な書き出しで処理される
+    }
+    return isAccepted;
+}
+
+bool SdTask::writeFile(const char* path, const uint8_t* data, size_t size, SdCompletion* completion) {
+    return this->sendRequest(SdRequestId::WriteFile, path, const_cast<uint8_t*>(data), size, completion);
+}
+
+bool SdTask::readFile(const char* path, uint8_t* dst, size_t capacity, SdCompletion* completion) {
+    return this->sendRequest(SdRequestId::ReadFile, path, dst, capacity, completion);
+}
+
+bool SdTask::loadConfig(SdCompletion* completion) {
+    return this->sendRequest(SdRequestId::LoadConfig, nullptr, nullptr, 0, completion);
+}
+
+bool SdTask::saveConfig(SdCompletion* completion) {
+    return this->sendRequest(SdRequestId::SaveConfig, nullptr, nullptr, 0, completion);
+}
+
+bool SdTask::reloadConfig(SdCompletion* completion) {
+    return this->sendRequest(SdRequestId::ReloadConfig, nullptr, nullptr, 0, completion);
+}
+
+bool SdTask::waitForCompletion(SdCompletion& completion, uint32_t timeoutMs) {
+    if (completion.doneSemaphore == nullptr) {
+        return false;
+    }
+    return (xSemaphoreTake(completion.doneSemaphore, SysTimer::msToTick(timeoutMs)) == pdTRUE);
+}
+
+bool SdTask::sendRequest(SdRequestId id, const char* path, uint8_t* buffer, size_t size, SdCompletion* completion) {
+    const SdRequest req = {
+        .id = id,
+        .path = path,
+        .buffer = buffer,
+        .size = size,
+        .completion = completion,
+    };
+    if (completion != nullptr) {
+        completion->isDone = false;
+    }
+    return this->requestQueue.send(&req);
+}
+
+bool SdTask::swapBufferUnsafe(void) {
+    if (this->isBackBusy || (this->frontSize == 0)) {
+        return false;
+    }
+    this->backPath = this->appendPath;
+    this->backSize = this->frontSize;
+    this->isBackBusy = true;
+    this->frontIndex ^= 0x1;
+    this->frontSize = 0;
+    return true;
+}
+
+bool SdTask::flushBack(void) {
+    if (!this->isBackBusy) {
+        return true;
+    }
+    // front面に切り替わった後なのでappend()とは競合しない
+    const uint8_t* data = this->appendBuffers[this->frontIndex ^ 0x1];
+    const size_t size = this->backSize;
+    const char* path = this->backPath;
+
+    bool result = false;
+    this->resource.sd.operate([&](SDFS& sd){
+        File f = sd.open(path, FILE_APPEND);
+        // 開けなければ失敗
+        if (!f) return;
+        result = (f.write(data, size) == size);
+        f.close();
+    });
+
+    taskENTER_CRITICAL();
+    {
+        this->isBackBusy = false;
+    }
+    taskEXIT_CRITICAL();
+    return result;
+}
+
+void SdTask::complete(SdCompletion* completion, bool isSuccess, size_t size, const char* message) {
+    if (completion == nullptr) {
+        return;
+    }
+    // isDoneを立てた後は要求元が破棄できるので、通知先は先に読み出しておく
+    SemaphoreHandle_t doneSemaphore = completion->doneSemaphore;
+    IpcWaitSet* waitSet = completion->waitSet;
+    const uint32_t waitSetBit = completion->waitSetBit;
+
+    completion->isSuccess = isSuccess;
+    completion->transferredSize = size;
+    completion->message = message;
+    if (completion->callback != nullptr) {
+        completion->callback(completion->context, isSuccess, size);
+    }
+    completion->isDone = true;
+    if (waitSet != nullptr) {
+        waitSet->signal(waitSetBit);
+    }
+    if (doneSemaphore != nullptr) {
+        xSemaphoreGive(doneSemaphore);
+    }
+}
+
+bool SdTask::loop(void) {
+    SdRequest req;
+    // 要求がなくても一定周期で溜まっている分を書き出す
+    this->beat(SysTimer::msToTick(FixedConfig::SdTaskFlushIntervalMs));
+    if (!this->requestQueue.receiveFor(&req, FixedConfig::SdTaskFlushIntervalMs)) {
+        taskENTER_CRITICAL();
+        {
+            this->swapBufferUnsafe();
+        }
+        taskEXIT_CRITICAL();
+        this->flushBack();
+        return false; // no abort
+    }
+
+    switch (req.id) {
+        case SdRequestId::FlushAppend:
+            this->flushBack();
+            break;
+        case SdRequestId::WriteFile: {
+            bool result = false;
+            size_t byteWritten = 0;
+            this->resource.sd.operate([&](SDFS& sd){
+                File f = sd.open(req.path, FILE_WRITE);
+                if (!f) return;
+                byteWritten = f.write(req.buffer, req.size);
+                f.close();
+                result = (byteWritten == req.size);
+            });
+            this->complete(req.completion, result, byteWritten, nullptr);
+            break;
+        }
+        case SdRequestId::ReadFile: {
+            bool result = false;
+            size_t byteRead = 0;
+            this->resource.sd.operate([&](SDFS& sd){
+                File f = sd.open(req.path, FILE_READ);
+                if (!f) return;
+                byteRead = f.read(req.buffer, req.size);
+                f.close();
+                result = true;
+            });
+            this->complete(req.completion, result, byteRead, nullptr);
+            break;
+        }
+        case SdRequestId::LoadConfig: {
+            // 起動時に他のTaskを作成する前に使うので、読み出しの間configの書き込みLockを保持しても待たせるTaskはない
+            bool result = false;
+            DeserializationError deserializeError;
+            this->resource.config.write([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                result = config.load(nullptr, deserializeError);
+            });
+            this->complete(req.completion, result, 0, deserializeError.c_str());
+            break;
+        }
+        case SdRequestId::SaveConfig: {
+            bool result = false;
+            this->resource.config.write([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                result = config.save(nullptr);
+            });
+            this->complete(req.completion, result, 0, nullptr);
+            break;
+        }
+        case SdRequestId::ReloadConfig: {
+            // SD Cardの読み出しと解析はconfigのLockを取らずに行い、他Taskの参照を待たせない
+            GlobalConfigFiles files;
+            this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                files = config.getFiles();
+            });
+            GlobalConfigData loaded;
+            DeserializationError deserializeError;
+            const bool result = GlobalConfig<FixedConfig::ConfigAllocateSize>::parse(this->resource.sd, files.json, loaded, deserializeError);
+            // 解析できた場合のみ、書き込みLockの間に入れ替える。各Taskは通知を受けてから読み直す
+            GlobalConfigChangeSet changes;
+            if (result) {
+                this->resource.config.write([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                    changes = config.apply(loaded);
+                });
+            }
+            size_t changedNum = 0;
+            for (uint32_t mask = changes.getMask(); mask != 0; mask &= (mask - 1)) {
+                changedNum++;
+            }
+            this->resource.serial.operate([&](Serial_& serial){
+                serial.print("[config] reload ");
+                serial.print(result ? "done" : "failed");
+                serial.print(" changed=");
+                serial.println(changedNum);
+            });
+            this->complete(req.completion, result, changedNum, deserializeError.c_str());
+            break;
+        }
+        default:
+            break;
+    }
+    return false; // no abort
+}
@@ -0,0 +1,161 @@
+#ifndef SDTASK_H
+#define SDTASK_H
+
+#include <Seeed_FS.h>
+#include "SD/Seeed_SD.h"
+
+#include "../SharedResourceDefs.h"
+#include "../IpcQueueDefs.h"
+#include "../IpcQueue.h"
+#include "../TaskBase.h"
+
+/**
+ * @brief SD Cardの読み書きを一手に引き受けるTaskです
+ * @note 他のTaskは要求をQueueに積むだけで、SPIのFile操作の間Critical Sectionを保持したり待たされたりすることはありません
+ * @note append()は2面のsector sizeのBufferに溜めて、一杯になった面から書き出します
+ * @note GlobalConfigのload/save/再読み込みもここで行います。完了はSdCompletionのcallback/Binary Semaphore/IpcWaitSetで通知します
+ */
+class SdTask : public TaskBase {
+    public:
+        /**
+         * @brief Construct a new Sd Task object
+         * 
+         * @param resource 共有リソース群
+         * @param requestQueue SdTaskへの要求Queue, 複数Taskから送信されるのでFreeRTOS Queueを使用する
+         */
+        SdTask(
+            const SharedResourceDefs& resource,
+            IpcQueue<SdRequest>& requestQueue
+        ): resource(resource), requestQueue(requestQueue), appendPath(nullptr), backPath(nullptr), frontIndex(0), frontSize(0), backSize(0), isBackBusy(false), droppedAppendNum(0) {}
+
+        /**
+         * @brief Destroy the Sd Task object
+         */
+        virtual ~SdTask(void) {}
+        const char* getName(void) override { return "SdTask"; }
+
+        /**
+         * @brief Fileへの追記を予約します。任意のTaskから呼び出せます
+         * @note dataはBufferにコピーされるので呼び出し後すぐに破棄できます。書き出しは非同期で行われます
+         * 
+         * @param path 追記先, 書き出しが終わるまで有効な文字列(リテラルなど)を指定してください
+         * @param data 追記するデータ
+         * @param size 追記するbyte数, FixedConfig::SdTaskSectorSize以下
+         * @return true 予約成功
+         * @return false Bufferが両面とも一杯、またはsizeが大きすぎる
+         */
+        bool append(const char* path, const uint8_t* data, size_t size);
+
+        /**
+         * @brief Fileを新規作成して書き込む要求を送信します。任意のTaskから呼び出せます
+         * 
+         * @param path 書き込み先
+         * @param data 書き込むデータ、完了するまで保持してください
+         * @param size 書き込むbyte数
+         * @param completion 完了通知先, nullptrなら通知しない
+         * @return true 要求を受け付けた
+         * @return false 要求Queueが一杯
+         */
+        bool writeFile(const char* path, const uint8_t* data, size_t size, SdCompletion* completion);
+
+        /**
+         * @brief Fileを読み出す要求を送信します。任意のTaskから呼び出せます
+         * 
+         * @param path 読み出し元
+         * @param dst 読み出し先、完了するまで保持してください
+         * @param capacity dstのbyte数
+         * @param completion 完了通知先, nullptrなら通知しない
+         * @return true 要求を受け付けた
+         * @return false 要求Queueが一杯
+         */
+        bool readFile(const char* path, uint8_t* dst, size_t capacity, SdCompletion* completion);
+
+        /**
+         * @brief GlobalConfigをSD Cardから読み出す要求を送信します。起動時に他のTaskを作成する前に使います
+         * @note 読み出し中はconfigの書き込みLockを保持します。失敗した場合の理由はSdCompletion::messageに格納されます
+         *
+         * @param completion 完了通知先, nullptrなら通知しない
+         * @return true 要求を受け付けた
+         * @return false 要求Queueが一杯
+         */
+        bool loadConfig(SdCompletion* completion);
+
+        /**
+         * @brief GlobalConfigをSD Cardに保存する要求を送信します。SD Cardと同じ内容なら書き込みません
+         * @note 保存中はconfigの書き込みLockを保持します
+         *
+         * @param completion 完了通知先, nullptrなら通知しない
+         * @return true 要求を受け付けた
+         * @return false 要求Queueが一杯
+         */
+        bool saveConfig(SdCompletion* completion);
+
+        /**
+         * @brief GlobalConfigを読み直す要求を送信します。任意のTaskから呼び出せます
+         * @note 値が変わった項目はGlobalConfigSubscriberを登録した各Taskに通知されます。結果はSerialに出力します
+         *
+         * @param completion 完了通知先, nullptrなら通知しない
+         * @return true 要求を受け付けた
+         * @return false 要求Queueが一杯
+         */
+        bool reloadConfig(SdCompletion* completion);
+
+        /**
+         * @brief SdCompletion::doneSemaphoreで完了を待ちます
+         * @note Task Notificationは使わないので、どのTaskからでも呼び出せます。timeoutした場合は完了するまでcompletionを再利用しないでください
+         * 
+         * @param completion 待機する完了通知, doneSemaphoreを指定してください
+         * @param timeoutMs 最大待機時間[ms]
+         * @return true 完了した
+         * @return false timeout, もしくはdoneSemaphoreが未指定
+         */
+        static bool waitForCompletion(SdCompletion& completion, uint32_t timeoutMs);
+
+        /**
+         * @brief Bufferが一杯で捨てたappend()の回数を取得します
+         * 
+         * @return uint32_t 捨てた回数
+         */
+        uint32_t getDroppedAppendNum(void) { return this->droppedAppendNum; }
+
+    protected:
+        // resource
+        const SharedResourceDefs& resource; /**< 共有リソース群 */
+        IpcQueue<SdRequest>& requestQueue; /**< SdTaskへの要求 */
+        // append buffer
+        const char* appendPath; /**< front面のappend先 */
+        const char* backPath; /**< 書き出し待ちの面のappend先 */
+        uint8_t appendBuffers[2][FixedConfig::SdTaskSectorSize]; /**< append()を溜める2面のBuffer */
+        volatile size_t frontIndex; /**< append()で書き込む面 */
+        volatile size_t frontSize; /**< front面に溜まっているbyte数 */
+        volatile size_t backSize; /**< 書き出し待ちの面のbyte数 */
+        volatile bool isBackBusy; /**< 書き出し待ちの面があればtrue */
+        volatile uint32_t droppedAppendNum; /**< Bufferが一杯で捨てたappend()の回数 */
+
+        bool loop(void) override;
+
+        /**
+         * @brief front面を書き出し待ちにします。Critical Section内で呼び出してください
+         * 
+         * @return true 切り替えた
+         * @return false 書き出し待ちの面がまだ残っている、またはfront面が空
+         */
+        bool swapBufferUnsafe(void);
+
+        /**
+         * @brief 書き出し待ちの面をSD Cardに追記します
+         */
+        bool flushBack(void);
+
+        /**
+         * @brief 要求をQueueに積みます
+         */
+        bool sendRequest(SdRequestId id, const char* path, uint8_t* buffer, size_t size, SdCompletion* completion);
+
+        /**
+         * @brief 完了を通知します
+         */
+        void complete(SdCompletion* completion, bool isSuccess, size_t size, const char* message);
+};
+
+#endif /* SDTASK_H */
@@ -0,0 +1,18 @@
+#include "TimerTask.h"
+
+void TimerTask::setup(void) {
+    this->wheel.attachWaitSet(this->waitSet);
+    this->dispatcher.attachWaitSet(this->waitSet);
+    this->setWaitSet(&this->waitSet);
+}
+
+bool TimerTask::loop(void) {
+    this->wheel.advance(this->dispatcher);
+    this->dispatcher.dispatch();
+
+    return false; /**< no abort */
+}
+
+uint32_t TimerTask::getIdleTimeoutTick(void) {
+    return this->wheel.getIdleTimeoutTick();
+}
@@ -0,0 +1,37 @@
+#ifndef TIMERTASK_H
+#define TIMERTASK_H
+
+#include "../FpsControlTask.h"
+#include "../IpcWaitSet.h"
+#include "../TimerWheel.h"
+
+/**
+ * @brief TimerWheelの期限を確認し、期限が来たTimerを各TaskのTimerDispatcherに渡すTaskです
+ * @note 次のTimerの期限か、より早いTimerが登録されるまで寝ているので、Timerがなければ起床しません
+ * @note 呼び出し先のTimerDispatcherを指定していないTimerのCallbackはこのTaskで呼び出すので、短い処理にしてください
+ */
+class TimerTask : public FpsControlTask {
+    public:
+        /**
+         * @brief Construct a new Timer Task object
+         * 
+         * @param wheel 管理するTimerWheel
+         */
+        TimerTask(TimerWheel& wheel): wheel(wheel) {}
+
+        /**
+         * @brief Destroy the Timer Task object
+         */
+        virtual ~TimerTask(void) {}
+        const char* getName(void) override { return "TimerTask"; }
+    protected:
+        TimerWheel& wheel; /**< 管理するTimerWheel */
+        TimerDispatcher dispatcher; /**< 呼び出し先の指定がないTimerのCallbackを呼び出す */
+        IpcWaitSet waitSet; /**< Timerの登録/期限の通知を待つ */
+
+        void setup(void) override;
+        bool loop(void) override;
+        uint32_t getIdleTimeoutTick(void) override;
+};
+
+#endif /* TIMERTASK_H */
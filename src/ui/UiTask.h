@@ -7,11 +7,13 @@
 #include "../SharedResourceDefs.h"
 #include "../IpcQueueDefs.h"
 #include "../IpcQueue.h"
+#include "../LatestValue.h"
 #include "../SysTimer.h"
+#include "../ScopedTimer.h"
 #include "../FpsControlTask.h"
+#include "../TimerWheel.h"
 
 #include "control/BrightnessControl.h"
-#include "control/PeriodicTrigger.h"
 #include "control/Chart.h"
 
 /**
@@ -25,25 +27,28 @@ class UiTask : public FpsControlTask {
          * @brief Construct a new Ui Task object
          * 
          * @param resource 共有リソース群
-         * @param recvMeasureDataQueue 測定データの受信Queue
+         * @param measureData 最新の測定データ
          * @param recvButtonStateQueue ボタン入力の受信Queue
          * @param sendWifiReqQueue Wifi関係の要求Queue
          * @param recvWifiRespQueue Wifi関係の応答Queue
          * @param lcd LCD Library、事前にinitは済ませておくこと(Wio Terminalに付随しているため)
+         * @param timerWheel 周期処理を登録するTimerWheel
          */
         UiTask(
             const SharedResourceDefs& resource,
-            IpcQueue<MeasureData>& recvMeasureDataQueue,
-            IpcQueue<ButtonEventData>& recvButtonStateQueue,
-            IpcQueue<WifiTaskRequest>& sendWifiReqQueue,
-            IpcQueue<WifiTaskResponse>& recvWifiRespQueue,
-            LGFX& lcd
+            LatestValue<MeasureData>& measureData,
+            PointToPointQueue<ButtonEventData>& recvButtonStateQueue,
+            ZeroCopyQueue<WifiTaskRequest>& sendWifiReqQueue,
+            ZeroCopyQueue<WifiTaskResponse>& recvWifiRespQueue,
+            LGFX& lcd,
+            TimerWheel& timerWheel
         ): resource(resource),           
-           recvMeasureDataQueue(recvMeasureDataQueue),
+           measureData(measureData),
            recvButtonStateQueue(recvButtonStateQueue),
            sendWifiReqQueue(sendWifiReqQueue),
            recvWifiRespQueue(recvWifiRespQueue),
            lcd(lcd),
+           timerWheel(timerWheel),
            brightness(lcd) {}
 
         /**
@@ -53,12 +58,13 @@ class UiTask : public FpsControlTask {
         const char* getName(void) override { return "UiTask"; }
     protected:
         const SharedResourceDefs& resource; /**< 共有リソース群 */
-        IpcQueue<MeasureData>& recvMeasureDataQueue; /**< 測定データ受信用 */
-        IpcQueue<ButtonEventData>& recvButtonStateQueue; /**< ボタン入力受信用 */
-        IpcQueue<WifiTaskRequest>& sendWifiReqQueue; /**< Wifi要求 */
-        IpcQueue<WifiTaskResponse>& recvWifiRespQueue; /**< Wifi応答  */
+        LatestValue<MeasureData>& measureData; /**< 最新の測定データ */
+        PointToPointQueue<ButtonEventData>& recvButtonStateQueue; /**< ボタン入力受信用 */
+        ZeroCopyQueue<WifiTaskRequest>& sendWifiReqQueue; /**< Wifi要求 */
+        ZeroCopyQueue<WifiTaskResponse>& recvWifiRespQueue; /**< Wifi応答  */
         // hw
         LGFX& lcd;
+        TimerWheel& timerWheel; /**< 周期処理の登録先 */
         // hw resourceを使って初期化が必要
         BrightnessControl<N, LGFX> brightness;
         // configから読み出し
@@ -68,11 +74,19 @@ class UiTask : public FpsControlTask {
         bool isSendingAmbient; /**< ambientへデータ送信中の場合はtrue, QD=1制御用フラグ */
         bool wasSucceedSendAmbient; /**< 最後にAmbientにデータ送信した結果 */
         uint32_t counter; /**< for debug*/
-        uint32_t lastestDrawChatTimestamp; /**< 最後にchartに書いたデータのtimestamp */
+        bool isFirstFrameReported; /**< 起動から最初の描画までの時間を出力済ならtrue */
+        uint64_t lastestDrawChatTimestamp; /**< 最後にchartに書いたデータのtimestamp */
         MeasureData latestMeasureData; /**< 最後に受信した測定データ */
-        ButtonEventData latestButtonState; /**< 最後に受信したボタン入力 */
+        uint32_t latestMeasureDataGeneration; /**< latestMeasureDataを読み出したときの世代 */
+        ButtonEventData latestButtonState; /**< 最後に受信したボタン入力、push/releaseは1frame分を集約したもの */
+        uint32_t receivedButtonEventNum; /**< 受信したボタン入力のサンプル数 */
+        uint32_t lostButtonEventNum; /**< sequenceの欠番から検出したボタン入力の欠落数 */
+        uint32_t nextButtonSequence; /**< 次に受信するはずのボタン入力のsequence */
         WifiStatusData latestWifiStatus; /**< 最後に受信したWiFi Status */
-        PeriodicTrigger ambientTaskTrigger; /**< Ambient定期送信タスク制御 */
+        TimerDispatcher timerDispatcher; /**< 期限が来たTimerをこのTaskで呼び出す */
+        TimerEntry ambientTimer; /**< Ambient定期送信タスク制御 */
+        GlobalConfigSubscriber configSubscriber; /**< configの再読み込み通知 */
+        IpcWaitSet receiveWaitSet; /**< 受信データの更新待ち */
         Chart chart; /**< センサー値のトレンドグラフ */
 
         void setup(void) override {
@@ -110,36 +124,19 @@ class UiTask : public FpsControlTask {
             };
             this->chart.init(this->lcd, chartConfig);
 
-            // configure
-            static constexpr BrightnessSetting brightnessSetting[N] = {
-                { .visibleLux =  50.0f , .brightness = 20 },
-                { .visibleLux = 120.0f , .brightness = 100 },
-                { .visibleLux = 180.0f , .brightness = 200 },
-                { .visibleLux = FLT_MAX, .brightness = 255 },
-            };
-
-            this->resource.config.operate([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
-                // fps
-                auto fps = GlobalConfigDefaultValues::UiTaskFps;
-                config.read(GlobalConfigKeys::UiTaskFps, fps);
-                this->setFps(fps);
-                // auto brightness
-                auto holdMs = GlobalConfigDefaultValues::BrightnessHoldMs;
-                auto transitionMs = GlobalConfigDefaultValues::BrightnessTransitionMs;
-                config.read(GlobalConfigKeys::BrightnessHoldMs, holdMs);
-                config.read(GlobalConfigKeys::BrightnessTransitionMs, transitionMs);
-                this->brightness.configure(true, holdMs, transitionMs, brightnessSetting);
-                // ambient
-                this->isUseAmbient = GlobalConfigDefaultValues::UseAmbient;
-                this->ambientIntervalMs = GlobalConfigDefaultValues::AmbientIntervalMs;
-                config.read(GlobalConfigKeys::UseAmbient, this->isUseAmbient);
-                config.read(GlobalConfigKeys::AmbientIntervalMs, this->ambientIntervalMs);
+            // configure, 以後は再読み込みで変わった項目だけ反映する
+            this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                this->applyConfig(config, GlobalConfigChangeSet::all());
+            });
+            this->resource.config.write([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                config.subscribe(this->configSubscriber);
             });
 
             // initial value
             this->isSendingAmbient = false;
             this->wasSucceedSendAmbient = false;
             this->counter = 0x0;
+            this->isFirstFrameReported = false;
             this->lastestDrawChatTimestamp = 0x0;
             this->latestMeasureData.visibleLux = 0.0f;
             this->latestMeasureData.tempature = 0.0f;
@@ -147,10 +144,19 @@ class UiTask : public FpsControlTask {
             this->latestMeasureData.humidity = 0.0f;
             this->latestMeasureData.gas = 0.0f;
             this->latestMeasureData.timestamp = 0x0;
+            this->latestMeasureData.luxTimestamp = 0x0;
+            this->latestMeasureData.tphTimestamp = 0x0;
+            this->latestMeasureData.gasTimestamp = 0x0;
+            this->latestMeasureDataGeneration = 0;
             this->latestButtonState.raw = 0x0;
             this->latestButtonState.debounce = 0x0;
             this->latestButtonState.push = 0x0;
             this->latestButtonState.release = 0x0;
+            this->latestButtonState.timestamp = 0x0;
+            this->latestButtonState.sequence = 0x0;
+            this->receivedButtonEventNum = 0;
+            this->lostButtonEventNum = 0;
+            this->nextButtonSequence = 0;
             this->latestWifiStatus.ipAddr[0] = 0x0;
             this->latestWifiStatus.ipAddr[1] = 0x0;
             this->latestWifiStatus.ipAddr[2] = 0x0;
@@ -158,39 +164,38 @@ class UiTask : public FpsControlTask {
             this->latestWifiStatus.status = WL_DISCONNECTED;
             this->latestWifiStatus.timestamp = 0x0;
 
-            // ambientが有効な場合のみ
-            if (this->isUseAmbient) {
-                this->ambientTaskTrigger.start(this->ambientIntervalMs);
-            } else {
-                this->ambientTaskTrigger.stop(); // 念の為
-            }
+            // ambientが有効な場合のみ, 期限が来たらloop()内で呼び出す
+            this->ambientTimer.init([](void* context){
+                static_cast<UiTask*>(context)->requestAmbient();
+            }, this, &this->timerDispatcher);
+            this->armAmbientTimer();
+
+            // 受信データが更新されるか、Timerの期限か、次の描画期限まで寝て待つ
+            this->measureData.attachWaitSet(this->receiveWaitSet);
+            this->recvButtonStateQueue.attachWaitSet(this->receiveWaitSet);
+            this->recvWifiRespQueue.attachWaitSet(this->receiveWaitSet);
+            this->timerDispatcher.attachWaitSet(this->receiveWaitSet);
+            this->configSubscriber.attachWaitSet(this->receiveWaitSet);
+            this->setWaitSet(&this->receiveWaitSet);
 
         }
 
         bool loop(void) override {
+            // 再読み込みされた設定を反映する
+            const GlobalConfigChangeSet changes = this->configSubscriber.takeChanges();
+            if (!changes.isEmpty()) {
+                this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                    this->applyConfig(config, changes);
+                });
+                if (changes.contains(GlobalConfigId::UseAmbient) || changes.contains(GlobalConfigId::AmbientIntervalMs)) {
+                    this->armAmbientTimer();
+                }
+            }
             // receive datas
             const bool isUpdated = this->receiveDatas();
             // periodic tasks
             brightness.update(this->latestMeasureData.visibleLux);
-            ambientTaskTrigger.update([&](){
-                // Queueがあいていれば、WifiStatus確認とAmbient更新を投げる
-                if (this->sendWifiReqQueue.remainNum() == 0) {
-                    WifiTaskRequest req;
-                    req.id = WifiTaskRequestId::GetWifiStatus;
-                    this->sendWifiReqQueue.send(&req);
-
-                    // SensorDataがAll Zeroの場合は送信しない
-                    if (this->latestMeasureData.timestamp != 0) {
-                        if (this->isUseAmbient && !this->isSendingAmbient) {
-                            this->isSendingAmbient = true; // QD=1制限用
-
-                            req.id = WifiTaskRequestId::SendSensorData;
-                            req.data.measureData = this->latestMeasureData;
-                            this->sendWifiReqQueue.send(&req);
-                        }
-                    }
-                }
-            });
+            this->timerDispatcher.dispatch();
 
             // ui update
             this->drawChart(this->lcd);
@@ -205,30 +210,149 @@ class UiTask : public FpsControlTask {
 
             // for debug
             this->counter++;
+            if (!this->isFirstFrameReported) {
+                this->isFirstFrameReported = true;
+                this->reportFirstFrame();
+            }
 
             return false; /**< no abort */
         }
 
         /**
-         * @brief receiveQueueの中身を受信します
+         * @brief 更新がなくてもloop()を呼び出す必要がある期限を返します
+         * 
+         * @return uint32_t 最大待機tick
+         */
+        uint32_t getIdleTimeoutTick(void) override {
+            // 自動調光の監視/遷移中は時間経過で明るさが変わるのでframe毎に更新する
+            const BrightnessControlState state = this->brightness.getState();
+            if ((state == BrightnessControlState::Watch) || (state == BrightnessControlState::Transition)) {
+                return this->durationTick;
+            }
+            // それ以外は受信データかTimerの期限で起こされるまで寝ていられる
+            return portMAX_DELAY;
+        }
+
+        /**
+         * @brief configの値を反映します
+         *
+         * @param config 読み出し元
+         * @param changes 反映する項目
+         */
+        void applyConfig(const GlobalConfig<FixedConfig::ConfigAllocateSize>& config, const GlobalConfigChangeSet& changes) {
+            static constexpr BrightnessSetting brightnessSetting[N] = {
+                { .visibleLux =  50.0f , .brightness = 20 },
+                { .visibleLux = 120.0f , .brightness = 100 },
+                { .visibleLux = 180.0f , .brightness = 200 },
+                { .visibleLux = FLT_MAX, .brightness = 255 },
+            };
+
+            // fps
+            if (changes.contains(GlobalConfigId::UiTaskFps)) {
+                this->setFps(config.get<GlobalConfigId::UiTaskFps>());
+            }
+            // auto brightness
+            if (changes.contains(GlobalConfigId::BrightnessHoldMs) || changes.contains(GlobalConfigId::BrightnessTransitionMs)) {
+                const uint32_t holdMs = config.get<GlobalConfigId::BrightnessHoldMs>();
+                const uint32_t transitionMs = config.get<GlobalConfigId::BrightnessTransitionMs>();
+                this->brightness.configure(true, holdMs, transitionMs, brightnessSetting);
+            }
+            // ambient
+            this->isUseAmbient = config.get<GlobalConfigId::UseAmbient>();
+            this->ambientIntervalMs = config.get<GlobalConfigId::AmbientIntervalMs>();
+        }
+
+        /**
+         * @brief ambientが有効な場合のみambientTimerを現在の周期で登録します
+         */
+        void armAmbientTimer(void) {
+            if (this->isUseAmbient) {
+                this->timerWheel.armPeriodicAligned(this->ambientTimer, this->ambientIntervalMs, 0);
+            } else {
+                this->timerWheel.cancel(this->ambientTimer);
+            }
+        }
+
+        /**
+         * @brief 起動から最初の描画完了までの時間と、configの読み出し元/処理時間をSerialに出力します
+         */
+        void reportFirstFrame(void) {
+            const uint64_t elapsedUs = SysTimer::getMicroCount64();
+            GlobalConfigSource source = GlobalConfigSource::Default;
+            uint32_t loadUs = 0;
+            this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+                source = config.getLoadSource();
+                loadUs = config.getLoadUs();
+            });
+            this->resource.serial.operate([&](Serial_& serial){
+                serial.print("[boot] first frame=");
+                SysTimer::print64(serial, elapsedUs);
+                serial.print("[us] config=");
+                serial.print((source == GlobalConfigSource::Snapshot) ? "snapshot" : (source == GlobalConfigSource::Json) ? "json" : "default");
+                serial.print(" load=");
+                serial.print(loadUs);
+                serial.println("[us]");
+            });
+        }
+
+        /**
+         * @brief WifiStatus確認とAmbient更新を要求します。ambientTimerの期限が来るとloop()内から呼び出されます
+         */
+        void requestAmbient(void) {
+            // Queueがあいていなければ今回は見送る
+            if (this->sendWifiReqQueue.remainNum() != 0) return;
+
+            // 要求はQueue上で直接組み立てる
+            WifiTaskRequest* req = this->sendWifiReqQueue.loan();
+            if (req != nullptr) {
+                req->id = WifiTaskRequestId::GetWifiStatus;
+                this->sendWifiReqQueue.commit();
+            }
+
+            // SensorDataが一度も公開されていない場合は送信しない
+            if (this->latestMeasureDataGeneration != 0) {
+                if (this->isUseAmbient && !this->isSendingAmbient) {
+                    req = this->sendWifiReqQueue.loan();
+                    if (req != nullptr) {
+                        this->isSendingAmbient = true; // QD=1制限用
+
+                        req->id = WifiTaskRequestId::SendSensorData; // 測定データはWifiTaskが直接読み出す
+                        this->sendWifiReqQueue.commit();
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief receiveQueueの中身をすべて受信します
+         * @note ボタン入力は最新の状態に集約しますが、push/releaseはframe中のedgeをすべてORして保持します
          * @retval true 何かしらのデータを受信した
          * @retval false 有効なデータは受信Queueには存在しない
          */
         bool receiveDatas(void) {
-            bool isUpdated = false;
-            if (this->recvMeasureDataQueue.remainNum() > 0) {
-                isUpdated = true;
-                this->recvMeasureDataQueue.receive(&this->latestMeasureData, false);
-            }
-            if (this->recvButtonStateQueue.remainNum() > 0) {
-                isUpdated = true;
-                this->recvButtonStateQueue.receive(&this->latestButtonState, false);
+            size_t receivedNum = 0;
+            if (this->measureData.readIfUpdated(this->latestMeasureData, this->latestMeasureDataGeneration)) {
+                receivedNum++;
             }
-            if (this->recvWifiRespQueue.remainNum() > 0) {
-                isUpdated = true;
 
-                WifiTaskResponse resp;
-                this->recvWifiRespQueue.receive(&resp, false);
+            // edgeは前frameのものを持ち越さない
+            this->latestButtonState.push = 0x0;
+            this->latestButtonState.release = 0x0;
+            receivedNum += this->recvButtonStateQueue.receiveAll([&](const ButtonEventData& data) {
+                // 欠落検出
+                this->lostButtonEventNum += data.sequence - this->nextButtonSequence;
+                this->nextButtonSequence = data.sequence + 1;
+                this->receivedButtonEventNum++;
+                // 集約
+                this->latestButtonState.raw = data.raw;
+                this->latestButtonState.debounce = data.debounce;
+                this->latestButtonState.push |= data.push;
+                this->latestButtonState.release |= data.release;
+                this->latestButtonState.timestamp = data.timestamp;
+                this->latestButtonState.sequence = data.sequence;
+            });
+
+            receivedNum += this->recvWifiRespQueue.receiveAll([&](const WifiTaskResponse& resp) {
                 switch (resp.id) {
                     case WifiTaskRequestId::Nop:
                         break;
@@ -243,8 +367,8 @@ class UiTask : public FpsControlTask {
                         // ありえん
                         break;
                 }
-            }
-            return isUpdated;
+            });
+            return (receivedNum > 0);
         }
 
         /**
@@ -292,11 +416,14 @@ class UiTask : public FpsControlTask {
                 },
             };
             
-            // データが更新されてたときのみ
-            if (this->lastestDrawChatTimestamp == this->latestMeasureData.timestamp) {
+            // 温度/気圧/湿度が更新されてたときのみ(照度の周期で進めるとchartがすぐ流れてしまう)
+            if (this->lastestDrawChatTimestamp == this->latestMeasureData.tphTimestamp) {
                 return;
             }
-            this->lastestDrawChatTimestamp = this->latestMeasureData.timestamp;
+            this->lastestDrawChatTimestamp = this->latestMeasureData.tphTimestamp;
+
+            static ScopedTimerStats timerStats("UiTask::drawChart");
+            ScopedTimer timer(timerStats);
 
             // データを更新
             this->chart.plot(this->lcd, this->latestMeasureData.tempature  , plotTemp);
@@ -324,7 +451,16 @@ class UiTask : public FpsControlTask {
             drawDst.printf("pressure   = %f\n", this->latestMeasureData.pressure);
             drawDst.printf("humidity   = %f\n", this->latestMeasureData.humidity);
             drawDst.printf("gas        = %f\n", this->latestMeasureData.gas);
-            drawDst.printf("timestamp  = %u\n", this->latestMeasureData.timestamp);
+            drawDst.printf("timestamp  = ");
+            SysTimer::print64(drawDst, this->latestMeasureData.timestamp);
+            drawDst.printf("\n");
+            drawDst.printf("lux/tph/gas= ");
+            SysTimer::print64(drawDst, this->latestMeasureData.luxTimestamp);
+            drawDst.printf("/");
+            SysTimer::print64(drawDst, this->latestMeasureData.tphTimestamp);
+            drawDst.printf("/");
+            SysTimer::print64(drawDst, this->latestMeasureData.gasTimestamp);
+            drawDst.printf("\n");
             drawDst.printf("\n");
 
             drawDst.printf("#Button\n");
@@ -332,13 +468,19 @@ class UiTask : public FpsControlTask {
             drawDst.printf("debounce  = %08x\n", this->latestButtonState.debounce);
             drawDst.printf("push      = %08x\n", this->latestButtonState.push);
             drawDst.printf("release   = %08x\n", this->latestButtonState.release);
-            drawDst.printf("timestamp = %u\n"  , this->latestButtonState.timestamp);
+            drawDst.printf("timestamp = ");
+            SysTimer::print64(drawDst, this->latestButtonState.timestamp);
+            drawDst.printf("\n");
+            drawDst.printf("received  = %u\n"  , this->receivedButtonEventNum);
+            drawDst.printf("lost      = %u\n"  , this->lostButtonEventNum);
             drawDst.printf("\n");
 
             drawDst.printf("#Wifi\n");
             drawDst.printf("status    = %d\n"         , this->latestWifiStatus.status);
             drawDst.printf("ipAddr    = %d.%d.%d.%d\n", this->latestWifiStatus.ipAddr[0], this->latestWifiStatus.ipAddr[1], this->latestWifiStatus.ipAddr[2], this->latestWifiStatus.ipAddr[3]);
-            drawDst.printf("timestamp = %u\n"         , this->latestWifiStatus.timestamp);
+            drawDst.printf("timestamp = ");
+            SysTimer::print64(drawDst, this->latestWifiStatus.timestamp);
+            drawDst.printf("\n");
             drawDst.printf("\n");
 
             drawDst.printf("#Ambient\n");
@@ -6,6 +6,8 @@
 
 #include <LovyanGFX.h>
 
+#include "../../ScopedTimer.h"
+
 #include "DrawDefs.h"
 
 /**
@@ -103,6 +105,9 @@ class Chart {
          * @param drawDst 描画先lcd or offscreen bufferを指定します
          */
         void plot(LovyanGFX& drawDst, float y, const PlotConfig& plotConfig) {
+            static ScopedTimerStats timerStats("Chart::plot");
+            ScopedTimer timer(timerStats);
+
             // 未初期化なら失敗
             if (!this->isInitialized) {
                 return;
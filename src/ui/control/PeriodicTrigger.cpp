@@ -1 +0,0 @@
-#include "PeriodicTrigger.h"
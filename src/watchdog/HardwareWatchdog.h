@@ -0,0 +1,57 @@
+#ifndef HARDWAREWATCHDOG_H
+#define HARDWAREWATCHDOG_H
+
+#include <cstdint>
+
+#include <Arduino.h>
+
+/**
+ * @brief MCU内蔵のWatchdog Timerを操作します
+ * @note SAMD51(Wio Terminal)以外では何もしません
+ */
+namespace HardwareWatchdog {
+    /**
+     * @brief Watchdog Timerを開始します
+     * 
+     * @param periodMs 期限[ms], feed()されずにこの時間が経過するとMCUがリセットされます。1.024kHzのclockで丸められます
+     */
+    static void begin(uint32_t periodMs) {
+#if defined(__SAMD51__)
+        // PERは8cycle(約8ms)から16384cycle(約16s)までの2のべき乗
+        uint32_t per = 0;
+        while ((per < 0xb) && ((8u << per) < periodMs)) {
+            per++;
+        }
+        WDT->CTRLA.reg = 0;
+        while (WDT->SYNCBUSY.reg) {}
+        WDT->CONFIG.reg = WDT_CONFIG_PER(per);
+        WDT->CTRLA.reg = WDT_CTRLA_ENABLE;
+        while (WDT->SYNCBUSY.reg) {}
+#else
+        (void)periodMs;
+#endif
+    }
+
+    /**
+     * @brief Watchdog Timerの期限を延長します
+     */
+    static void feed(void) {
+#if defined(__SAMD51__)
+        // 同期中の書き込みは無視されるので待たずに抜ける
+        if (!WDT->SYNCBUSY.bit.CLEAR) {
+            WDT->CLEAR.reg = WDT_CLEAR_CLEAR_KEY;
+        }
+#endif
+    }
+
+    /**
+     * @brief 即座にMCUをリセットします
+     */
+    static void reset(void) {
+#if defined(__SAMD51__)
+        NVIC_SystemReset();
+#endif
+    }
+}
+
+#endif /* HARDWAREWATCHDOG_H */
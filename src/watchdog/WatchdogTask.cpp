@@ -0,0 +1,68 @@
+#include "WatchdogTask.h"
+#include "HardwareWatchdog.h"
+
+/**
+ * @brief Serialのロック取得を待つ最大時間[ms]
+ */
+static constexpr uint32_t ReportLockTimeoutMs = 10;
+
+void WatchdogTask::setup(void) {
+    this->setFps(1000 / FixedConfig::WatchdogCheckIntervalMs);
+    this->isResetRequested = false;
+    if (FixedConfig::UseHardwareWatchdog) {
+        HardwareWatchdog::begin(FixedConfig::HardwareWatchdogPeriodMs);
+    }
+}
+
+bool WatchdogTask::loop(void) {
+    const uint32_t nowTick = SysTimer::getTickCount();
+    TaskBase::forEach([&](TaskBase& task){
+        // 自身はHardware Watchdogで監視する
+        if (&task == this) return;
+        if (!task.isHeartbeatExpired(nowTick)) return;
+
+        task.onStall();
+        WatchdogAction action = task.getWatchdogAction();
+        // 共有ロックを保持したまま削除すると他のTaskも止まるので、作り直せなかった場合は再起動で復旧する
+        if ((action == WatchdogAction::Restart) && !task.restartTask()) {
+            action = WatchdogAction::Reset;
+        }
+        if (action == WatchdogAction::Reset) {
+            this->isResetRequested = true;
+        }
+        this->report(task, action);
+    });
+
+    if (this->isResetRequested) {
+        // Hardware Watchdogが有効なら延長をやめて期限切れを待つ, 無効なら自分でResetする
+        if (!FixedConfig::UseHardwareWatchdog) {
+            HardwareWatchdog::reset();
+        }
+    } else if (FixedConfig::UseHardwareWatchdog) {
+        HardwareWatchdog::feed();
+    }
+
+    return false; /**< no abort */
+}
+
+void WatchdogTask::report(TaskBase& task, WatchdogAction action) {
+    this->resource.serial.tryOperate(ReportLockTimeoutMs, [&](Serial_& serial){
+        serial.print("[WATCHDOG] stall task=");
+        serial.print(task.getName());
+        serial.print(" count=");
+        serial.print(task.getStallNum());
+        serial.print(" action=");
+        switch (action) {
+            case WatchdogAction::Restart:
+                serial.println("restart");
+                break;
+            case WatchdogAction::Reset:
+                serial.println("reset");
+                break;
+            case WatchdogAction::Log:
+            default:
+                serial.println("log");
+                break;
+        }
+    });
+}
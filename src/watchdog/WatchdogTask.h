@@ -0,0 +1,46 @@
+#ifndef WATCHDOGTASK_H
+#define WATCHDOGTASK_H
+
+#include "../SharedResourceDefs.h"
+#include "../FpsControlTask.h"
+
+/**
+ * @brief 各TaskのHeartbeatを監視するTaskです
+ * @note FixedConfig::WatchdogCheckIntervalMs周期で確認するので、停止の検出は最大で期限+WatchdogCheckIntervalMs遅れます
+ * @note FixedConfig::UseHardwareWatchdogを有効にした場合、全Taskが健全な間だけHardware Watchdogを延長します。
+ *       WatchdogTask自身が止まった場合もHardware Watchdogで再起動されます
+ */
+class WatchdogTask : public FpsControlTask {
+    public:
+        /**
+         * @brief Construct a new Watchdog Task object
+         * 
+         * @param resource 共有リソース群
+         */
+        WatchdogTask(const SharedResourceDefs& resource): resource(resource), isResetRequested(false) {}
+
+        /**
+         * @brief Destroy the Watchdog Task object
+         */
+        virtual ~WatchdogTask(void) {}
+        const char* getName(void) override { return "WatchdogTask"; }
+    protected:
+        // resource
+        const SharedResourceDefs& resource; /**< 共有リソース群 */
+        // variables
+        bool isResetRequested; /**< Resetを要求されたTaskがあればtrue, 以後Hardware Watchdogを延長しない */
+
+        void setup(void) override;
+        bool loop(void) override;
+
+        /**
+         * @brief 期限切れのTaskを記録します
+         * @note 止まったTaskがSerialのロックを保持している可能性があるので、取得できなければ諦めます
+         * 
+         * @param task 期限切れのTask
+         * @param action これから行う処理
+         */
+        void report(TaskBase& task, WatchdogAction action);
+};
+
+#endif /* WATCHDOGTASK_H */
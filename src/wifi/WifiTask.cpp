@@ -2,26 +2,35 @@
 #include "WifiTask.h"
 
 void WifiTask::setup(void) {
-    this->resource.config.operate([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
-        auto fps = GlobalConfigDefaultValues::WifiTaskFps;
-        config.read(GlobalConfigKeys::WifiTaskFps, fps);
-        this->setFps(fps);
-        // Wifi/Ambient使用有無
-        this->isUseWifi = GlobalConfigDefaultValues::UseWiFi;
-        this->isUseAmbient = GlobalConfigDefaultValues::UseAmbient;
-        config.read(GlobalConfigKeys::UseWiFi, this->isUseWifi);
-        config.read(GlobalConfigKeys::UseAmbient, this->isUseAmbient);
-        // ambient送信に必要な情報も読み込んでおく
-        if (this->isUseWifi && this->isUseAmbient) {
-            auto channelId = GlobalConfigDefaultValues::AmbientChannelId;
-            config.read(GlobalConfigKeys::AmbientChannelId, channelId);
-            auto writeKey = config.getReadPtr<char>(GlobalConfigKeys::AmbientWriteKey);
-
-            this->ambient.begin(channelId, writeKey, &this->client);
-        }
+    this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+        // WiFi使用有無はAP接続済かどうかなので起動時のみ反映する
+        this->isUseWifi = config.get<GlobalConfigId::UseWiFi>();
+        this->applyConfig(config, GlobalConfigChangeSet::all());
+    });
+    this->resource.config.write([&](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+        config.subscribe(this->configSubscriber);
     });
 }
 
+void WifiTask::applyConfig(const GlobalConfig<FixedConfig::ConfigAllocateSize>& config, const GlobalConfigChangeSet& changes) {
+    if (changes.contains(GlobalConfigId::WifiTaskFps)) {
+        this->setFps(config.get<GlobalConfigId::WifiTaskFps>());
+    }
+    // Ambient使用有無
+    this->isUseAmbient = config.get<GlobalConfigId::UseAmbient>();
+    // ambient送信に必要な情報も読み込んでおく
+    const bool isAmbientChanged =
+        changes.contains(GlobalConfigId::UseAmbient) ||
+        changes.contains(GlobalConfigId::AmbientChannelId) ||
+        changes.contains(GlobalConfigId::AmbientWriteKey);
+    if (isAmbientChanged && this->isUseWifi && this->isUseAmbient) {
+        const uint32_t channelId = config.get<GlobalConfigId::AmbientChannelId>();
+        const char* writeKey = config.get<GlobalConfigId::AmbientWriteKey>();
+
+        this->ambient.begin(channelId, writeKey, &this->client);
+    }
+}
+
 bool WifiTask::invokeNop(const WifiTaskRequest& req, WifiTaskResponse& resp) {
     // do nothing
     return true;
@@ -29,7 +38,7 @@ bool WifiTask::invokeNop(const WifiTaskRequest& req, WifiTaskResponse& resp) {
 
 bool WifiTask::invokeGetWifiStatus(const WifiTaskRequest& req, WifiTaskResponse& resp) {
     // set timestamp
-    resp.data.wifiStatus.timestamp = SysTimer::getTickCount();
+    resp.data.wifiStatus.timestamp = SysTimer::getTickCount64();
 
     // WiFiを使っていない場合
     if (!this->isUseWifi) {
@@ -63,12 +72,18 @@ bool WifiTask::invokeSend(const WifiTaskRequest& req, WifiTaskResponse& resp) {
         return false;
     }
 
+    // 最新の測定データを取得、まだ一度も測定されていなければ送信しない
+    MeasureData data;
+    if (this->measureData.read(data) == 0) {
+        return false;
+    }
+
     // データを準備(1~8)
-    ambient.set(1, String(req.data.measureData.visibleLux).c_str());
-    ambient.set(2, String(req.data.measureData.tempature).c_str());
-    ambient.set(3, String(req.data.measureData.humidity).c_str());
-    ambient.set(4, String(req.data.measureData.pressure).c_str());
-    ambient.set(5, String(req.data.measureData.gas).c_str());
+    ambient.set(1, String(data.visibleLux).c_str());
+    ambient.set(2, String(data.tempature).c_str());
+    ambient.set(3, String(data.humidity).c_str());
+    ambient.set(4, String(data.pressure).c_str());
+    ambient.set(5, String(data.gas).c_str());
     // 送信
     const bool result = ambient.send(); // clear()も内部的にされている
 
@@ -76,33 +91,47 @@ bool WifiTask::invokeSend(const WifiTaskRequest& req, WifiTaskResponse& resp) {
 }
 
 bool WifiTask::loop(void) {
-    WifiTaskRequest req;
-    WifiTaskResponse resp;
+    // 再読み込みされた設定を反映する
+    const GlobalConfigChangeSet changes = this->configSubscriber.takeChanges();
+    if (!changes.isEmpty()) {
+        this->resource.config.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+            this->applyConfig(config, changes);
+        });
+    }
+
     // 応答Queueに空きができるまでは処理しても仕方ないので待つ
-    if (this->sendQueue.emptyNum() == 0) {
+    WifiTaskResponse* resp = this->sendQueue.loan();
+    if (resp == nullptr) {
         return false; // no abort
     }
 
-    // 要求を受信(受信できるまでTask Suspendさせる)
-    this->recvQueue.receive(&req, true); 
-    // いい感じに処理
-    resp.id = req.id;
-    switch (req.id) {
+    // 要求を受信(受信できるまでTask Suspendさせる)、Queue上のデータを直接参照する
+    // 要求待ちの間はHeartbeatを監視しない
+    this->beat(portMAX_DELAY);
+    const WifiTaskRequest* req = this->recvQueue.peek(true);
+    this->beat(0);
+    if (req == nullptr) {
+        return false; // no abort
+    }
+    // いい感じに処理、応答もQueue上に直接書き込む
+    resp->id = req->id;
+    switch (req->id) {
         case WifiTaskRequestId::Nop:
-            resp.isSuccess = this->invokeNop(req, resp);
+            resp->isSuccess = this->invokeNop(*req, *resp);
             break;
         case WifiTaskRequestId::GetWifiStatus:
-            resp.isSuccess = this->invokeGetWifiStatus(req, resp);
+            resp->isSuccess = this->invokeGetWifiStatus(*req, *resp);
             break;
         case WifiTaskRequestId::SendSensorData:
-            resp.isSuccess = this->invokeSend(req, resp);
+            resp->isSuccess = this->invokeSend(*req, *resp);
             break;
         default:
-            resp.isSuccess = false;
+            resp->isSuccess = false;
             break;
     }
-    // 応答
-    this->sendQueue.send(&resp);
+    // 要求を解放して応答
+    this->recvQueue.release();
+    this->sendQueue.commit();
 
     return false; // no abort
 }
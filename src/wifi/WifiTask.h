@@ -7,6 +7,7 @@
 #include "../SharedResourceDefs.h"
 #include "../IpcQueueDefs.h"
 #include "../IpcQueue.h"
+#include "../LatestValue.h"
 #include "../FpsControlTask.h"
 
 class WifiTask : public FpsControlTask {
@@ -17,24 +18,31 @@ class WifiTask : public FpsControlTask {
          * @param resource 共有リソース群
          * @param recvQueue Wifi要求の受信Queue
          * @param sendQueue Wifi応答の送信Queue
+         * @param measureData 最新の測定データ
          * @param wifi Wifiインスタンス
          */
         WifiTask(
             const SharedResourceDefs& resource,
-            IpcQueue<WifiTaskRequest>& recvQueue,
-            IpcQueue<WifiTaskResponse>& sendQueue,
+            ZeroCopyQueue<WifiTaskRequest>& recvQueue,
+            ZeroCopyQueue<WifiTaskResponse>& sendQueue,
+            LatestValue<MeasureData>& measureData,
             WiFiClass& wifi
-            ) : resource(resource), recvQueue(recvQueue), sendQueue(sendQueue), wifi(wifi) {}
+            ) : resource(resource), recvQueue(recvQueue), sendQueue(sendQueue), measureData(measureData), wifi(wifi) {}
         /**
          * @brief Destroy the Wifi Task object
          */
         virtual ~WifiTask() {}
         const char* getName(void) override { return "WifiTask"; }
     protected:
+        /**
+         * @brief Ambientへの送信は応答待ちで時間がかかるので長めに許容する
+         */
+        uint32_t getHeartbeatTimeoutTick(void) override { return SysTimer::msToTick(FixedConfig::WifiTaskWatchdogTimeoutMs); }
         // resource
         const SharedResourceDefs& resource; /**< 共有リソース */
-        IpcQueue<WifiTaskRequest>& recvQueue; /**< WifiTaskへの要求が積まれるQueue */
-        IpcQueue<WifiTaskResponse>& sendQueue; /**< WifiTaskからの応答が積まれるQueue */
+        ZeroCopyQueue<WifiTaskRequest>& recvQueue; /**< WifiTaskへの要求が積まれるQueue */
+        ZeroCopyQueue<WifiTaskResponse>& sendQueue; /**< WifiTaskからの応答が積まれるQueue */
+        LatestValue<MeasureData>& measureData; /**< 送信する最新の測定データ */
         // peripheral
         WiFiClass& wifi; /**< Wifiを取り扱うのはこのクラスに一任するのでSharedResouceにはしない */
         // configから読み出し
@@ -43,11 +51,20 @@ class WifiTask : public FpsControlTask {
         // ローカル変数
         WiFiClient client;
         Ambient ambient;
+        GlobalConfigSubscriber configSubscriber; /**< configの再読み込み通知 */
 
 
         void setup(void) override;
         bool loop(void) override;
 
+        /**
+         * @brief configの値を反映します
+         *
+         * @param config 読み出し元
+         * @param changes 反映する項目
+         */
+        void applyConfig(const GlobalConfig<FixedConfig::ConfigAllocateSize>& config, const GlobalConfigChangeSet& changes);
+
         /**
          * @brief NOPが要求されたときの処理
          * 
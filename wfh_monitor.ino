@@ -42,26 +42,40 @@ static WiFiClass wifi = WiFi;
 /****************************** RTOS Queue ******************************/
 #include "src/IpcQueueDefs.h"
 #include "src/IpcQueue.h"
+#include "src/LatestValue.h"
+#include "src/RtosTopology.h"
 
 // 複数CPUで動作させる場合、ローカル変数がCPU Data Cacheに乗る可能性があるので
 // NonCacheアクセスを矯正できる場所(TCM), 参照時はNonCacheアクセスする, 書き込み後FlushDCache/読み出し前InvalidateDCacheを徹底する
-static IpcQueue<MeasureData> measureDataQueue;
-static IpcQueue<ButtonEventData> buttonStateQueue;
-static IpcQueue<WifiTaskRequest> wifiRequestQueue;
-static IpcQueue<WifiTaskResponse> wifiResponseQueue;
+static LatestValue<MeasureData> latestMeasureData;
+static MeasureDataTopic measureDataTopic;
+static RtosTopology::ButtonStateQueue buttonStateQueue;
+static RtosTopology::WifiRequestQueue wifiRequestQueue;
+static RtosTopology::WifiResponseQueue wifiResponseQueue;
+static RtosTopology::SdRequestQueue sdRequestQueue;
+// Queueの領域はRtosTopologyの定義通りに静的に確保する
+static RtosTopology::ButtonStateQueue::StaticStorage<RtosTopology::ButtonStateQueueSpec.depth> buttonStateQueueStorage;
+static RtosTopology::WifiRequestQueue::StaticStorage<RtosTopology::WifiRequestQueueSpec.depth> wifiRequestQueueStorage;
+static RtosTopology::WifiResponseQueue::StaticStorage<RtosTopology::WifiResponseQueueSpec.depth> wifiResponseQueueStorage;
+static RtosTopology::SdRequestQueue::StaticStorage<RtosTopology::SdRequestQueueSpec.depth> sdRequestQueueStorage;
 
 /****************************** RTOS SharedData ******************************/
 #include <ArduinoJson.h>
 #include "src/SharedResource.h"
+#include "src/SharedRwResource.h"
 #include "src/SharedResourceDefs.h"
 #include "src/GlobalConfig.h"
 
 // RTOS Queueと同様semaphoreHandleがCPU DataCache上に配置されることを回避すること
-static SharedResource<Serial_> sharedSerial(serial);
-static SharedResource<SDFS> sharedSd(sd);
-// configも共有する、load/saveにSDFSが必要
-static GlobalConfig<FixedConfig::ConfigAllocateSize> config(sharedSd, FixedConfig::ConfigPath);
-static SharedResource<GlobalConfig<FixedConfig::ConfigAllocateSize>> sharedConfig(config);
+static SharedResource<Serial_> sharedSerial(serial, "serial");
+static SharedResource<SDFS> sharedSd(sd, "sd");
+// configも共有する、load/saveにSDFSが必要。各Taskからは読み出しが大半なのでRead/Write Lockで共有する
+static GlobalConfig<FixedConfig::ConfigAllocateSize> config(sharedSd, {
+    .json     = FixedConfig::ConfigPath,
+    .temp     = FixedConfig::ConfigTempPath,
+    .snapshot = { FixedConfig::ConfigSnapshotPath0, FixedConfig::ConfigSnapshotPath1 },
+});
+static SharedRwResource<GlobalConfig<FixedConfig::ConfigAllocateSize>> sharedConfig(config, "config");
 // 他Taskに公開するResouceを記述
 static SharedResourceDefs sharedResources = {
     .serial = sharedSerial,
@@ -75,11 +89,61 @@ static SharedResourceDefs sharedResources = {
 #include "src/button/ButtonTask.h"
 #include "src/ui/UiTask.h"
 #include "src/wifi/WifiTask.h"
-
-static GroveTask groveTask(sharedResources, measureDataQueue, lightSensor, bme680);
+#include "src/logger/LoggerTask.h"
+#include "src/sd/SdTask.h"
+#include "src/coop/CoopExecutor.h"
+#include "src/watchdog/WatchdogTask.h"
+#include "src/timer/TimerTask.h"
+#include "src/TimerWheel.h"
+
+// 周期処理/タイムアウトはTimerWheelに登録し、TimerTaskが期限を各Taskに配る
+static TimerWheel timerWheel;
+static TimerTask timerTask(timerWheel);
+static GroveTask groveTask(sharedResources, latestMeasureData, measureDataTopic, lightSensor, bme680);
 static ButtonTask<FixedConfig::ButtonTaskDebounceNum> buttonTask(sharedResources, buttonStateQueue);
-static UiTask<FixedConfig::UiTaskBrightnessKeyPoint> uiTask(sharedResources, measureDataQueue, buttonStateQueue, wifiRequestQueue, wifiResponseQueue, lcd);
-static WifiTask wifiTask(sharedResources, wifiRequestQueue, wifiResponseQueue, wifi);
+static UiTask<FixedConfig::UiTaskBrightnessKeyPoint> uiTask(sharedResources, latestMeasureData, buttonStateQueue, wifiRequestQueue, wifiResponseQueue, lcd, timerWheel);
+static WifiTask wifiTask(sharedResources, wifiRequestQueue, wifiResponseQueue, latestMeasureData, wifi);
+static SdTask sdTask(sharedResources, sdRequestQueue);
+static LoggerTask loggerTask(sharedResources, measureDataTopic, sdTask);
+// 低頻度で待機が大半のTaskは1つのRTOS Taskに相乗りさせる
+static RtosTopology::CoopExecutor coopExecutor(RtosTopology::CoopExecutorSpec.name);
+// 全TaskのHeartbeatを監視する
+static WatchdogTask watchdogTask(sharedResources);
+// Taskの領域もRtosTopologyの定義通りに静的に確保する
+static TaskBase::StaticStorage<RtosTopology::GroveTaskSpec.stackSize> groveTaskStorage;
+static TaskBase::StaticStorage<RtosTopology::UiTaskSpec.stackSize> uiTaskStorage;
+static TaskBase::StaticStorage<RtosTopology::WifiTaskSpec.stackSize> wifiTaskStorage;
+static TaskBase::StaticStorage<RtosTopology::SdTaskSpec.stackSize> sdTaskStorage;
+static TaskBase::StaticStorage<RtosTopology::CoopExecutorSpec.stackSize> coopExecutorStorage;
+static TaskBase::StaticStorage<RtosTopology::TimerTaskSpec.stackSize> timerTaskStorage;
+static TaskBase::StaticStorage<RtosTopology::WatchdogTaskSpec.stackSize> watchdogTaskStorage;
+// FreeRTOSが作成するIdle/Timer Service Taskの領域も静的に確保して渡す
+static TaskBase::StaticStorage<RtosTopology::IdleTaskSpec.stackSize> idleTaskStorage;
+#if (configUSE_TIMERS == 1)
+static TaskBase::StaticStorage<RtosTopology::TimerServiceTaskSpec.stackSize> timerServiceTaskStorage;
+#endif
+
+/**
+ * @brief Idle Taskの領域をFreeRTOSに渡します
+ * @note configSUPPORT_STATIC_ALLOCATIONが有効な場合、vTaskStartScheduler()から呼び出されます
+ */
+extern "C" void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer, StackType_t** ppxIdleTaskStackBuffer, uint32_t* pulIdleTaskStackSize) {
+    *ppxIdleTaskTCBBuffer = &idleTaskStorage.tcb;
+    *ppxIdleTaskStackBuffer = idleTaskStorage.stack;
+    *pulIdleTaskStackSize = RtosTopology::IdleTaskSpec.stackSize;
+}
+
+#if (configUSE_TIMERS == 1)
+/**
+ * @brief Timer Service Taskの領域をFreeRTOSに渡します
+ * @note configSUPPORT_STATIC_ALLOCATIONとconfigUSE_TIMERSが有効な場合、vTaskStartScheduler()から呼び出されます
+ */
+extern "C" void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer, StackType_t** ppxTimerTaskStackBuffer, uint32_t* pulTimerTaskStackSize) {
+    *ppxTimerTaskTCBBuffer = &timerServiceTaskStorage.tcb;
+    *ppxTimerTaskStackBuffer = timerServiceTaskStorage.stack;
+    *pulTimerTaskStackSize = RtosTopology::TimerServiceTaskSpec.stackSize;
+}
+#endif
 /****************************** Setup Subfunction ******************************/
 static void setupLcd(void) {
     lcd.begin();
@@ -90,6 +154,7 @@ static void setupLcd(void) {
 
 static void setupPeripheral(void) {
     lcd.printf("[INFO] setup peripheral\n");
+    SysTimer::beginCycleCount();
     wireL.begin();
     Serial.begin(FixedConfig::SerialBaudrate);
     // USB UARTが準備できるまで待つオプションを有効にしてビルドした場合
@@ -99,24 +164,80 @@ static void setupPeripheral(void) {
     }
 }
 
+/**
+ * @brief SdTaskにconfigの読み書きを要求し、完了を待ちます
+ *
+ * @param request SdTask::loadConfig/SdTask::saveConfig
+ * @param completion doneSemaphoreを指定した完了通知
+ * @return true 成功
+ * @return false 失敗
+ */
+static bool requestConfigIo(bool (SdTask::*request)(SdCompletion*), SdCompletion& completion) {
+    if (!(sdTask.*request)(&completion)) {
+        return false;
+    }
+    // 応答が無ければcompletionを再利用できないので停止する
+    if (!SdTask::waitForCompletion(completion, FixedConfig::SdTaskConfigTimeoutMs)) {
+        PANIC("[PANIC] sdTask timeout.");
+    }
+    return completion.isSuccess;
+}
+
 static void setupSd(void) {
     // setup sd
     lcd.printf("[INFO] setup SD card\n");
     sd.begin(SDCARD_SS_PIN, SDCARD_SPI);
-    
+
+    /* SD Card I/OはすべてSdTaskで行うので、configを読み出す前に動かしておく */
+    if (!sdRequestQueue.createQueue(sdRequestQueueStorage)) {
+        PANIC("[PANIC] sdRequestQueue create failed.");
+    }
+    sdTask.createTask(sdTaskStorage, RtosTopology::SdTaskSpec.priority);
+
+    static StaticSemaphore_t configDoneBuffer;
+    static SdCompletion completion = {
+        .callback = nullptr,
+        .context = nullptr,
+        .doneSemaphore = xSemaphoreCreateBinaryStatic(&configDoneBuffer),
+        .waitSet = nullptr,
+        .waitSetBit = 0,
+        .isDone = false,
+        .isSuccess = false,
+        .transferredSize = 0,
+        .message = nullptr,
+    };
+
     /* load configure from SD card */
     lcd.printf("[INFO] load config from SD card\n");
 
-    DeserializationError desError;
-    if (config.load(nullptr, desError)) {
-        lcd.printf("[INFO] done.\n");
+    if (requestConfigIo(&SdTask::loadConfig, completion)) {
+        bool isSnapshot = false;
+        bool isDirty = false;
+        uint32_t loadUs = 0;
+        sharedConfig.read([&](const GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+            isSnapshot = (config.getLoadSource() == GlobalConfigSource::Snapshot);
+            isDirty = config.isDirty();
+            loadUs = config.getLoadUs();
+        });
+        lcd.printf("[INFO] done. from %s %d[us]\n", isSnapshot ? "snapshot" : "json", loadUs);
+        // Json Fileが壊れていてSnapshotから復旧した場合は書き直す
+        if (isDirty) {
+            lcd.printf("[INFO] repair config on SD card\n");
+            if (requestConfigIo(&SdTask::saveConfig, completion)) {
+                lcd.printf("[INFO] done.\n");
+            } else {
+                lcd.printf("[ERROR] failed.\n");
+            }
+        }
     } else {
-        lcd.printf("[ERROR] failed code=%d, init default value.\n", desError);
+        lcd.printf("[ERROR] failed reason=%s, init default value.\n", (completion.message != nullptr) ? completion.message : "request");
         // initialize and save to SD card
-        config.init(false);
+        sharedConfig.write([](GlobalConfig<FixedConfig::ConfigAllocateSize>& config){
+            config.init();
+        });
 
         lcd.printf("[INFO] save config to SD card\n");
-        if (config.save(nullptr)) {
+        if (requestConfigIo(&SdTask::saveConfig, completion)) {
             lcd.printf("[INFO] done.\n");
         } else {
             lcd.printf("[ERROR] failed.\n");
@@ -132,18 +253,15 @@ static void setupWifi(void) {
     delay(FixedConfig::WaitForPorMs);
 
     // WiFi使わなければSkip
-    bool useWifi = GlobalConfigDefaultValues::UseWiFi;
-    config.read(GlobalConfigKeys::UseWiFi, useWifi);
-    if (!useWifi) {
+    if (!config.get<GlobalConfigId::UseWiFi>()) {
         lcd.printf("[INFO] skip AP Connection.\n");
         return;
     }
 
     // Wifi開始
-    auto ssid = config.getReadPtr<char>(GlobalConfigKeys::ApSsid);
-    auto pass = config.getReadPtr<char>(GlobalConfigKeys::ApPassWord);
-    uint32_t timeoutMs = GlobalConfigDefaultValues::ApTimeoutMs;
-    config.read(GlobalConfigKeys::ApTimeoutMs, timeoutMs);
+    const char* ssid = config.get<GlobalConfigId::ApSsid>();
+    const char* pass = config.get<GlobalConfigId::ApPassWord>();
+    const uint32_t timeoutMs = config.get<GlobalConfigId::ApTimeoutMs>();
 
     lcd.printf("[INFO] connect to %s.\n", ssid);
     wifi.begin(ssid, pass);
@@ -174,18 +292,19 @@ static void setupRtos(void) {
     lcd.printf("[INFO] setup RTOS config\n");
     vSetErrorLed(FixedConfig::ErrorLedPinNum, FixedConfig::ErrorLedState);
 
+    /* Queue/Taskの領域は静的に確保済、上限はビルド時に確認している */
+    lcd.printf("[INFO] RTOS static RAM task=%u queue=%u total=%u/%u[byte]\n",
+        static_cast<uint32_t>(RtosTopology::TaskRamSize), static_cast<uint32_t>(RtosTopology::QueueRamSize), static_cast<uint32_t>(RtosTopology::TotalRamSize), static_cast<uint32_t>(FixedConfig::RtosStaticRamBudget));
+
     /* Queue 作成失敗は後の挙動に影響が出るので即時停止する */
     lcd.printf("[INFO] setup RTOS queue\n");
-    if (!measureDataQueue.createQueue(FixedConfig::DefaultQueueSize)) {
-        PANIC("[PANIC] measureDataQueue create failed.");
-    }
-    if (!buttonStateQueue.createQueue(FixedConfig::DefaultQueueSize)) {
+    if (!buttonStateQueue.createQueue(buttonStateQueueStorage)) {
         PANIC("[PANIC] buttonStateQueue create failed.");
     }
-    if (!wifiRequestQueue.createQueue(FixedConfig::DefaultQueueSize)) {
+    if (!wifiRequestQueue.createQueue(wifiRequestQueueStorage)) {
         PANIC("[PANIC] wifiRequestQueue create failed.");
     }
-    if (!wifiResponseQueue.createQueue(FixedConfig::DefaultQueueSize)) {
+    if (!wifiResponseQueue.createQueue(wifiResponseQueueStorage)) {
         PANIC("[PANIC] wifiResponseQueue create failed.");
     }
 
@@ -199,10 +318,16 @@ static void setupRtos(void) {
      * * 以後はTask以外の操作は基本行わない
      * * Task優先度はSeeed_Arduino_atUnified/src/sdkconfig.hと整合が取れるようにに設定している...
      **/
-    groveTask.createTask(FixedConfig::GroveTaskStackSize, configMAX_PRIORITIES - 2);
-    buttonTask.createTask(FixedConfig::ButtonTaskStackSize, configMAX_PRIORITIES - 2);
-    uiTask.createTask(FixedConfig::UiTaskStackSize, configMAX_PRIORITIES - 1);
-    wifiTask.createTask(FixedConfig::wifiTaskStackSize, configMAX_PRIORITIES - 1); // WiFiTaskはUiTaskからの要求がなければ寝っぱなし
+    timerTask.createTask(timerTaskStorage, RtosTopology::TimerTaskSpec.priority); // 他のTaskがTimerを登録する前に動かしておく
+    groveTask.createTask(groveTaskStorage, RtosTopology::GroveTaskSpec.priority);
+    uiTask.createTask(uiTaskStorage, RtosTopology::UiTaskSpec.priority);
+    wifiTask.createTask(wifiTaskStorage, RtosTopology::WifiTaskSpec.priority);
+    // sdTaskはconfigを読み出すためにsetupSd()で作成済
+    if (!coopExecutor.add(buttonTask) || !coopExecutor.add(loggerTask)) {
+        PANIC("[PANIC] coopExecutor add failed.");
+    }
+    coopExecutor.createTask(coopExecutorStorage, RtosTopology::CoopExecutorSpec.priority);
+    watchdogTask.createTask(watchdogTaskStorage, RtosTopology::WatchdogTaskSpec.priority); // 他のTaskがすべて作成されてから監視を始める
 
     /* AtWiFiに依存する部分がすでにいくつかのTaskを動かしているので開始操作は不要 */
 }